@@ -62,6 +62,13 @@ public:
         return sys_futex(&counter, FUTEX_WAKE, n_threads, NULL, NULL, 0);
     }
 
+    // wait_if can return without a change of the counter (e.g. after wake
+    // is called for other reasons), waiting threads should check the counter
+    inline int value() const
+    {
+        return counter.load(std::memory_order_acquire);
+    }
+
 private:
     std::atomic_int counter;
 };
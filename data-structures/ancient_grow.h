@@ -21,41 +21,107 @@
 
 #include "data-structures/returnelement.h"
 #include "data-structures/grow_iterator.h"
+#include "data-structures/migration_scheduler.h"
+#include "data-structures/backoff.h"
+#include "data-structures/probe_stats.h"
 #include "example/update_fcts.h"
 
 #include <atomic>
 #include <memory>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <thread>
 
 namespace growt {
 
 static const size_t migration_block_size = 4096;
 
+// an unaligned target (see BaseCircular::migrate) has to be initialized
+// completely, before any element is inserted, therefore, blocks are
+// distributed twice (first blocks of the target are initialized, then
+// blocks of the source are migrated), one counter is used for both passes
 template<class Table_t>
-size_t blockwise_migrate(Table_t source, Table_t target)
+size_t blockwise_migrate_unaligned(Table_t source, Table_t target,
+                                   std::true_type)
 {
-    size_t n = 0;
+    size_t n    = 0;
+    size_t tcap = target->_capacity;
+    size_t end  = tcap + source->_capacity;
 
-    //get block + while block legal migrate and get new block
     size_t temp = source->_current_copy_block.fetch_add(migration_block_size);
-    while (temp < source->_capacity)
+    while (temp < tcap)
+    {
+        target->initialize(temp, std::min(temp+migration_block_size, tcap));
+        source->_finished_copy_block.fetch_add(migration_block_size);
+        temp = source->_current_copy_block.fetch_add(migration_block_size);
+    }
+    for (size_t r = 0; source->_finished_copy_block.load() < tcap; )
+        backoff(r);
+
+    while (temp < end)
     {
-        n += source->migrate(*target, temp,
-                             std::min(uint(temp+migration_block_size),
-                                      uint(source->_capacity)));
+        n += source->migrate(*target, temp - tcap,
+                             std::min(temp+migration_block_size, end) - tcap);
         temp = source->_current_copy_block.fetch_add(migration_block_size);
     }
     return n;
 }
 
-template<size_t MxFill>
-size_t resize(size_t curr_size, size_t n_in, size_t n_del)
+template<class Table_t>
+size_t blockwise_migrate_unaligned(Table_t, Table_t, std::false_type)
+{ return 0; }
+
+template<class Table_t>
+size_t blockwise_migrate(Table_t source, Table_t target)
 {
-    auto nsize = curr_size;
-    double fill_rate = double(n_in - n_del)/double(curr_size);
+    using BaseTable_t = typename std::pointer_traits<Table_t>::element_type;
+    size_t shift = 0;
+    while (target->_capacity > source->_capacity << shift) ++shift;
+    if (target->_capacity != source->_capacity << shift)
+        return blockwise_migrate_unaligned(source, target,
+              std::integral_constant<bool, BaseTable_t::unaligned_migration>());
+
+    // blocks are distributed by the source's scheduler (see
+    // MigrationScheduler), _current_copy_block signals the running migration
+    source->_current_copy_block.fetch_add(1);
+
+    size_t n    = 0;
+    size_t cap  = source->_capacity;
+    size_t bs   = source->_migration.parameters().block_size;
+    size_t home = source->_migration.join();
 
-    if (fill_rate > double(MxFill)/200.) nsize <<= 1;
+    //get block + while block legal migrate and get new block
+    size_t temp = source->_migration.claim(home, cap);
+    while (temp < cap)
+    {
+        n += source->migrate(*target, temp, std::min(temp+bs, cap));
+        temp = source->_migration.claim(home, cap);
+    }
+    return n;
+}
 
-    return nsize;
+// every thread that joins a compaction pass helps to finish it, blocks are
+// distributed like in blockwise_migrate, removed(n) is called after each
+// block, the function returns once all blocks of the pass are finished
+template<class Table_t, class F>
+void blockwise_compact(Table_t table, F removed)
+{
+    size_t cap  = table->_capacity;
+    size_t temp = table->_current_compact_block.load();
+    size_t end  = (temp / cap + 1) * cap;
+    while (temp < end)
+    {
+        if (! table->_current_compact_block
+                  .compare_exchange_weak(temp, temp+migration_block_size))
+            continue;
+        removed(table->compact(temp % cap,
+                               temp % cap + migration_block_size));
+        table->_finished_compact_block.fetch_add(migration_block_size);
+        temp = table->_current_compact_block.load();
+    }
+    for (size_t r = 0; table->_finished_compact_block.load() < end; )
+        backoff(r);
 }
 
 
@@ -63,6 +129,7 @@ size_t resize(size_t curr_size, size_t n_in, size_t n_del)
 
 
 
+
 // FORWARD DECLARATION OF THE HANDLE CLASS
 template<class> class GrowTableHandle;
 // AND THE STATIONARY DATA OBJECT (GLOBAL OBJECT ON HEAP)
@@ -106,6 +173,38 @@ public:
     {
         return Handle(*_gt_data);
     }
+
+    // deleted cells are removed in place, instead of migrating the table
+    // to a table of the same size (see GrowTableHandle::compact), this
+    // avoids most migrations of delete heavy workloads, but more deleted
+    // cells remain in the table (off by default)
+    void set_compaction(bool enable) { _gt_data->_compaction.store(enable); }
+
+    // the table is shrunk (usually to a half or a quarter of its size),
+    // once less than low_fill*capacity elements remain (see
+    // BaseCircular::resize), this needs a base table that can migrate into
+    // smaller tables (unaligned_migration), watermarks above 2/3 of the
+    // grow fill act like 2/3 of it (0 disables shrinking, default)
+    void set_shrink_fill(double low_fill) { _gt_data->_shrink_fill.store(low_fill); }
+
+    // the table is migrated, once max_fill*capacity cells are used
+    // (including deleted cells), the migration grows the table, if more
+    // than grow_fill*capacity elements remain (defaults are given by the
+    // base table, e.g. BaseCircular::max_fill_factor)
+    void set_max_fill (double max_fill)  { _gt_data->_max_fill .store(max_fill);  }
+    void set_grow_fill(double grow_fill) { _gt_data->_grow_fill.store(grow_fill); }
+
+    // migrates the table once, directly into a table that holds n elements
+    // without growing (see GrowTableHandle::reserve)
+    void reserve(size_t n) { get_handle().reserve(n); }
+
+    // fills the (empty) table with n elements using the given number of
+    // threads, the table is grown once, then the elements are written
+    // without atomics (see GrowTableHandle::build), returns #inserted
+    size_t build(const std::pair<typename HashTable::key_type,
+                                 typename HashTable::mapped_type>* data,
+                 size_t n, size_t threads)
+    { return get_handle().build(data, n, threads); }
 };
 
 
@@ -123,6 +222,7 @@ private:
     using WorkerStrat_t    = typename Parent::WorkerStrat_t;
     using ExclusionStrat_t = typename Parent::ExclusionStrat_t;
 
+    friend Parent;
     friend WorkerStrat_t;
     friend ExclusionStrat_t;
 
@@ -136,7 +236,9 @@ public:
 
     GrowTableData(size_t size_)
         : _global_exclusion(size_), _global_worker(),
-          _elements(0), _dummies(0)
+          _elements(0), _dummies(0), _compaction(false), _shrink_fill(0.),
+          _max_fill(BaseTable_t::max_fill_factor),
+          _grow_fill(BaseTable_t::grow_fill_factor), _reserved(0)
     { }
 
     GrowTableData(const GrowTableData& source) = delete;
@@ -151,6 +253,36 @@ private:
     // APPROXIMATE COUNTS
     alignas(64) std::atomic_int _elements;
     alignas(64) std::atomic_int _dummies;
+
+    std::atomic_bool _compaction;
+    std::atomic<double> _shrink_fill;
+    std::atomic<double> _max_fill;
+    std::atomic<double> _grow_fill;
+    // capacity requested by reserve, used by migrations until it is reached
+    std::atomic_size_t  _reserved;
+
+    // capacity of the next table, depends on the approximate counts and on
+    // the fill rates of this table (see BaseCircular::resize)
+    size_t next_capacity(size_t capacity) const
+    {
+        size_t reserved = _reserved.load(std::memory_order_acquire);
+        if (reserved > capacity) return reserved;
+        return BaseTable_t::resize(capacity,
+                                   _elements.load(std::memory_order_acquire),
+                                   _dummies .load(std::memory_order_acquire),
+                                   _grow_fill  .load(std::memory_order_relaxed),
+                                   _shrink_fill.load(std::memory_order_relaxed));
+    }
+
+    // capacity (reached by growing steps of the base table) that holds n
+    // elements, before max_fill triggers the next migration
+    size_t reserve_capacity(size_t capacity, size_t n) const
+    {
+        double max_fill = _max_fill.load(std::memory_order_relaxed);
+        while (double(capacity) * max_fill < double(n))
+            capacity = BaseTable_t::resize(capacity, capacity, 0, 0.);
+        return capacity;
+    }
 };
 
 
@@ -234,6 +366,17 @@ public:
     insert_return_type insert(const key_type& k, const mapped_type& d);
     iterator           find (const key_type& k);
     const_iterator     find (const key_type& k) const;
+    bool               contains(const key_type& k) const;
+    size_type          find_batch(const key_type* keys, size_type n,
+                                  mapped_type* out, bool* found);
+    // batched insertions (return #inserted), existing elements are
+    // updated with f(current_data, data[i]) by insert_or_update_batch
+    size_type          insert_batch(const key_type* keys,
+                                    const mapped_type* data, size_type n);
+    template <class F>
+    size_type          insert_or_update_batch(const key_type* keys,
+                                              const mapped_type* data,
+                                              size_type n, F f);
 
     mapped_reference operator[](const key_type& k)
     { return (*insert(k, mapped_type())).second; }
@@ -251,6 +394,55 @@ public:
     template <class F, class ... Types>
     insert_return_type insert_or_update_unsafe(const key_type& k, const mapped_type& d, F f, Types&& ... args);
 
+    // number of migrations since the table was created
+    size_type          migration_count()
+    { return execute([](HashPtrRef_t t) { return t->_version; }); }
+
+    // block size and ranges of the current table's next migration
+    MigrationScheduler::Parameters migration_parameters()
+    { return execute([](HashPtrRef_t t) { return t->_migration.parameters(); }); }
+
+    // grows the table to hold n elements with a single migration (instead of
+    // one migration per growing step), all threads help as usual
+    void               reserve(size_type n);
+
+    // bulk insertion into an empty table, no other operations can run
+    // concurrently (see BaseCircular::build), base tables without bulk_build
+    // are filled by parallel handles (one per thread, then any occurrence
+    // of a duplicate key can win)
+    size_type          build(const std::pair<key_type, mapped_type>* data,
+                             size_type n, size_type threads);
+
+    size_type          capacity()
+    { return execute([](HashPtrRef_t t) { return t->_capacity; }); }
+
+    // probe distance histograms of all handles (recorded by the base table,
+    // kept while the table grows), see probe_stats.h
+    ProbeStatistics    probe_stats() const
+    { return cexecute([](HashPtrRef_t t) { return t->probe_stats(); }); }
+
+    // calls f(key, data) for the elements of the current table, whose home
+    // cell in a table of capacity cap is in [s,e) (see parallel_scan.h)
+    template <class F>
+    void               for_each_home(size_type cap, size_type s, size_type e,
+                                     F f)
+    {
+        execute([cap, s, e, &f](HashPtrRef_t t)
+                { t->for_each_home(cap, s, e, f); return 0; });
+    }
+
+    // visits the elements with hash >= cursor (at least max_elems, unless
+    // the end is reached), returns the cursor of the next call (0 at the
+    // end), elements that exist during the whole scan are visited at least
+    // once, even if the table is migrated between calls (see
+    // BaseCircular::scan)
+    template <class F>
+    size_type          scan(size_type cursor, size_type max_elems, F f)
+    {
+        return execute([cursor, max_elems, &f](HashPtrRef_t t)
+                       { return t->scan(cursor, max_elems, f); });
+    }
+
 private:
     // DATA+FUNCTIONS FOR MIGRATION STRATEGIES
     GrowTableData& _gt_data;
@@ -281,17 +473,65 @@ private:
         HashPtrRef_t temp = _local_exclusion.get_table();
         auto result = std::forward<Functor>(f)
                           (temp, std::forward<Types>(param)...);
+        _local_exclusion.rls_table();
+        return result;
+    }
+
+    // single key operations, the exclusion strategy can choose the table
+    // depending on the key (see EStratIncremental)
+    template<typename Functor, typename ... Types>
+    inline typename std::result_of<Functor(HashPtrRef_t, const key_type&, Types&& ...)>::type
+    kexecute (Functor f, const key_type& k, Types&& ... param)
+    {
+        HashPtrRef_t temp = _local_exclusion.get_table(k);
+        auto result = std::forward<Functor>(f)
+                          (temp, k, std::forward<Types>(param)...);
         rls_table();
         return result;
     }
 
-    static constexpr double _max_fill_factor = 0.666;
+    template<typename Functor, typename ... Types>
+    inline typename std::result_of<Functor(HashPtrRef_t, const key_type&, Types&& ...)>::type
+    kcexecute (Functor f, const key_type& k, Types&& ... param) const
+    {
+        HashPtrRef_t temp = _local_exclusion.get_table(k);
+        auto result = std::forward<Functor>(f)
+                          (temp, k, std::forward<Types>(param)...);
+        _local_exclusion.rls_table();
+        return result;
+    }
+
+    // batches are processed in chunks (each sorted by hash), after each chunk
+    // failed elements are queued for a retry (after the table was grown)
+    static constexpr size_type _batch_chunk = 64;
+
+    template <bool Update, class F>
+    size_type batch(const key_type* keys, const mapped_type* data,
+                    size_type n, F f);
+
+    // instead of a migration that would not grow the table, deleted cells
+    // are removed in place (see BaseCircular::compact), this is only
+    // successful if the fill rate drops below _compact_fill_factor*max_fill
+    static constexpr double _compact_fill_factor = 0.9;
+    using compactable_t = std::integral_constant<bool, BaseTable_t::compactable>;
+
+    bool compact(HashPtrRef_t, std::false_type) { return false; }
+    bool compact(HashPtrRef_t table, std::true_type);
+
+    // true if the next migration would shrink the table (see set_shrink_fill)
+    bool shrink_due(HashPtrRef_t table);
+
+    size_type build(const std::pair<key_type, mapped_type>* data,
+                    size_type n, size_type threads, std::true_type);
+    size_type build(const std::pair<key_type, mapped_type>* data,
+                    size_type n, size_type threads, std::false_type);
 
     // LOCAL COUNTERS FOR SIZE ESTIMATION WITH SOME PADDING FOR
     // REDUCING CACHE EFFECTS
     void update_numbers();
     void inc_inserted();
     void inc_deleted();
+    void inc_reused();
 
     alignas(64) int  _updates;
     alignas(64) int  _inserted;
@@ -397,7 +637,7 @@ GrowTableHandle<GrowTableData>::insert(const key_type& k, const mapped_type& d)
 {
     int v = -1;
     base_intern_insert_return_type result = std::make_pair(bend(), ReturnCode::ERROR);
-    std::tie (v, result) = execute([](HashPtrRef_t t, const key_type& k, const mapped_type& d)
+    std::tie (v, result) = kexecute([](HashPtrRef_t t, const key_type& k, const mapped_type& d)
                                      ->std::pair<int,base_intern_insert_return_type>
                                    {
                                        std::pair<int,base_intern_insert_return_type> result =
@@ -412,6 +652,9 @@ GrowTableHandle<GrowTableData>::insert(const key_type& k, const mapped_type& d)
     case ReturnCode::TSX_SUCCESS_IN:
         inc_inserted();
         return insert_return_type(iterator(result.first,v,*this), true);
+    case ReturnCode::SUCCESS_IN_REUSED:
+        inc_reused();
+        return insert_return_type(iterator(result.first,v,*this), true);
     case ReturnCode::UNSUCCESS_ALREADY_USED:
     case ReturnCode::TSX_UNSUCCESS_ALREADY_USED:
         return insert_return_type(iterator(result.first,v,*this), false);
@@ -435,7 +678,7 @@ GrowTableHandle<GrowTableData>::find(const key_type& k)
     base_iterator it = bend();
     size_t        v  = 0;
     std::tie(v, it)  =
-        execute([this](HashPtrRef_t t, const key_type& k)
+        kexecute([this](HashPtrRef_t t, const key_type& k)
                 -> std::pair<size_t, base_iterator>
                 { return std::make_pair(t->_version, t->find(k)); },
                       k);
@@ -449,20 +692,137 @@ GrowTableHandle<GrowTableData>::find(const key_type& k) const
     base_citerator it = bcend();
     size_t         v  = 0;
     std::tie(v, it)   =
-        execute([this](HashPtrRef_t t, const key_type& k)
+        kexecute([this](HashPtrRef_t t, const key_type& k)
                 -> std::pair<size_t, base_citerator>
                 { return std::make_pair(t->_version, t->find(k)); },
                       k);
     return const_iterator(it, v, *this);
 }
 
+template<class GrowTableData>
+inline bool GrowTableHandle<GrowTableData>::contains(const key_type& k) const
+{
+    return kcexecute([](HashPtrRef_t t, const key_type& k) -> bool
+                    { return t->contains(k); },
+                    k);
+}
+
+template<class GrowTableData>
+inline typename GrowTableHandle<GrowTableData>::size_type
+GrowTableHandle<GrowTableData>::find_batch(const key_type* keys, size_type n,
+                                           mapped_type* out, bool* found)
+{
+    return execute([](HashPtrRef_t t, const key_type* keys, size_type n,
+                      mapped_type* out, bool* found) -> size_type
+                   { return t->find_batch(keys, n, out, found); },
+                   keys, n, out, found);
+}
+
+template<class GrowTableData>
+inline typename GrowTableHandle<GrowTableData>::size_type
+GrowTableHandle<GrowTableData>::insert_batch(const key_type* keys,
+                                             const mapped_type* data,
+                                             size_type n)
+{
+    return batch<false>(keys, data, n, example::Overwrite());
+}
+
+template<class GrowTableData> template <class F>
+inline typename GrowTableHandle<GrowTableData>::size_type
+GrowTableHandle<GrowTableData>::insert_or_update_batch(const key_type* keys,
+                                                       const mapped_type* data,
+                                                       size_type n, F f)
+{
+    return batch<true>(keys, data, n, f);
+}
+
+template<class GrowTableData> template <bool Update, class F>
+inline typename GrowTableHandle<GrowTableData>::size_type
+GrowTableHandle<GrowTableData>::batch(const key_type* keys,
+                                      const mapped_type* data,
+                                      size_type n, F f)
+{
+    std::vector<size_type> order(n);
+    std::vector<size_type> retry;
+    ReturnCode             codes[_batch_chunk];
+    size_type              inserted = 0;
+
+    // each chunk is sorted on its own (the hash order does not depend on
+    // the table size), sorting the whole batch would fill the table one
+    // part after the other, far beyond the fill factor
+    execute([](HashPtrRef_t t, const key_type* keys, size_type n,
+               size_type* order) -> int
+            {
+                for (size_type s = 0; s < n; s += _batch_chunk)
+                {
+                    size_type m = std::min(_batch_chunk, n - s);
+                    t->batch_order(keys+s, m, order+s);
+                    for (size_type j = s; j < s+m; ++j) order[j] += s;
+                }
+                return 0;
+            },
+            keys, n, order.data());
+
+    while (! order.empty())
+    {
+        for (size_type s = 0; s < order.size(); s += _batch_chunk)
+        {
+            size_type m = std::min(_batch_chunk, order.size() - s);
+            execute([](HashPtrRef_t t, const key_type* keys,
+                       const mapped_type* data, const size_type* order,
+                       size_type m, ReturnCode* codes, F f) -> int
+                    {
+                        t->template batch_intern<Update>(keys, data, order, m,
+                                                         codes, f);
+                        return 0;
+                    }, keys, data, order.data()+s, m, &codes[0], f);
+
+            bool full    = false;
+            bool invalid = false;
+            for (size_type j = 0; j < m; ++j)
+            {
+                switch(codes[j])
+                {
+                case ReturnCode::SUCCESS_IN:
+                case ReturnCode::TSX_SUCCESS_IN:
+                    ++inserted;
+                    inc_inserted();
+                    break;
+                case ReturnCode::SUCCESS_IN_REUSED:
+                    ++inserted;
+                    inc_reused();
+                    break;
+                case ReturnCode::UNSUCCESS_FULL:
+                case ReturnCode::TSX_UNSUCCESS_FULL:
+                    full = true;
+                    retry.push_back(order[s+j]);
+                    break;
+                case ReturnCode::UNSUCCESS_INVALID:
+                case ReturnCode::TSX_UNSUCCESS_INVALID:
+                    invalid = true;
+                    retry.push_back(order[s+j]);
+                    break;
+                default:
+                    break;
+                }
+            }
+
+            if (full)         grow();
+            else if (invalid) help_grow();
+        }
+        order.swap(retry);
+        retry.clear();
+    }
+    return inserted;
+}
+
 template<class GrowTableData>
 inline typename GrowTableHandle<GrowTableData>::size_type
 GrowTableHandle<GrowTableData>::erase(const key_type& k)
 {
     int v = -1;
     ReturnCode result = ReturnCode::ERROR;
-    std::tie (v, result) = execute([](HashPtrRef_t t, const key_type& k)
+    std::tie (v, result) = kexecute([](HashPtrRef_t t, const key_type& k)
                                      ->std::pair<int,ReturnCode>
                                    {
                                        std::pair<int,ReturnCode> result =
@@ -499,7 +859,7 @@ GrowTableHandle<GrowTableData>::update(const key_type& k, F f, Types&& ... args)
     int v = -1;
     base_intern_insert_return_type result = std::make_pair(bend(), ReturnCode::ERROR);
 
-    std::tie (v, result) = execute(
+    std::tie (v, result) = kexecute(
         [](HashPtrRef_t t, const key_type& k, F f, Types&& ... args)
         ->std::pair<int,base_intern_insert_return_type>
         {
@@ -538,7 +898,7 @@ GrowTableHandle<GrowTableData>::insert_or_update(const key_type& k, const mapped
     int v = -1;
     base_intern_insert_return_type result = std::make_pair(bend(), ReturnCode::ERROR);
 
-    std::tie (v, result) = execute(
+    std::tie (v, result) = kexecute(
         [](HashPtrRef_t t, const key_type& k, const mapped_type& d, F f, Types&& ... args)
         ->std::pair<int,base_intern_insert_return_type>
         {
@@ -554,6 +914,9 @@ GrowTableHandle<GrowTableData>::insert_or_update(const key_type& k, const mapped
     case ReturnCode::TSX_SUCCESS_IN:
         inc_inserted();
         return std::make_pair(iterator(result.first,v,*this), true);
+    case ReturnCode::SUCCESS_IN_REUSED:
+        inc_reused();
+        return std::make_pair(iterator(result.first,v,*this), true);
     case ReturnCode::SUCCESS_UP:
     case ReturnCode::TSX_SUCCESS_UP:
         return std::make_pair(iterator(result.first,v,*this), false);
@@ -577,7 +940,7 @@ GrowTableHandle<GrowTableData>::update_unsafe(const key_type& k, F f, Types&& ..
     int v = -1;
     base_intern_insert_return_type result = std::make_pair(bend(), ReturnCode::ERROR);
 
-    std::tie (v, result) = execute(
+    std::tie (v, result) = kexecute(
         [](HashPtrRef_t t, const key_type& k, F f, Types&& ... args)
         ->std::pair<int,base_intern_insert_return_type>
         {
@@ -619,7 +982,7 @@ GrowTableHandle<GrowTableData>::insert_or_update_unsafe(const key_type& k, const
     int v = -1;
     base_intern_insert_return_type result = std::make_pair(bend(), ReturnCode::ERROR);
 
-    std::tie (v, result) = execute(
+    std::tie (v, result) = kexecute(
         [](HashPtrRef_t t, const key_type& k, const mapped_type& d, F f, Types&& ... args)
         ->std::pair<int,base_intern_insert_return_type>
         {
@@ -635,6 +998,9 @@ GrowTableHandle<GrowTableData>::insert_or_update_unsafe(const key_type& k, const
     case ReturnCode::TSX_SUCCESS_IN:
         inc_inserted();
         return std::make_pair(iterator(result.first,v,*this), true);
+    case ReturnCode::SUCCESS_IN_REUSED:
+        inc_reused();
+        return std::make_pair(iterator(result.first,v,*this), true);
     case ReturnCode::SUCCESS_UP:
     case ReturnCode::TSX_SUCCESS_UP:
         return std::make_pair(iterator(result.first,v,*this), false);
@@ -653,6 +1019,87 @@ GrowTableHandle<GrowTableData>::insert_or_update_unsafe(const key_type& k, const
 
 
 
+// RESERVE *********************************************************************
+
+template<class GrowTableData>
+inline void GrowTableHandle<GrowTableData>::reserve(size_type n)
+{
+    while (true)
+    {
+        size_type cap      = execute([](HashPtrRef_t t) { return t->_capacity; });
+        size_type target   = _gt_data.reserve_capacity(cap, n);
+        auto&     reserved = _gt_data._reserved;
+        size_type temp     = reserved.load(std::memory_order_relaxed);
+        if (target <= cap)
+        {
+            // reached reservations are removed (shrinking works again)
+            while (temp && temp <= cap
+                   && ! reserved.compare_exchange_weak(temp, 0)) { }
+            return;
+        }
+
+        // the next migration uses the reserved capacity (a running
+        // migration is finished first, then we try again)
+        while (temp < target
+               && ! reserved.compare_exchange_weak(temp, target,
+                                                   std::memory_order_acq_rel)) { }
+        grow();
+    }
+}
+
+
+
+// BULK BUILD ******************************************************************
+
+template<class GrowTableData>
+inline typename GrowTableHandle<GrowTableData>::size_type
+GrowTableHandle<GrowTableData>::build(const std::pair<key_type, mapped_type>* data,
+                                      size_type n, size_type threads)
+{
+    reserve(n);
+    return build(data, n, threads,
+                 std::integral_constant<bool, BaseTable_t::bulk_build>());
+}
+
+template<class GrowTableData>
+inline typename GrowTableHandle<GrowTableData>::size_type
+GrowTableHandle<GrowTableData>::build(const std::pair<key_type, mapped_type>* data,
+                                      size_type n, size_type threads,
+                                      std::true_type)
+{
+    size_type inserted = execute(
+        [](HashPtrRef_t t, const std::pair<key_type, mapped_type>* data,
+           size_type n, size_type threads)
+        { return t->build(data, n, threads); },
+        data, n, threads);
+    _gt_data._elements.fetch_add(inserted, std::memory_order_relaxed);
+    return inserted;
+}
+
+template<class GrowTableData>
+inline typename GrowTableHandle<GrowTableData>::size_type
+GrowTableHandle<GrowTableData>::build(const std::pair<key_type, mapped_type>* data,
+                                      size_type n, size_type threads,
+                                      std::false_type)
+{
+    threads = std::max<size_type>(threads, 1);
+    std::vector<size_type>   inserted(threads, 0);
+    std::vector<std::thread> workers;
+    auto fill = [this, data, n, threads, &inserted](size_type t)
+    {
+        This_t handle(_gt_data);
+        for (size_type i = n*t/threads; i < n*(t+1)/threads; ++i)
+            if (handle.insert(data[i].first, data[i].second).second)
+                ++inserted[t];
+    };
+    for (size_type t = 1; t < threads; ++t) workers.emplace_back(fill, t);
+    fill(0);
+    for (auto& w : workers) w.join();
+    return std::accumulate(inserted.begin(), inserted.end(), size_type(0));
+}
+
+
+
 // ELEMENT COUNTING STUFF ******************************************************
 
 template<class GrowTableData>
@@ -667,10 +1114,15 @@ inline void GrowTableHandle<GrowTableData>::update_numbers()
     // temp     += _inserted;
     // _inserted  = 0;
 
-    int cap = get_table()->_capacity * _max_fill_factor;
+    // the size estimate does not wait for a running (incremental) migration
+    auto table = _local_exclusion.peek_table();
+    int  cap   = table->_capacity
+                 * _gt_data._max_fill.load(std::memory_order_relaxed);
+    bool full  = temp + _inserted > cap && ! compact(table, compactable_t());
+    full       = full || shrink_due(table);
     rls_table();
 
-    if (temp + _inserted > cap)
+    if (full)
     {
         //rls_table();
         grow();
@@ -679,6 +1131,33 @@ inline void GrowTableHandle<GrowTableData>::update_numbers()
     //rls_table();
 }
 
+template<class GrowTableData>
+inline bool GrowTableHandle<GrowTableData>::shrink_due(HashPtrRef_t table)
+{
+    if (_gt_data._shrink_fill.load(std::memory_order_relaxed) <= 0.) return false;
+
+    return _gt_data.next_capacity(table->_capacity) < table->_capacity;
+}
+
+template<class GrowTableData>
+inline bool GrowTableHandle<GrowTableData>::compact(HashPtrRef_t table,
+                                                    std::true_type)
+{
+    size_t cap = table->_capacity;
+    if (! _gt_data._compaction.load(std::memory_order_relaxed)
+        || _gt_data.next_capacity(cap) != cap) return false;
+
+    blockwise_compact(table, [this](int n)
+                      {
+                          _gt_data._dummies .fetch_sub(n, std::memory_order_relaxed);
+                          _gt_data._elements.fetch_sub(n, std::memory_order_relaxed);
+                      });
+    int elements = _gt_data._elements.load(std::memory_order_acquire);
+
+    return elements <= cap * _compact_fill_factor
+                           * _gt_data._max_fill.load(std::memory_order_relaxed);
+}
+
 template<class GrowTableData>
 inline void GrowTableHandle<GrowTableData>::inc_inserted()
 {
@@ -699,6 +1178,17 @@ inline void GrowTableHandle<GrowTableData>::inc_deleted()
     }
 }
 
+// a reused cell was counted as a deleted cell (dummy) before
+template<class GrowTableData>
+inline void GrowTableHandle<GrowTableData>::inc_reused()
+{
+    --_deleted;
+    if (++_updates > 64)
+    {
+        update_numbers();
+    }
+}
+
 }
 
 #endif // GROWTABLE_H
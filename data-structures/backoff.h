@@ -0,0 +1,35 @@
+/*******************************************************************************
+ * data-structures/backoff.h
+ *
+ * backoff is called in each round of a waiting loop (e.g. while waiting for
+ * other threads to finish a migration or compaction block). The first
+ * rounds pause, later rounds yield the core, since the awaited thread
+ * might not run, if there are more threads than cores.
+ *
+ * Part of Project growt - https://github.com/TooBiased/growt.git
+ *
+ * Copyright (C) 2015-2016 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <stdlib.h>
+#include <thread>
+
+#include <xmmintrin.h>
+
+namespace growt {
+
+// waiting threads pause this often, before they yield their core
+static constexpr size_t spins_before_yield = 64;
+
+// round counts the calls of one waiting loop (starting at 0)
+static inline void backoff(size_t& round)
+{
+    if (++round < spins_before_yield) _mm_pause();
+    else std::this_thread::yield();
+}
+
+}
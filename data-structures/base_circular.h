@@ -14,32 +14,43 @@
 #pragma once
 
 #include <stdlib.h>
+#include <cassert>
 #include <functional>
 #include <atomic>
 #include <stdexcept>
 #include <iostream>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <thread>
 
 #include "utils/default_hash.hpp"
 #include "data-structures/returnelement.h"
 #include "data-structures/base_iterator.h"
+#include "data-structures/probe_kernel.h"
+#include "data-structures/probe_stats.h"
+#include "data-structures/growth_policy.h"
+#include "data-structures/occupancy_summary.h"
+#include "data-structures/migration_scheduler.h"
+#include "data-structures/backoff.h"
 #include "example/update_fcts.h"
-#include <iostream> 
 
-//#define DEBUG_HASH
 namespace growt {
 
 template<class E, class HashFct = utils_tm::hash_tm::default_hash,
-         class A = std::allocator<E>>
+         class A = std::allocator<E>, class Stats = NoProbeStats,
+         class Growth = GrowDouble, class Occupancy = NoOccupancy>
 class BaseCircular
 {
 private:
-    using This_t          = BaseCircular<E,HashFct,A>;
+    using This_t          = BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>;
     using Allocator_t     = typename A::template rebind<E>::other;
 
     template <class> friend class GrowTableHandle;
 
 public:
     using value_intern       = E;
+    using pointer_intern     = value_intern*;
 
     using key_type           = typename value_intern::key_type;
     using mapped_type        = typename value_intern::mapped_type;
@@ -60,11 +71,10 @@ public:
     using node_type            = void;
 
     using Handle             = This_t&;
-private:
+protected:
     using insert_return_intern = std::pair<iterator, ReturnCode>;
 
 public:
-    std::vector<int> distances;
     BaseCircular(size_type size_ = 1<<18);
     BaseCircular(size_type size_, size_type version_);
 
@@ -92,6 +102,14 @@ public:
     iterator           find  (const key_type& k);
     const_iterator     find  (const key_type& k) const;
 
+    // like find, without creating an iterator (e.g. for sets, see GrowSet)
+    bool               contains(const key_type& k) const;
+
+    // looks for n keys at once, found[i] and out[i] are set for each key
+    // probes are interleaved to overlap their cache misses (returns #found)
+    size_type          find_batch(const key_type* keys, size_type n,
+                                  mapped_type* out, bool* found) const;
+
     insert_return_type insert_or_assign(const key_type& k, const mapped_type& d)
     { return insert_or_update(k, d, example::Overwrite(), d); }
 
@@ -117,18 +135,121 @@ public:
 
     size_type          erase_if(const key_type& k, const mapped_type& d);
 
-    size_type migrate(This_t& target, size_type s, size_type e);
+    // merges the probe distance histograms of all threads (see
+    // probe_stats.h), they are empty unless Stats = ProbeStats
+    ProbeStatistics    probe_stats() const { return _stats.merge(); }
+    // the target of a migration records into the statistics of its source
+    // (called by the exclusion strategy, before the target is published)
+    void               share_stats(const BaseCircular& source)
+    { _stats.share(source._stats); }
+
+    // batched variants of insert and insert_or_update (returns #inserted)
+    // existing elements are updated with f(current_data, data[i])
+    size_type          insert_batch(const key_type* keys,
+                                    const mapped_type* data, size_type n);
+    template <class F>
+    size_type          insert_or_update_batch(const key_type* keys,
+                                              const mapped_type* data,
+                                              size_type n, F f);
+
+    // fills an empty table with the n given elements (returns #inserted,
+    // the first occurrence of a key wins), the input is partitioned by the
+    // home cells of its elements, then each of the threads fills one
+    // range of cells with plain stores, this cannot run concurrently to
+    // other operations (see bulk_build)
+    size_type build(const std::pair<key_type, mapped_type>* data,
+                    size_type n, size_type threads);
+
+    // calls f(key, data) for all elements, whose home cell in a table of
+    // capacity cap is in [s,e), cap can differ from the table's capacity
+    // (e.g. the table was migrated during a parallel scan, see
+    // parallel_scan.h), then all candidates are checked by their hash
+    template <class F>
+    void for_each_home(size_type cap, size_type s, size_type e, F f) const;
+
+    // calls f(key, data) for the elements whose hash is at least cursor
+    // (in the order of their home cells, whole cells at a time), until at
+    // least max elements were visited, returns the cursor of the next call
+    // (0 once the end of the table is reached), the cursor does not depend
+    // on the capacity (scans continue after migrations)
+    template <class F>
+    size_type scan(size_type cursor, size_type max, F f) const;
+
+    // the target can be a derived table (its insert_unsafe is used),
+    // initialized targets can be changed concurrently (elements are
+    // inserted with cas, see EStratIncremental)
+    template <class Target>
+    size_type migrate(Target& target, size_type s, size_type e,
+                      bool initialized = false);
+
+    // true if all cells from the empty cell in front of k's cluster up to
+    // the end of k's probe are marked (k cannot change in this table
+    // anymore), start is set to that empty cell (its block migrates the
+    // cluster), or to _capacity if k's home cell is empty
+    bool marked_cluster(const key_type& k, size_type& start) const;
+
+    // removes deleted cells at the end of clusters starting in [s,e), this
+    // runs concurrently to all operations except migrations (returns
+    // #removed cells)
+    size_type compact(size_type s, size_type e);
+
+    // empties the cells [s,e), unaligned targets are initialized completely
+    // before the migration starts (see blockwise_migrate)
+    void initialize(size_type s, size_type e);
 
     size_type          _capacity;
     size_type          _version;
     std::atomic_size_t _current_copy_block;
-
-    static size_type resize(size_type current, size_type inserted, size_type deleted)
+    std::atomic_size_t _finished_copy_block;
+    std::atomic_size_t _current_compact_block;
+    std::atomic_size_t _finished_compact_block;
+    std::atomic_size_t _n_compacting;
+    // distributes the blocks of aligned migrations (see blockwise_migrate)
+    MigrationScheduler _migration;
+
+    // deleted cells can only be removed in place, if insertions check
+    // their cluster after claiming a cell (see claim_intern)
+    static constexpr bool compactable = value_intern::reuse_deleted;
+
+    // migrate can fill tables of any capacity (not only power of two
+    // multiples of its own capacity, elements are inserted with cas)
+    static constexpr bool unaligned_migration = true;
+
+    // build writes elements with plain stores, this does not work for
+    // elements that create their memory when they are stored (see cas),
+    // growing tables insert in parallel instead (see GrowTableHandle::build)
+    static constexpr bool bulk_build = ! value_intern::owns_memory;
+
+    // growing tables are migrated once this fill rate is exceeded, the
+    // migration grows the table if the fill rate without deleted cells
+    // exceeds grow_fill_factor (both can be changed per growing table)
+    static constexpr double max_fill_factor  = 0.666;
+    static constexpr double grow_fill_factor = 0.6/2.;
+
+    // tables with a fill rate below shrink_fill are shrunk (at most twice),
+    // as long as the new fill rate stays below 2/3 of grow_fill (this
+    // hysteresis avoids growing right after shrinking)
+    static size_type resize(size_type current, size_type inserted,
+                            size_type deleted,
+                            double grow_fill   = grow_fill_factor,
+                            double shrink_fill = 0.)
     {
         auto nsize = current;
         double fill_rate = double(inserted - deleted)/double(current);
 
-        if (fill_rate > 0.6/2.) nsize <<= 1;
+        if (fill_rate > grow_fill) nsize = Growth::grow(nsize);
+        else if (fill_rate < shrink_fill)
+        {
+            for (size_type i = 0; i < 2; ++i)
+            {
+                auto   smaller = Growth::shrink(nsize);
+                double rate    = fill_rate * double(nsize) / double(smaller);
+                if (smaller < compute_capacity(0) || rate > grow_fill*2./3.)
+                    break;
+                nsize     = smaller;
+                fill_rate = rate;
+            }
+        }
 
         return nsize;
     }
@@ -143,9 +264,47 @@ protected:
     HashFct     _hash;
 
     value_intern* _t;
-    size_type h(const key_type & k) const { return _hash(k) >> _right_shift; }
+    Stats         _stats;
+    // groups of cells that can contain elements (see occupancy_summary.h)
+    Occupancy     _occupancy;
+
+    // frees memory owned by the cells (see value_intern::owns_memory)
+    void release_cells(std::false_type) { }
+    void release_cells(std::true_type)
+    { for (size_type i = 0; i < _capacity; ++i) _t[i].release(); }
+
+    size_type h(const key_type & k) const
+    { return Growth::reduce(_hash(k), _capacity, _right_shift); }
+
+    // keys that collide with the sentinels of value_intern (e.g. the
+    // reservation of MarkableElement) would be lost, they are rejected
+    // (insertions return ERROR, asserted in debug builds), elements
+    // without valid_key accept all keys
+    static bool rejected(const key_type& k)
+    { return rejected_intern<value_intern>(k, 0); }
+    template <class V>
+    static auto rejected_intern(const key_type& k, int)
+        -> decltype(V::valid_key(k))
+    {
+        assert(V::valid_key(k) && "key collides with a sentinel of the element");
+        return ! V::valid_key(k);
+    }
+    template <class V>
+    static bool rejected_intern(const key_type&, long) { return false; }
 
-private:
+    // cell of the probe index i (i < 2*_capacity, see Growth::wrap)
+    size_type wrap(size_type i) const
+    { return Growth::wrap(i, _capacity, _bitmask); }
+
+    // the cell behind i, empty groups are skipped (see occupancy_summary.h)
+    size_type next_cell(size_type i, size_type e) const
+    {
+        ++i;
+        if (! Occupancy::enabled || i % OccupancySummary::group_size) return i;
+        return _occupancy.next(i, e);
+    }
+
+protected:
     insert_return_intern insert_intern(const key_type& k, const mapped_type& d);
     ReturnCode           erase_intern (const key_type& k);
     ReturnCode           erase_if_intern (const key_type& k, const mapped_type& d);
@@ -168,6 +327,73 @@ private:
     insert_return_intern insert_or_update_unsafe_intern
     (const key_type& k, const mapped_type& d, F f, Types&& ... args);
 
+    // inserts k, if k is already present, found(pos, element) is called, it
+    // returns ERROR to restart the insertion, deleted cells are reused if the
+    // element type allows it (value_intern::reuse_deleted)
+    template <class Found>
+    insert_return_intern claim_intern(const key_type& k, const mapped_type& d,
+                                      Found found)
+    {
+        return claim_intern(std::integral_constant<bool,
+                                    value_intern::reuse_deleted>(),
+                            k, d, found);
+    }
+    template <class Found>
+    insert_return_intern claim_intern(std::false_type, const key_type& k,
+                                      const mapped_type& d, Found found);
+    template <class Found>
+    insert_return_intern claim_intern(std::true_type, const key_type& k,
+                                      const mapped_type& d, Found found);
+
+    // loads the data word before the key word (the compiler may split a
+    // plain copy), thus, a reservation for k that is present at the first
+    // load is seen either as reservation, as stored k, or as aborted
+    inline value_intern load_ordered(size_type i) const
+    {
+        const value_intern& cell = _t[wrap(i)];
+        mapped_type d = __atomic_load_n(&cell.data, __ATOMIC_ACQUIRE);
+        return value_intern(__atomic_load_n(&cell.key, __ATOMIC_ACQUIRE), d);
+    }
+
+    // spins until position i no longer holds cell (a reservation or a
+    // locked cell), i.e., until it is committed/removed/released
+    inline void wait_change(size_type i, const value_intern& cell) const
+    {
+        while (true)
+        {
+            value_intern temp = load_ordered(i);
+            if (temp.key != cell.key || temp.data != cell.data) return;
+        }
+    }
+
+    // makes our (possibly aborted) reservation for k at position c reusable
+    inline void release_reservation(size_type c, const key_type& k)
+    {
+        value_intern temp(_t[wrap(c)]);
+        while ((temp.is_reservation(k) || temp.is_aborted(k))
+               && ! temp.is_marked())
+        {
+            if (_t[wrap(c)].cas(temp, value_intern::get_deleted())) return;
+            temp = _t[wrap(c)];
+        }
+    }
+
+    // processes the pairs keys[order[j]], data[order[j]] for j < n
+    // codes[j] receives the ReturnCode of each operation
+    template <bool Update, class F>
+    void batch_intern(const key_type* keys, const mapped_type* data,
+                      const size_type* order, size_type n,
+                      ReturnCode* codes, F f);
+
+    // sorts the batch by hash value, since h() uses the leading hash bits,
+    // this order is consistent with the slot order for any table size
+    void batch_order (const key_type* keys, size_type n,
+                      size_type* order) const;
+
+    template <bool Update, class F>
+    size_type batch(const key_type* keys, const mapped_type* data,
+                    size_type n, F f);
+
 
 
 
@@ -175,10 +401,12 @@ private:
 
     inline iterator           make_iterator (const key_type& k, const mapped_type& d,
                                             value_intern* ptr)
-    { return iterator(std::make_pair(k,d), ptr, _t+_capacity); }
+    { return iterator(std::make_pair(k,d), ptr, _t+_capacity,
+                      _occupancy.summary(), _t); }
     inline const_iterator     make_citerator (const key_type& k, const mapped_type& d,
                                             value_intern* ptr) const
-    { return const_iterator(std::make_pair(k,d), ptr, _t+_capacity); }
+    { return const_iterator(std::make_pair(k,d), ptr, _t+_capacity,
+                            _occupancy.summary(), _t); }
     inline insert_return_type make_insert_ret(const key_type& k, const mapped_type& d,
                                             value_intern* ptr, bool succ)
     { return std::make_pair(make_iterator(k,d, ptr), succ); }
@@ -197,15 +425,38 @@ private:
     // OTHER HELPER FUNCTIONS **************************************************
 
     void insert_unsafe(const value_intern& e);
+    void insert_cas   (const value_intern& e);
 
-    // capacity is at least twice as large, as the inserted capacity
-    static size_type compute_capacity(size_type desired_capacity)
+    // number of simultaneously probed keys in batched operations
+    static constexpr size_type batch_window      = 16;
+    static constexpr size_type elements_per_line = (64 >= sizeof(value_intern))
+                                                   ? 64/sizeof(value_intern) : 1;
+
+    inline void prefetch(size_type pos) const
+    { __builtin_prefetch(&_t[wrap(pos)]); }
+
+    // skips all cells that cannot end the probe for k (neither k, empty,
+    // nor marked), whole lines at a time (see probe_kernel.h)
+    // returns the (unmasked) position of the next interesting cell
+    using probe_kernel = ProbeKernel<value_intern>;
+    inline size_type probe(size_type i, const key_type& k) const
     {
-        auto temp = 16384u;
-        while (temp < desired_capacity) temp <<= 1;
-        return temp << 1;
+        if (! probe_kernel::vectorized) return i;
+
+        constexpr size_type line_size = probe_kernel::line_size;
+        while (true)
+        {
+            size_type lane = i & (line_size-1);
+            size_type r    = probe_kernel::first(&_t[wrap(i) - lane],
+                                                 lane, k);
+            if (r < line_size) return i - lane + r;
+            i += line_size - lane;
+        }
     }
 
+    static size_type compute_capacity(size_type desired_capacity)
+    { return Growth::capacity(desired_capacity); }
+
     static size_type compute_right_shift(size_type capacity)
     {
         size_type log_size = 0;
@@ -213,32 +464,6 @@ private:
         return 64 - log_size;                    // HashFct::significant_digits
     }
 
-  void Summary() {
-      #ifndef DEBUG_HASH
-        return; 
-      #endif 
-  int sum = 0;
-  for (int d: distances) {
-    if (d != -1) {
-      sum += d;
-    }
-  }
-  double avg = ((double)sum)/distances.size();
-  double var = 0;
-  for (int d : distances) {
-    var += (d-avg)*(d-avg);
-  }
-  if (distances.size() == 0) return;
-  var /= distances.size();
-  std::sort(distances.begin(), distances.end());
-  std::cout << "\nFor " << distances.size() << " elements..." << std::endl;
-  std::cout << "MIN: " << distances[0] << std::endl;
-  std::cout << "MEDIAN: " << distances[distances.size()/2] << std::endl;
-  std::cout << "AVG: " << avg << std::endl;
-  std::cout << "MAX: " << distances[distances.size()-1] << std::endl;
-  std::cout << "VAR: " << var << std::endl;
-}
-
 public:
     using range_iterator = iterator;
     using const_range_iterator = const_iterator;
@@ -262,51 +487,66 @@ public:
 
 // CONSTRUCTORS/ASSIGNMENTS ****************************************************
 
-template<class E, class HashFct, class A>
-BaseCircular<E,HashFct,A>::BaseCircular(size_type capacity_)
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy>
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::BaseCircular(size_type capacity_)
     : _capacity(compute_capacity(capacity_)),
       _version(0),
       _current_copy_block(0),
+      _finished_copy_block(0),
+      _current_compact_block(0),
+      _finished_compact_block(0),
+      _n_compacting(0),
+      _migration(_capacity),
       _bitmask(_capacity-1),
-      _right_shift(compute_right_shift(_capacity))
+      _right_shift(compute_right_shift(_capacity)),
+      _occupancy(_capacity)
 
 {
     _t = _allocator.allocate(_capacity);
-    #ifdef DEBUG_HASH
-        std::cout << "N size" << capacity_ << "actual size " << _capacity << std::endl;
-    #endif 
-
     if ( !_t ) std::bad_alloc();
 
     std::fill( _t ,_t + _capacity , value_intern::get_empty() );
 }
 
-/*should always be called with a capacity_=2^k  */
-template<class E, class HashFct, class A>
-BaseCircular<E,HashFct,A>::BaseCircular(size_type capacity_, size_type version_)
+/*should always be called with a capacity_ computed by Growth (2^k for GrowDouble)  */
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy>
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::BaseCircular(size_type capacity_, size_type version_)
     : _capacity(capacity_),
       _version(version_),
       _current_copy_block(0),
+      _finished_copy_block(0),
+      _current_compact_block(0),
+      _finished_compact_block(0),
+      _n_compacting(0),
+      _migration(_capacity),
       _bitmask(_capacity-1),
-      _right_shift(compute_right_shift(_capacity))
+      _right_shift(compute_right_shift(_capacity)),
+      _occupancy(_capacity)
 {
     _t = _allocator.allocate(_capacity);
     if ( !_t ) std::bad_alloc();
+
+    // the destructor inspects all cells (to release owned memory)
+    if (value_intern::owns_memory)
+        std::fill( _t ,_t + _capacity , value_intern::get_empty() );
 }
 
-template<class E, class HashFct, class A>
-BaseCircular<E,HashFct,A>::~BaseCircular()
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy>
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::~BaseCircular()
 {
-  Summary();  
-  distances.clear();
-  if (_t) _allocator.deallocate(_t, _capacity);
+    if (!_t) return;
+    release_cells(std::integral_constant<bool, value_intern::owns_memory>());
+    _allocator.deallocate(_t, _capacity);
 }
 
 
-template<class E, class HashFct, class A>
-BaseCircular<E,HashFct,A>::BaseCircular(BaseCircular&& rhs)
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy>
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::BaseCircular(BaseCircular&& rhs)
     : _capacity(rhs._capacity), _version(rhs._version),
       _current_copy_block(rhs._current_copy_block.load()),
+      _finished_copy_block(0),
+      _current_compact_block(0), _finished_compact_block(0),
+      _n_compacting(0), _migration(_capacity),
       _bitmask(rhs._bitmask), _right_shift(rhs._right_shift), _t(nullptr)
 {
     if (_current_copy_block.load())
@@ -315,23 +555,31 @@ BaseCircular<E,HashFct,A>::BaseCircular(BaseCircular&& rhs)
     rhs._bitmask = 0;
     rhs._right_shift = HashFct::significant_digits;
     std::swap(_t, rhs._t);
+    std::swap(_stats, rhs._stats);
+    std::swap(_occupancy, rhs._occupancy);
 }
 
-template<class E, class HashFct, class A>
-BaseCircular<E,HashFct,A>&
-BaseCircular<E,HashFct,A>::operator=(BaseCircular&& rhs)
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy>
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>&
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::operator=(BaseCircular&& rhs)
 {
     if (rhs._current_copy_block.load())
         std::invalid_argument("Cannot move a growing table!");
     _capacity   = rhs._capacity;
     _version    = rhs._version;
     _current_copy_block.store(0);;
+    _finished_copy_block.store(0);
+    _current_compact_block.store(0);
+    _finished_compact_block.store(0);
+    _migration.reset(_capacity);
     _bitmask     = rhs._bitmask;
     _right_shift = rhs._right_shift;
     rhs._capacity    = 0;
     rhs._bitmask = 0;
     rhs._right_shift = HashFct::significant_digits;
     std::swap(_t, rhs._t);
+    std::swap(_stats, rhs._stats);
+    std::swap(_occupancy, rhs._occupancy);
 
     return *this;
 }
@@ -345,11 +593,12 @@ BaseCircular<E,HashFct,A>::operator=(BaseCircular&& rhs)
 
 // ITERATOR FUNCTIONALITY ******************************************************
 
-template<class E, class HashFct, class A>
-inline typename BaseCircular<E,HashFct,A>::iterator
-BaseCircular<E,HashFct,A>::begin()
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy>
+inline typename BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::iterator
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::begin()
 {
-    for (size_t i = 0; i<_capacity; ++i)
+    for (size_t i = _occupancy.next(0, _capacity); i < _capacity;
+         i = next_cell(i, _capacity))
     {
         auto temp = _t[i];
         if (!temp.is_empty() && !temp.is_deleted())
@@ -358,17 +607,18 @@ BaseCircular<E,HashFct,A>::begin()
     return end();
 }
 
-template<class E, class HashFct, class A>
-inline typename BaseCircular<E,HashFct,A>::iterator
-BaseCircular<E,HashFct,A>::end()
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy>
+inline typename BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::iterator
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::end()
 { return iterator(std::make_pair(key_type(), mapped_type()),nullptr,nullptr); }
 
 
-template<class E, class HashFct, class A>
-inline typename BaseCircular<E,HashFct,A>::const_iterator
-BaseCircular<E,HashFct,A>::cbegin() const
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy>
+inline typename BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::const_iterator
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::cbegin() const
 {
-    for (size_t i = 0; i<_capacity; ++i)
+    for (size_t i = _occupancy.next(0, _capacity); i < _capacity;
+         i = next_cell(i, _capacity))
     {
         auto temp = _t[i];
         if (!temp.is_empty() && !temp.is_deleted())
@@ -377,9 +627,9 @@ BaseCircular<E,HashFct,A>::cbegin() const
     return end();
 }
 
-template<class E, class HashFct, class A>
-inline typename BaseCircular<E,HashFct,A>::const_iterator
-BaseCircular<E,HashFct,A>::cend() const
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy>
+inline typename BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::const_iterator
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::cend() const
 {
     return const_iterator(std::make_pair(key_type(),mapped_type()),
                           nullptr,nullptr);
@@ -388,34 +638,38 @@ BaseCircular<E,HashFct,A>::cend() const
 
 // RANGE ITERATOR FUNCTIONALITY ************************************************
 
-template<class E, class HashFct, class A>
-inline typename BaseCircular<E,HashFct,A>::range_iterator
-BaseCircular<E,HashFct,A>::range(size_t rstart, size_t rend)
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy>
+inline typename BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::range_iterator
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::range(size_t rstart, size_t rend)
 {
     auto temp_rend = std::min(rend, _capacity);
-    for (size_t i = rstart; i < temp_rend; ++i)
+    for (size_t i = _occupancy.next(rstart, temp_rend); i < temp_rend;
+         i = next_cell(i, temp_rend))
     {
         auto temp = _t[i];
         if (!temp.is_empty() && !temp.is_deleted())
             return range_iterator(std::make_pair(temp.get_key(),
                                                  temp.get_data()),
-                                  &_t[i], &_t[temp_rend]);
+                                  &_t[i], &_t[temp_rend],
+                                  _occupancy.summary(), _t);
     }
     return range_end();
 }
 
-template<class E, class HashFct, class A>
-inline typename BaseCircular<E,HashFct,A>::const_range_iterator
-BaseCircular<E,HashFct,A>::crange(size_t rstart, size_t rend)
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy>
+inline typename BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::const_range_iterator
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::crange(size_t rstart, size_t rend)
 {
     auto temp_rend = std::min(rend, _capacity);
-    for (size_t i = rstart; i < temp_rend; ++i)
+    for (size_t i = _occupancy.next(rstart, temp_rend); i < temp_rend;
+         i = next_cell(i, temp_rend))
     {
         auto temp = _t[i];
         if (!temp.is_empty() && !temp.is_deleted())
             return const_range_iterator(std::make_pair(temp.get_key(),
                                                        temp.get_data()),
-                                  &_t[i], &_t[temp_rend]);
+                                  &_t[i], &_t[temp_rend],
+                                  _occupancy.summary(), _t);
     }
     return range_cend();
 }
@@ -424,16 +678,21 @@ BaseCircular<E,HashFct,A>::crange(size_t rstart, size_t rend)
 
 // MAIN HASH TABLE FUNCTIONALITY (INTERN) **************************************
 
-template<class E, class HashFct, class A>
-inline typename BaseCircular<E,HashFct,A>::insert_return_intern
-BaseCircular<E,HashFct,A>::insert_intern(const key_type& k,
-                                                    const mapped_type& d)
+// without reuse, k is written into the empty cell at the end of its cluster
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy> template<class Found>
+inline typename BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::insert_return_intern
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::claim_intern(std::false_type,
+                                              const key_type& k,
+                                              const mapped_type& d,
+                                              Found found)
 {
+    if (rejected(k)) return make_insert_ret(end(), ReturnCode::ERROR);
     size_type htemp = h(k);
 
     for (size_type i = htemp; ; ++i) //i < htemp+MaDis
     {
-        size_type temp = i & _bitmask;
+        i = probe(i, k);
+        size_type temp = wrap(i);
         value_intern curr(_t[temp]);
 
         if (curr.is_marked())
@@ -441,40 +700,191 @@ BaseCircular<E,HashFct,A>::insert_intern(const key_type& k,
                                    ReturnCode::UNSUCCESS_INVALID);
 
         else if (curr.compare_key(k))
-            return make_insert_ret(k, curr.get_data(), &_t[temp],
-                                   ReturnCode::UNSUCCESS_ALREADY_USED);
+        {
+            auto result = found(temp, curr);
+            if (result.second != ReturnCode::ERROR) return result;
+
+            //somebody changed the current element! recheck it
+            --i;
+        }
         else if (curr.is_empty())
         {
-            if ( _t[temp].cas(curr, value_intern(k,d)) ){
-		//std::cout << k << " ---- " << (int)(i-htemp) << std::endl;
-        #ifdef DEBUG_HASH
-		    distances.push_back((int)(i-htemp));
-        #endif 
+            if ( _t[temp].cas(curr, value_intern(k,d)) )
+            {
+                _stats.insert(i-htemp);
+                _occupancy.set(temp);
                 return make_insert_ret(k,d, &_t[temp],
                                        ReturnCode::SUCCESS_IN);
-	    }
+            }
 
             //somebody changed the current element! recheck it
             --i;
         }
-        else if (curr.is_deleted())
+    }
+    return make_insert_ret(end(), ReturnCode::UNSUCCESS_FULL);
+}
+
+// With reuse, insertions reserve a cell first, either the first reusable
+// deleted cell of k's cluster, or the empty cell at its end. Reservations
+// count as deleted cells (finds, updates, and deletions skip them).
+// Afterwards, the cluster is checked for other copies of k:
+//  - a stored copy of k aborts the insertion (found(...) is called)
+//  - a reservation for k in front of ours wins (we abort and wait for it)
+//  - a reservation for k behind ours loses (we mark it as aborted)
+// Of two concurrent reservations for k, at least one sees the other, since
+// both are written before the cluster is checked. Thus, only one of them
+// is committed (cas from reservation to (k,d)). Only the owner of a
+// reservation makes it reusable again (see release_reservation), therefore,
+// a reservation cannot be replaced by an identical one (ABA).
+// Deleted cells at the end of a cluster may be removed concurrently (see
+// compact), therefore, the check also ensures that no cell in front of
+// our reservation became empty.
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy> template<class Found>
+inline typename BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::insert_return_intern
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::claim_intern(std::true_type,
+                                              const key_type& k,
+                                              const mapped_type& d,
+                                              Found found)
+{
+    if (rejected(k)) return make_insert_ret(end(), ReturnCode::ERROR);
+    const size_type htemp = h(k);
+    value_intern    res   = value_intern::get_reservation(k);
+
+    while (true)
+    {
+        // find k or the end of its cluster (deleted cells are skipped)
+        size_type    e    = htemp;
+        value_intern curr = value_intern::get_empty();
+        for (;; ++e)
         {
-            //do something appropriate
+            e    = probe(e, k);
+            curr = _t[wrap(e)];
+            if (curr.is_marked())
+                return make_insert_ret(end(), ReturnCode::UNSUCCESS_INVALID);
+            if (curr.compare_key(k) || curr.is_empty()) break;
         }
+
+        if (curr.compare_key(k))
+        {
+            auto result = found(wrap(e), curr);
+            if (result.second != ReturnCode::ERROR) return result;
+            continue;
+        }
+
+        // the first reusable cell in front of e is reused, reservations
+        // for k and locked cells (see compact) have to be finished first
+        // (these lines are still cached)
+        size_type    c    = e;
+        value_intern cexp = curr;
+        size_type    w    = e;
+        value_intern wexp = curr;
+        for (size_type i = htemp; i < e; ++i)
+        {
+            value_intern temp(_t[wrap(i)]);
+            if (temp.is_reservation(k) || temp.is_locked())
+            {
+                w    = i;
+                wexp = temp;
+                break;
+            }
+            if (c == e && temp.is_reusable())
+            {
+                c    = i;
+                cexp = temp;
+            }
+        }
+        if (w < e) { wait_change(w, wexp); continue; }
+
+        if (! _t[wrap(c)].cas(cexp, res)) continue;
+        _occupancy.set(wrap(c));
+
+        // check the cluster for other copies of k, cells behind our
+        // reservation can only hold k, if we reused a deleted cell
+        bool restart = false;
+        for (size_type i = htemp; ; ++i)
+        {
+            if (i == c)
+            {
+                if (c == e) break;
+                continue;
+            }
+            value_intern temp = load_ordered(i);
+            if (temp.is_marked())
+            {
+                release_reservation(c, k);
+                return make_insert_ret(end(), ReturnCode::UNSUCCESS_INVALID);
+            }
+            else if (temp.is_empty() || temp.is_locked())
+            {
+                // cells in front of c were removed (see compact), our
+                // reservation is no longer reachable from k's home cell
+                if (i > c) break;
+                release_reservation(c, k);
+                restart = true;
+                break;
+            }
+            else if (temp.compare_key(k))
+            {
+                release_reservation(c, k);
+                auto result = found(wrap(i), temp);
+                if (result.second != ReturnCode::ERROR) return result;
+                restart = true;
+                break;
+            }
+            else if (temp.is_reservation(k))
+            {
+                if (i < c)
+                {
+                    release_reservation(c, k);
+                    wait_change(i, temp);
+                    restart = true;
+                    break;
+                }
+                //somebody changed the current element! recheck it
+                if (! _t[wrap(i)].cas(temp, value_intern::get_aborted(k)))
+                    --i;
+            }
+        }
+        if (restart) continue;
+
+        if (_t[wrap(c)].cas(res, value_intern(k,d)))
+        {
+            _stats.insert(c-htemp);
+            return make_insert_ret(k,d, &_t[wrap(c)],
+                                   (c == e) ? ReturnCode::SUCCESS_IN
+                                            : ReturnCode::SUCCESS_IN_REUSED);
+        }
+        // our reservation was aborted by a reservation in front of it
+        release_reservation(c, k);
+        if (value_intern(_t[wrap(c)]).is_marked())
+            return make_insert_ret(end(), ReturnCode::UNSUCCESS_INVALID);
     }
-    return make_insert_ret(end(), ReturnCode::UNSUCCESS_FULL);
+}
+
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy>
+inline typename BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::insert_return_intern
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::insert_intern(const key_type& k,
+                                               const mapped_type& d)
+{
+    return claim_intern(k, d,
+                        [this, &k](size_type pos, const value_intern& curr)
+                        {
+                            return make_insert_ret(k, curr.get_data(), &_t[pos],
+                                      ReturnCode::UNSUCCESS_ALREADY_USED);
+                        });
 }
 
 
-template<class E, class HashFct, class A> template<class F, class ... Types>
-inline typename BaseCircular<E,HashFct,A>::insert_return_intern
-BaseCircular<E,HashFct,A>::update_intern(const key_type& k, F f, Types&& ... args)
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy> template<class F, class ... Types>
+inline typename BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::insert_return_intern
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::update_intern(const key_type& k, F f, Types&& ... args)
 {
     size_type htemp = h(k);
 
     for (size_type i = htemp; ; ++i) //i < htemp+MaDis
     {
-        size_type temp = i & _bitmask;
+        i = probe(i, k);
+        size_type temp = wrap(i);
         value_intern curr(_t[temp]);
         if (curr.is_marked())
         {
@@ -506,15 +916,16 @@ BaseCircular<E,HashFct,A>::update_intern(const key_type& k, F f, Types&& ... arg
                            ReturnCode::UNSUCCESS_NOT_FOUND);
 }
 
-template<class E, class HashFct, class A> template<class F, class ... Types>
-inline typename BaseCircular<E,HashFct,A>::insert_return_intern
-BaseCircular<E,HashFct,A>::update_unsafe_intern(const key_type& k, F f, Types&& ... args)
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy> template<class F, class ... Types>
+inline typename BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::insert_return_intern
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::update_unsafe_intern(const key_type& k, F f, Types&& ... args)
 {
     size_type htemp = h(k);
 
     for (size_type i = htemp; ; ++i) //i < htemp+MaDis
     {
-        size_type temp = i & _bitmask;
+        i = probe(i, k);
+        size_type temp = wrap(i);
         value_intern curr(_t[temp]);
         if (curr.is_marked())
         {
@@ -546,102 +957,52 @@ BaseCircular<E,HashFct,A>::update_unsafe_intern(const key_type& k, F f, Types&&
 }
 
 
-template<class E, class HashFct, class A> template<class F, class ... Types>
-inline typename BaseCircular<E,HashFct,A>::insert_return_intern
-BaseCircular<E,HashFct,A>::insert_or_update_intern(const key_type& k,
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy> template<class F, class ... Types>
+inline typename BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::insert_return_intern
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::insert_or_update_intern(const key_type& k,
                                                    const mapped_type& d,
                                                    F f, Types&& ... args)
 {
-    size_type htemp = h(k);
-
-    for (size_type i = htemp; ; ++i) //i < htemp+MaDis
-    {
-        size_type temp = i & _bitmask;
-        value_intern curr(_t[temp]);
-        if (curr.is_marked())
-        {
-            return make_insert_ret(end(), ReturnCode::UNSUCCESS_INVALID);
-        }
-        else if (curr.compare_key(k))
+    return claim_intern(k, d,
+        [&](size_type pos, value_intern curr) -> insert_return_intern
         {
             mapped_type data;
             bool        succ;
-            std::tie(data, succ) = _t[temp].atomic_update(curr, f,
-                                                          std::forward<Types>(args)...);
+            std::tie(data, succ) = _t[pos].atomic_update(curr, f,
+                                                         std::forward<Types>(args)...);
             if (succ)
-                return make_insert_ret(k,data, &_t[temp],
-                                       ReturnCode::SUCCESS_UP);
-            i--;
-        }
-        else if (curr.is_empty())
-        {
-            if ( _t[temp].cas(curr, value_intern(k,d)) )
-                return make_insert_ret(k,d, &_t[temp],
-                                       ReturnCode::SUCCESS_IN);
-
-            //somebody changed the current element! recheck it
-            --i;
-        }
-        else if (curr.is_deleted())
-        {
-            //do something appropriate
-        }
-    }
-    return make_insert_ret(end(), ReturnCode::UNSUCCESS_FULL);
+                return make_insert_ret(k,data, &_t[pos], ReturnCode::SUCCESS_UP);
+            return make_insert_ret(end(), ReturnCode::ERROR);
+        });
 }
 
-template<class E, class HashFct, class A> template<class F, class ... Types>
-inline typename BaseCircular<E,HashFct,A>::insert_return_intern
-BaseCircular<E,HashFct,A>::insert_or_update_unsafe_intern(const key_type& k,
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy> template<class F, class ... Types>
+inline typename BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::insert_return_intern
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::insert_or_update_unsafe_intern(const key_type& k,
                                                           const mapped_type& d,
                                                           F f, Types&& ... args)
 {
-    size_type htemp = h(k);
-
-    for (size_type i = htemp; ; ++i) //i < htemp+MaDis
-    {
-        size_type temp = i & _bitmask;
-        value_intern curr(_t[temp]);
-        if (curr.is_marked())
-        {
-            return make_insert_ret(end(),
-                                   ReturnCode::UNSUCCESS_INVALID);
-        }
-        else if (curr.compare_key(k))
+    return claim_intern(k, d,
+        [&](size_type pos, value_intern) -> insert_return_intern
         {
             mapped_type data;
             bool        succ;
-            std::tie(data, succ) = _t[temp].nonAtomicUpdate(f,
-                                                            std::forward<Types>(args)...);
+            std::tie(data, succ) = _t[pos].non_atomic_update(f,
+                                                             std::forward<Types>(args)...);
             if (succ)
-                return make_insert_ret(k,data, &_t[temp],
-                                       ReturnCode::SUCCESS_UP);
-            i--;
-        }
-        else if (curr.is_empty())
-        {
-            if ( _t[temp].cas(curr, value_intern(k,d)) )
-                return make_insert_retC(k,d, &_t[temp],
-                                       ReturnCode::SUCCESS_IN);
-            //somebody changed the current element! recheck it
-            --i;
-        }
-        else if (curr.is_deleted())
-        {
-            //do something appropriate
-        }
-    }
-    return make_insert_ret(end(),
-                           ReturnCode::UNSUCCESS_FULL);
+                return make_insert_ret(k,data, &_t[pos], ReturnCode::SUCCESS_UP);
+            return make_insert_ret(end(), ReturnCode::ERROR);
+        });
 }
 
-template<class E, class HashFct, class A>
-inline ReturnCode BaseCircular<E,HashFct,A>::erase_intern(const key_type& k)
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy>
+inline ReturnCode BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::erase_intern(const key_type& k)
 {
     size_type htemp = h(k);
     for (size_type i = htemp; ; ++i) //i < htemp+MaDis
     {
-        size_type temp = i & _bitmask;
+        i = probe(i, k);
+        size_type temp = wrap(i);
         value_intern curr(_t[temp]);
         if (curr.is_marked())
         {
@@ -666,13 +1027,14 @@ inline ReturnCode BaseCircular<E,HashFct,A>::erase_intern(const key_type& k)
     return ReturnCode::UNSUCCESS_NOT_FOUND;
 }
 
-template<class E, class HashFct, class A>
-inline ReturnCode BaseCircular<E,HashFct,A>::erase_if_intern(const key_type& k, const mapped_type& d)
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy>
+inline ReturnCode BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::erase_if_intern(const key_type& k, const mapped_type& d)
 {
     size_type htemp = h(k);
     for (size_type i = htemp; ; ++i) //i < htemp+MaDis
     {
-        size_type temp = i & _bitmask;
+        i = probe(i, k);
+        size_type temp = wrap(i);
         value_intern curr(_t[temp]);
         if (curr.is_marked())
         {
@@ -705,44 +1067,253 @@ inline ReturnCode BaseCircular<E,HashFct,A>::erase_if_intern(const key_type& k,
 
 // MAIN HASH TABLE FUNCTIONALITY (EXTERN) **************************************
 
-template<class E, class HashFct, class A>
-inline typename BaseCircular<E,HashFct,A>::iterator
-BaseCircular<E,HashFct,A>::find(const key_type& k)
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy>
+inline typename BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::iterator
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::find(const key_type& k)
 {
     size_type htemp = h(k);
-
-//    std::cout << "key" << k << " hash " << _hash(k) << std::endl; 
-  //  std::cout << "size of values" << sizeof(value_intern) << std::endl;  
     for (size_type i = htemp; ; ++i)
     {
-        value_intern curr(_t[i & _bitmask]);
+        i = probe(i, k);
+        value_intern curr(_t[wrap(i)]);
         if (curr.compare_key(k))
-            return make_iterator(k, curr.get_data(), &_t[i & _bitmask]);
+        {
+            _stats.hit(i-htemp);
+            return make_iterator(k, curr.get_data(), &_t[wrap(i)]);
+        }
         if (curr.is_empty())
+        {
+            _stats.miss(i-htemp);
             return end();
+        }
     }
     return end();
 }
 
-template<class E, class HashFct, class A>
-inline typename BaseCircular<E,HashFct,A>::const_iterator
-BaseCircular<E,HashFct,A>::find(const key_type& k) const
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy>
+inline typename BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::const_iterator
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::find(const key_type& k) const
 {
     size_type htemp = h(k);
     for (size_type i = htemp; ; ++i)
     {
-        value_intern curr(_t[i & _bitmask]);
+        i = probe(i, k);
+        value_intern curr(_t[wrap(i)]);
         if (curr.compare_key(k))
-            return make_citerator(k, curr.get_data(), &_t[i & _bitmask]);
+        {
+            _stats.hit(i-htemp);
+            return make_citerator(k, curr.get_data(), &_t[wrap(i)]);
+        }
         if (curr.is_empty())
+        {
+            _stats.miss(i-htemp);
             return cend();
+        }
     }
     return cend();
 }
 
-template<class E, class HashFct, class A>
-inline typename BaseCircular<E,HashFct,A>::insert_return_type
-BaseCircular<E,HashFct,A>::insert(const key_type& k, const mapped_type& d)
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy>
+inline bool BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::contains(const key_type& k) const
+{
+    size_type htemp = h(k);
+    for (size_type i = htemp; ; ++i)
+    {
+        i = probe(i, k);
+        value_intern curr(_t[wrap(i)]);
+        if (curr.compare_key(k))
+        {
+            _stats.hit(i-htemp);
+            return true;
+        }
+        if (curr.is_empty())
+        {
+            _stats.miss(i-htemp);
+            return false;
+        }
+    }
+    return false;
+}
+
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy>
+inline typename BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::size_type
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::find_batch(const key_type* keys, size_type n,
+                                      mapped_type* out, bool* found) const
+{
+    // every window slot holds one unfinished lookup (input index + position)
+    // each slot probes until it is finished or it crosses a cache line,
+    // then the next line is prefetched and the next slot is processed
+    size_type idx[batch_window];
+    size_type pos[batch_window];
+    size_type active  = 0;
+    size_type next    = 0;
+    size_type n_found = 0;
+
+    for (; active < batch_window && next < n; ++active, ++next)
+    {
+        idx[active] = next;
+        pos[active] = h(keys[next]);
+        prefetch(pos[active]);
+    }
+
+    while (active)
+    {
+        for (size_type s = 0; s < active; )
+        {
+            const key_type& k = keys[idx[s]];
+            bool done = false;
+            while (true)
+            {
+                value_intern curr(_t[wrap(pos[s])]);
+                if (curr.compare_key(k))
+                {
+                    out  [idx[s]] = curr.get_data();
+                    found[idx[s]] = true;
+                    ++n_found;
+                    if (Stats::enabled) _stats.hit(pos[s] - h(k));
+                    done = true;
+                    break;
+                }
+                if (curr.is_empty())
+                {
+                    found[idx[s]] = false;
+                    if (Stats::enabled) _stats.miss(pos[s] - h(k));
+                    done = true;
+                    break;
+                }
+                if (((++pos[s]) & (elements_per_line-1)) == 0)
+                {
+                    prefetch(pos[s]);
+                    break;
+                }
+            }
+
+            if (!done)      { ++s; }
+            else if (next < n)
+            {
+                // refill the slot, its prefetch has time until the next round
+                idx[s] = next;
+                pos[s] = h(keys[next]);
+                prefetch(pos[s]);
+                ++next; ++s;
+            }
+            else
+            {
+                --active;
+                idx[s] = idx[active];
+                pos[s] = pos[active];
+            }
+        }
+    }
+    return n_found;
+}
+
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy> template<bool Update, class F>
+inline void
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::batch_intern(const key_type* keys,
+                                        const mapped_type* data,
+                                        const size_type* order, size_type n,
+                                        ReturnCode* codes, F f)
+{
+    // same pipelining as in find_batch, slot holds the position in order
+    // elements are inserted through claim_intern (once the end of their
+    // cluster was found), existing elements are handled by found
+    auto found = [this, &f](size_type p, value_intern curr,
+                            const mapped_type& dj) -> insert_return_intern
+    {
+        if (!Update)
+            return make_insert_ret(end(), ReturnCode::UNSUCCESS_ALREADY_USED);
+        if (_t[p].atomic_update(curr, f, dj).second)
+            return make_insert_ret(end(), ReturnCode::SUCCESS_UP);
+        return make_insert_ret(end(), ReturnCode::ERROR);
+    };
+
+    size_type slot[batch_window];
+    size_type pos [batch_window];
+    size_type active = 0;
+    size_type next   = 0;
+
+    for (; active < batch_window && next < n; ++active, ++next)
+    {
+        slot[active] = next;
+        pos [active] = h(keys[order[next]]);
+        prefetch(pos[active]);
+    }
+
+    while (active)
+    {
+        for (size_type s = 0; s < active; )
+        {
+            const size_type j  = order[slot[s]];
+            const key_type& k  = keys[j];
+            ReturnCode      code = ReturnCode::ERROR;
+            // rejected keys keep ERROR as their code (they are not retried)
+            const bool      skip = rejected(k);
+            while (!skip)
+            {
+                size_type    temp = wrap(pos[s]);
+                value_intern curr(_t[temp]);
+                if (curr.is_marked())
+                {
+                    code = ReturnCode::UNSUCCESS_INVALID;
+                    break;
+                }
+                else if (curr.compare_key(k))
+                {
+                    code = found(temp, curr, data[j]).second;
+                    if (code != ReturnCode::ERROR) break;
+                    //somebody changed the current element! recheck it
+                }
+                else if (curr.is_empty())
+                {
+                    code = claim_intern(k, data[j],
+                                        [&found, &data, j](size_type p,
+                                                           value_intern c)
+                                        { return found(p, c, data[j]); }
+                                        ).second;
+                    break;
+                }
+                else if (((++pos[s]) & (elements_per_line-1)) == 0)
+                {
+                    prefetch(pos[s]);
+                    break;
+                }
+            }
+
+            if (code == ReturnCode::ERROR && !skip) { ++s; continue; }
+
+            codes[slot[s]] = code;
+            if (next < n)
+            {
+                slot[s] = next;
+                pos [s] = h(keys[order[next]]);
+                prefetch(pos[s]);
+                ++next; ++s;
+            }
+            else
+            {
+                --active;
+                slot[s] = slot[active];
+                pos [s] = pos [active];
+            }
+        }
+    }
+}
+
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy>
+inline void
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::batch_order(const key_type* keys, size_type n,
+                                       size_type* order) const
+{
+    std::vector<std::pair<size_type, size_type> > temp(n);
+    for (size_type i = 0; i < n; ++i) temp[i] = std::make_pair(_hash(keys[i]), i);
+    std::sort(temp.begin(), temp.end());
+    for (size_type i = 0; i < n; ++i) order[i] = temp[i].second;
+}
+
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy>
+inline typename BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::insert_return_type
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::insert(const key_type& k, const mapped_type& d)
 {
     iterator   it = end();
     ReturnCode c  = ReturnCode::ERROR;
@@ -750,25 +1321,25 @@ BaseCircular<E,HashFct,A>::insert(const key_type& k, const mapped_type& d)
     return std::make_pair(it, successful(c));
 }
 
-template<class E, class HashFct, class A>
-inline typename BaseCircular<E,HashFct,A>::size_type
-BaseCircular<E,HashFct,A>::erase(const key_type& k)
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy>
+inline typename BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::size_type
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::erase(const key_type& k)
 {
     ReturnCode c = erase_intern(k);
     return (successful(c)) ? 1 : 0;
 }
 
-template<class E, class HashFct, class A>
-inline typename BaseCircular<E,HashFct,A>::size_type
-BaseCircular<E,HashFct,A>::erase_if(const key_type& k, const mapped_type& d)
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy>
+inline typename BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::size_type
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::erase_if(const key_type& k, const mapped_type& d)
 {
     ReturnCode c = erase_if_intern(k,d);
     return (successful(c)) ? 1 : 0;
 }
 
-template<class E, class HashFct, class A> template <class F, class ... Types>
-inline typename BaseCircular<E,HashFct,A>::insert_return_type
-BaseCircular<E,HashFct,A>::update(const key_type& k, F f, Types&& ... args)
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy> template <class F, class ... Types>
+inline typename BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::insert_return_type
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::update(const key_type& k, F f, Types&& ... args)
 {
     iterator   it = end();
     ReturnCode c  = ReturnCode::ERROR;
@@ -776,9 +1347,9 @@ BaseCircular<E,HashFct,A>::update(const key_type& k, F f, Types&& ... args)
     return std::make_pair(it, successful(c));
 }
 
-template<class E, class HashFct, class A> template <class F, class ... Types>
-inline typename BaseCircular<E,HashFct,A>::insert_return_type
-BaseCircular<E,HashFct,A>::update_unsafe(const key_type& k, F f, Types&& ... args)
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy> template <class F, class ... Types>
+inline typename BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::insert_return_type
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::update_unsafe(const key_type& k, F f, Types&& ... args)
 {
     iterator   it = end();
     ReturnCode c  = ReturnCode::ERROR;
@@ -786,9 +1357,9 @@ BaseCircular<E,HashFct,A>::update_unsafe(const key_type& k, F f, Types&& ... arg
     return std::make_pair(it, successful(c));
 }
 
-template<class E, class HashFct, class A> template <class F, class ... Types>
-inline typename BaseCircular<E,HashFct,A>::insert_return_type
-BaseCircular<E,HashFct,A>::insert_or_update(const key_type& k,
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy> template <class F, class ... Types>
+inline typename BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::insert_return_type
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::insert_or_update(const key_type& k,
                                             const mapped_type& d,
                                             F f, Types&& ... args)
 {
@@ -796,12 +1367,12 @@ BaseCircular<E,HashFct,A>::insert_or_update(const key_type& k,
     ReturnCode c  = ReturnCode::ERROR;
     std::tie(it,c) = insert_or_update_intern(k,d,f,
                                              std::forward<Types>(args)...);
-    return std::make_pair(it, (c == ReturnCode::SUCCESS_IN));
+    return std::make_pair(it, successful_insert(c));
 }
 
-template<class E, class HashFct, class A> template <class F, class ... Types>
-inline typename BaseCircular<E,HashFct,A>::insert_return_type
-BaseCircular<E,HashFct,A>::insert_or_update_unsafe(const key_type& k,
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy> template <class F, class ... Types>
+inline typename BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::insert_return_type
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::insert_or_update_unsafe(const key_type& k,
                                                    const mapped_type& d,
                                                    F f, Types&& ... args)
 {
@@ -809,7 +1380,254 @@ BaseCircular<E,HashFct,A>::insert_or_update_unsafe(const key_type& k,
     ReturnCode c  = ReturnCode::ERROR;
     std::tie(it,c) = insert_or_update_unsafe_intern(k,d,f,
                                                     std::forward<Types>(args)...);
-    return std::make_pair(it, (c == ReturnCode::SUCCESS_IN));
+    return std::make_pair(it, successful_insert(c));
+}
+
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy>
+inline typename BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::size_type
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::insert_batch(const key_type* keys,
+                                        const mapped_type* data, size_type n)
+{
+    return batch<false>(keys, data, n, example::Overwrite());
+}
+
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy> template <class F>
+inline typename BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::size_type
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::insert_or_update_batch(const key_type* keys,
+                                                  const mapped_type* data,
+                                                  size_type n, F f)
+{
+    return batch<true>(keys, data, n, f);
+}
+
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy> template <bool Update, class F>
+inline typename BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::size_type
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::batch(const key_type* keys, const mapped_type* data,
+                                 size_type n, F f)
+{
+    std::vector<size_type>  order(n);
+    std::vector<ReturnCode> codes(n);
+    batch_order(keys, n, order.data());
+    batch_intern<Update>(keys, data, order.data(), n, codes.data(), f);
+    return std::count_if(codes.begin(), codes.end(), successful_insert);
+}
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+// BULK BUILD ******************************************************************
+
+// Each range is filled by one thread, clusters that would leave their range
+// are inserted in the end (in order, i.e., duplicates are still found). Since
+// all ranges are filled before, these elements cannot break other clusters.
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy>
+inline typename BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::size_type
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::build(
+    const std::pair<key_type, mapped_type>* data, size_type n,
+    size_type threads)
+{
+    threads = std::max<size_type>(1, std::min(threads, _capacity));
+    const size_type range = (_capacity + threads - 1) / threads;
+    threads = (_capacity + range - 1) / range;
+
+    auto parallel = [threads](auto f)
+    {
+        std::vector<std::thread> workers;
+        for (size_type t = 1; t < threads; ++t) workers.emplace_back(f, t);
+        f(0);
+        for (auto& w : workers) w.join();
+    };
+    auto chunk = [n, threads](size_type t) { return n / threads * t
+                                                    + std::min(t, n % threads); };
+
+    // offset[r*threads+t] is the first position of chunk t's elements in
+    // range r (stable, the order of equal keys is kept)
+    std::vector<size_type> offset(threads*threads + 1, 0);
+    std::atomic_bool       invalid(false);
+    parallel([&](size_type t)
+             {
+                 std::vector<size_type> count(threads, 0);
+                 for (size_type i = chunk(t); i < chunk(t+1); ++i)
+                 {
+                     if (rejected(data[i].first)) invalid.store(true);
+                     ++count[h(data[i].first) / range];
+                 }
+                 for (size_type r = 0; r < threads; ++r)
+                     offset[r*threads+t+1] = count[r];
+             });
+    if (invalid.load())
+        throw std::invalid_argument("build: key collides with a sentinel!");
+    for (size_type i = 1; i <= threads*threads; ++i) offset[i] += offset[i-1];
+
+    std::unique_ptr<value_intern[]> sorted(new value_intern[n]);
+    parallel([&](size_type t)
+             {
+                 std::vector<size_type> pos(threads);
+                 for (size_type r = 0; r < threads; ++r)
+                     pos[r] = offset[r*threads+t];
+                 for (size_type i = chunk(t); i < chunk(t+1); ++i)
+                 {
+                     auto& e = data[i];
+                     sorted[pos[h(e.first) / range]++] =
+                         value_intern(e.first, e.second);
+                 }
+             });
+
+    std::vector<std::vector<value_intern> > overflow(threads);
+    std::vector<size_type>                  inserted(threads, 0);
+    parallel([&](size_type r)
+             {
+                 size_type rend = std::min(_capacity, (r+1)*range);
+                 for (size_type j = offset[r*threads];
+                      j < offset[(r+1)*threads]; ++j)
+                 {
+                     const value_intern& e = sorted[j];
+                     size_type htemp = h(e.get_key());
+                     size_type i     = htemp;
+                     for (; i < rend; ++i)
+                     {
+                         value_intern curr(_t[i]);
+                         if (curr.is_empty())
+                         {
+                             _t[i] = e;
+                             _stats.insert(i-htemp);
+                             _occupancy.set(i);
+                             ++inserted[r];
+                             break;
+                         }
+                         if (curr.compare_key(e.get_key())) break;
+                     }
+                     if (i == rend) overflow[r].push_back(e);
+                 }
+             });
+
+    size_type result = 0;
+    for (size_type r = 0; r < threads; ++r)
+    {
+        result += inserted[r];
+        for (auto& e : overflow[r])
+        {
+            size_type htemp = h(e.get_key());
+            size_type i     = htemp;
+            for (; i < htemp + _capacity; ++i)
+            {
+                size_type temp = wrap(i);
+                value_intern curr(_t[temp]);
+                if (curr.is_empty())
+                {
+                    _t[temp] = e;
+                    _stats.insert(i-htemp);
+                    _occupancy.set(temp);
+                    ++result;
+                    break;
+                }
+                if (curr.compare_key(e.get_key())) break;
+            }
+            if (i == htemp + _capacity) throw std::bad_alloc();
+        }
+    }
+    return result;
+}
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+// PARALLEL SCAN ***************************************************************
+
+// Elements of a cluster are stored between their home cell and the next
+// empty cell, therefore, only the elements in front of the first empty cell
+// and those behind e have to be checked (if the capacity matches).
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy> template <class F>
+inline void
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::for_each_home(size_type cap,
+                                                      size_type s, size_type e,
+                                                      F f) const
+{
+    const bool      same   = cap == _capacity;
+    const size_type rshift = compute_right_shift(cap);
+    size_type a = s;
+    size_type b = e;
+    if (! same)
+    {
+        using wide = unsigned __int128;
+        a = size_type(wide(s) * _capacity / cap);
+        b = size_type((wide(e) * _capacity + cap - 1) / cap);
+        b = std::min(std::max(b, a+1), _capacity);
+    }
+
+    bool check = true;
+    for (size_type i = a; i < b + _capacity; ++i)
+    {
+        if (Occupancy::enabled && i < b
+            && i % OccupancySummary::group_size == 0)
+        {
+            // skipped groups are empty (cell i-1 ends all clusters)
+            size_type j = _occupancy.next(i, b);
+            if (j > i) { check = ! same; i = j; }
+            if (i >= b) return;
+        }
+
+        value_intern curr(_t[wrap(i)]);
+        if (curr.is_empty())
+        {
+            if (i >= b) return;
+            check = ! same;
+            continue;
+        }
+        if (i >= b) check = true;
+        if (curr.is_deleted()) continue;
+
+        const key_type k = curr.get_key();
+        if (check)
+        {
+            size_type home = Growth::reduce(_hash(k), cap, rshift);
+            if (home < s || home >= e) continue;
+        }
+        f(k, curr.get_data());
+    }
+}
+
+// a cursor inside of a cell (e.g. from a larger table before shrinking)
+// starts at the beginning of that cell, its elements can be visited twice
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy> template <class F>
+inline typename BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::size_type
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::scan(size_type cursor, size_type max,
+                                             F f) const
+{
+    size_type n = 0;
+    size_type e = Growth::reduce(cursor, _capacity, _right_shift);
+    while (n < max && e < _capacity)
+    {
+        size_type s = e;
+        e = s + std::max<size_type>(std::min(_capacity - s, max - n), 1);
+        for_each_home(_capacity, s, e,
+                      [&n, &f](const key_type& k, const mapped_type& d)
+                      { ++n; f(k, d); });
+    }
+    return (e < _capacity) ? Growth::first_hash(e, _capacity, _right_shift)
+                           : 0;
 }
 
 
@@ -828,18 +1646,29 @@ BaseCircular<E,HashFct,A>::insert_or_update_unsafe(const key_type& k,
 
 // MIGRATION/GROWING STUFF *****************************************************
 
-template<class E, class HashFct, class A>
-inline typename BaseCircular<E,HashFct,A>::size_type
-BaseCircular<E,HashFct,A>::migrate(This_t& target, size_type s, size_type e)
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy> template <class Target>
+inline typename BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::size_type
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::migrate(Target& target, size_type s, size_type e,
+                                                bool initialized)
 {
     size_type n = 0;
     auto i = s;
     auto curr = value_intern::get_empty();
 
+    // running compactions have to finish, new ones see _current_copy_block
+    for (size_t r = 0; _n_compacting.load(); ) backoff(r);
+
     //HOW MUCH BIGGER IS THE TARGET TABLE
     auto shift = 0u;
     while (target._capacity > (_capacity << shift)) ++shift;
 
+    // blocks are only mapped onto blocks of the target, if its capacity is
+    // a power of two multiple of ours, otherwise (e.g. smaller targets),
+    // clusters can reach into the positions of other blocks, such targets
+    // are initialized beforehand and filled with cas
+    const bool aligned = ! initialized
+                         && target._capacity == (_capacity << shift);
+
 
     //FINDS THE FIRST EMPTY BUCKET (START OF IMPLICIT BLOCK)
     while (i<e)
@@ -853,10 +1682,22 @@ BaseCircular<E,HashFct,A>::migrate(This_t& target, size_type s, size_type e)
         ++i;
     }
 
-    std::fill(target._t+(i<<shift), target._t+(e<<shift), value_intern::get_empty());
+    // no empty cell, the whole block belongs to a cluster that started in
+    // front of it, it is migrated by the block, where that cluster starts
+    // (otherwise, its elements would be copied twice)
+    if (i >= e) return n;
+
+    if (aligned)
+        std::fill(target._t+(i<<shift), target._t+(e<<shift), value_intern::get_empty());
+
+    // without markable elements, the table cannot change during the
+    // migration (synchronized growing), thus, empty groups can be skipped
+    // (otherwise, empty cells have to be marked to stop insertions, then
+    // marking never fails, see --i below)
+    constexpr bool skip = Occupancy::enabled && ! value_intern::markable;
 
     //MIGRATE UNTIL THE END OF THE BLOCK
-    for (; i<e; ++i)
+    for (; i<e; i = skip ? next_cell(i, e) : i+1)
     {
         curr = _t[i];
         if (! _t[i].atomic_mark(curr))
@@ -868,7 +1709,8 @@ BaseCircular<E,HashFct,A>::migrate(This_t& target, size_type s, size_type e)
         {
             if (!curr.is_deleted())
             {
-                target.insert_unsafe(curr);
+                if (aligned) target.insert_unsafe(curr);
+                else         target.insert_cas(curr);
                 ++n;
             }
         }
@@ -880,36 +1722,152 @@ BaseCircular<E,HashFct,A>::migrate(This_t& target, size_type s, size_type e)
     //THE TARGET POSITIONS WILL NOT BE INITIALIZED
     for (; b; ++i)
     {
-        auto pos  = i&_bitmask;
+        auto pos  = wrap(i);
         auto t_pos= pos<<shift;
-        for (size_type j = 0; j < 1ull<<shift; ++j) target._t[t_pos+j] = value_intern::get_empty();
+        if (aligned)
+            for (size_type j = 0; j < 1ull<<shift; ++j) target._t[t_pos+j] = value_intern::get_empty();
         //target.t[t_pos] = E::get_empty();
 
         curr = _t[pos];
 
-        if (! _t[pos].atomic_mark(curr)) --i;
+        // a failed mark leaves curr outdated (e.g. a deleted element), the
+        // cell is read again, this matters for deletions that trigger
+        // migrations (shrinking)
+        if (! _t[pos].atomic_mark(curr)) { --i; continue; }
         if ( (b = ! curr.is_empty()) ) // this might be nicer as an else if, but this is faster
         {
-            if (!curr.is_deleted()) { target.insert_unsafe(curr); n++; }
+            if (!curr.is_deleted())
+            {
+                if (aligned) target.insert_unsafe(curr);
+                else         target.insert_cas(curr);
+                n++;
+            }
+        }
+    }
+
+    return n;
+}
+
+// marked cells cannot change anymore, a migration marks the cells of a
+// cluster in order (beginning at the empty cell in front of it), and copies
+// each element before it marks the next cell
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy>
+inline bool
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::marked_cluster(const key_type& k,
+                                                       size_type& start) const
+{
+    size_type htemp = h(k);
+    for (size_type i = htemp; i < htemp + _capacity; ++i)
+    {
+        value_intern curr(_t[wrap(i)]);
+        if (! curr.is_marked()) return false;
+        if (curr.compare_key(k) || curr.is_empty()) break;
+    }
+
+    start = _capacity;
+    if (value_intern(_t[wrap(htemp)]).is_empty()) return true;
+
+    for (size_type i = htemp + _capacity - 1; i > htemp; --i)
+    {
+        value_intern curr(_t[wrap(i)]);
+        if (! curr.is_marked()) return false;
+        if (curr.is_empty())
+        {
+            start = wrap(i);
+            return true;
         }
     }
+    return false;
+}
+
+// A deleted cell in front of an empty cell is cleared, while the empty cell
+// is locked. Thus, no element can be inserted behind the cleared cell
+// (elements are never stored behind an empty cell of their cluster).
+// Insertions wait for locked cells (see claim_intern).
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy>
+inline typename BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::size_type
+BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::compact(size_type s, size_type e)
+{
+    // a migration marks the table beginning at empty cells, created empty
+    // cells could split its blocks (see migrate)
+    _n_compacting.fetch_add(1);
+    if (_current_copy_block.load())
+    {
+        _n_compacting.fetch_sub(1);
+        return 0;
+    }
+
+    size_type n = 0;
+    for (size_type i = s; i < e; ++i)
+    {
+        value_intern curr = _t[wrap(i)];
+        if (! curr.is_empty() || curr.is_marked()) continue;
 
+        // remove the deleted cells in front of i, one by one
+        for (size_type j = i + _capacity; j != i; --j)
+        {
+            value_intern prev = _t[wrap(j-1)];
+            if (! prev.is_reusable()) break;
+
+            value_intern last = _t[wrap(j)];
+            if (! last.is_empty() || last.is_marked()
+                || ! _t[wrap(j)].cas(last, value_intern::get_locked()))
+                break;
+            bool cleared = _t[wrap(j-1)].cas(prev,
+                                                    value_intern::get_empty());
+            value_intern lock = value_intern::get_locked();
+            _t[wrap(j)].cas(lock, value_intern::get_empty());
+
+            if (! cleared) break;
+            ++n;
+        }
+    }
+
+    _n_compacting.fetch_sub(1);
     return n;
 }
 
-template<class E, class HashFct, class A>
-inline void BaseCircular<E,HashFct,A>::insert_unsafe(const value_intern& e)
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy>
+inline void BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::initialize(size_type s, size_type e)
+{
+    std::fill(_t+s, _t+e, value_intern::get_empty());
+}
+
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy>
+inline void BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::insert_unsafe(const value_intern& e)
 {
     const key_type k = e.get_key();
 
     size_type htemp = h(k);
     for (size_type i = htemp; ; ++i)  // i < htemp + MaDis
     {
-        size_type temp = i & _bitmask;
+        size_type temp = wrap(i);
         value_intern curr(_t[temp]);
         if (curr.is_empty())
         {
             _t[temp] = e;
+            _occupancy.set(temp);
+            return;
+        }
+    }
+    throw std::bad_alloc();
+}
+
+// used by concurrent migrations into unaligned tables (see migrate), the
+// table contains no deleted cells and no duplicates
+template<class E, class HashFct, class A, class Stats, class Growth, class Occupancy>
+inline void BaseCircular<E,HashFct,A,Stats,Growth,Occupancy>::insert_cas(const value_intern& e)
+{
+    const key_type k = e.get_key();
+
+    size_type htemp = h(k);
+    for (size_type i = htemp; ; ++i)
+    {
+        size_type temp = wrap(i);
+        value_intern curr(_t[temp]);
+        if (curr.is_empty() && _t[temp].cas(curr, e))
+        {
+            _occupancy.set(temp);
             return;
         }
     }
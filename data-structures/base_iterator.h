@@ -11,6 +11,9 @@
 #pragma once
 
 #include <tuple>
+#include <type_traits>
+
+#include "data-structures/occupancy_summary.h"
 
 namespace growt
 {
@@ -39,7 +42,7 @@ private:
     using pair_type      = std::pair<key_type, mapped_type>;
     using value_nc       = std::pair<const key_type, mapped_type>;
     using value_intern   = typename BTable_t::value_intern;
-    using pointer_intern = value_intern*;
+    using pointer_intern = typename BTable_t::pointer_intern;
 
     template <class, bool>
     friend class MappedRefGrowT;
@@ -92,7 +95,7 @@ private:
     using pair_type      = std::pair<key_type, mapped_type>;
     using value_nc       = std::pair<const key_type, mapped_type>;
     using value_intern   = typename BTable_t::value_intern;
-    using pointer_intern = value_intern*;
+    using pointer_intern = typename BTable_t::pointer_intern;
 
     using mapped_ref     = MappedRefBase<BaseTable, is_const>;
 
@@ -138,7 +141,7 @@ private:
     using pair_type      = std::pair<key_type, mapped_type>;
     using value_nc       = std::pair<const key_type, mapped_type>;
     using value_intern   = typename BTable_t::value_intern;
-    using pointer_intern = value_intern*;
+    using pointer_intern = typename BTable_t::pointer_intern;
 
     template <class, bool>
     friend class IteratorGrowT;
@@ -159,13 +162,23 @@ public:
     friend bool operator!=(const IteratorBase<T,b>& l, const IteratorBase<T,b>& r);
 
     // Constructors ************************************************************
-    IteratorBase(const pair_type& copy, value_intern* ptr, value_intern* eptr)
-        : _copy(copy), _ptr(ptr), _eptr(eptr) { }
+    // tables with an occupancy summary pass it with their first cell, then
+    // empty groups are skipped (see occupancy_summary.h)
+    IteratorBase(const pair_type& copy, pointer_intern ptr, pointer_intern eptr,
+                 const OccupancySummary* summary = nullptr,
+                 pointer_intern first = nullptr)
+        : _copy(copy), _ptr(ptr), _eptr(eptr), _summary(summary),
+          _first(first) { }
 
     IteratorBase(const IteratorBase& rhs)
-        : _copy(rhs._copy), _ptr(rhs._ptr), _eptr(rhs._eptr) { }
+        : _copy(rhs._copy), _ptr(rhs._ptr), _eptr(rhs._eptr),
+          _summary(rhs._summary), _first(rhs._first) { }
     IteratorBase& operator=(const IteratorBase& r)
-    { _copy = r._copy; _ptr = r._ptr; _eptr = r._eptr; return *this; }
+    {
+        _copy = r._copy; _ptr = r._ptr; _eptr = r._eptr;
+        _summary = r._summary; _first = r._first;
+        return *this;
+    }
 
     ~IteratorBase() = default;
 
@@ -173,14 +186,24 @@ public:
     inline IteratorBase& operator++()
     {
         ++_ptr;
-        while ( _ptr < _eptr && (_ptr->is_empty() || _ptr->is_deleted())) { ++_ptr; }
-        _copy.first  = _ptr->get_key();
-        _copy.second = _ptr->get_data();
+        skip_groups(std::is_pointer<pointer_intern>());
+        while ( _ptr < _eptr && (_ptr->is_empty() || _ptr->is_deleted()))
+        {
+            ++_ptr;
+            skip_groups(std::is_pointer<pointer_intern>());
+        }
+        // _eptr is behind the table, it cannot be read (e.g. StringElement
+        // dereferences its cell)
         if (_ptr == _eptr)
         {
             _ptr  = nullptr;
             _copy = std::make_pair(key_type(), mapped_type());
+            return *this;
         }
+        // key and data are taken from one copy of the cell (see WideElement)
+        value_intern curr(*_ptr);
+        _copy.first  = curr.get_key();
+        _copy.second = curr.get_data();
         return *this;
     }
 
@@ -216,6 +239,18 @@ private:
     pair_type      _copy;
     pointer_intern _ptr;
     pointer_intern _eptr;
+    const OccupancySummary* _summary;
+    pointer_intern          _first;
+
+    // at the beginning of each group (only for cells stored in an array)
+    inline void skip_groups(std::false_type) { }
+    inline void skip_groups(std::true_type)
+    {
+        if (! _summary || _ptr >= _eptr) return;
+        size_t i = _ptr - _first;
+        if (i % OccupancySummary::group_size) return;
+        _ptr = _first + _summary->next(i, _eptr - _first);
+    }
 };
 
 
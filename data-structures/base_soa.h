@@ -0,0 +1,1120 @@
+/*******************************************************************************
+ * data-structures/base_soa.h
+ *
+ * Non growing table variant with split key/value storage (see soaelement.h).
+ * Keys are probed in dense key lines (8 keys per cache line), data is only
+ * read/written once the key is found. It can be used by our synchronized
+ * growing tables (EStratSync) in place of BaseCircular.
+ *
+ * Part of Project growt - https://github.com/TooBiased/growt.git
+ *
+ * Copyright (C) 2015-2016 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <stdlib.h>
+#include <functional>
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+#include <algorithm>
+
+#include "utils/default_hash.hpp"
+#include "data-structures/returnelement.h"
+#include "data-structures/base_iterator.h"
+#include "data-structures/probe_kernel.h"
+#include "data-structures/probe_stats.h"
+#include "data-structures/soaelement.h"
+#include "data-structures/migration_scheduler.h"
+#include "example/update_fcts.h"
+
+namespace growt {
+
+template<class HashFct = utils_tm::hash_tm::default_hash,
+         class A = std::allocator<SoABlock>>
+class BaseSoA
+{
+private:
+    using This_t          = BaseSoA<HashFct,A>;
+    using Allocator_t     = typename A::template rebind<SoABlock>::other;
+
+    template <class> friend class GrowTableHandle;
+
+public:
+    using value_intern       = SoAElement;
+    using pointer_intern     = SoACell;
+
+    using key_type           = typename value_intern::key_type;
+    using mapped_type        = typename value_intern::mapped_type;
+    using value_type         = SoAElement;
+    using iterator           = IteratorBase<This_t, false>;
+    using const_iterator     = IteratorBase<This_t, true>;
+    using size_type          = size_t;
+    using difference_type    = std::ptrdiff_t;
+    using reference          = ReferenceBase<This_t, false>;
+    using const_reference    = ReferenceBase<This_t, true>;
+    using mapped_reference       = MappedRefBase<This_t, false>;
+    using const_mapped_reference = MappedRefBase<This_t, true>;
+    using insert_return_type = std::pair<iterator, bool>;
+
+
+    using local_iterator       = void;
+    using const_local_iterator = void;
+    using node_type            = void;
+
+    using Handle             = This_t&;
+private:
+    using insert_return_intern = std::pair<iterator, ReturnCode>;
+
+public:
+    BaseSoA(size_type size_ = 1<<18);
+    BaseSoA(size_type size_, size_type version_);
+
+    BaseSoA(const BaseSoA&) = delete;
+    BaseSoA& operator=(const BaseSoA&) = delete;
+
+    // Obviously move-constructor and move-assignment are not thread safe
+    // They are merely comfort functions used during setup
+    BaseSoA(BaseSoA&& rhs);
+    BaseSoA& operator=(BaseSoA&& rhs);
+
+    ~BaseSoA();
+
+    Handle get_handle() { return *this; }
+
+    iterator       begin();
+    iterator       end();
+    const_iterator cbegin() const;
+    const_iterator cend()   const;
+    const_iterator begin()  const { return cbegin(); }
+    const_iterator end()    const { return cend();   }
+
+    insert_return_type insert(const key_type& k, const mapped_type& d);
+    size_type          erase (const key_type& k);
+    iterator           find  (const key_type& k);
+    const_iterator     find  (const key_type& k) const;
+
+    // looks for n keys at once (see BaseCircular::find_batch)
+    size_type          find_batch(const key_type* keys, size_type n,
+                                  mapped_type* out, bool* found) const;
+
+    insert_return_type insert_or_assign(const key_type& k, const mapped_type& d)
+    { return insert_or_update(k, d, example::Overwrite(), d); }
+
+    mapped_reference operator[](const key_type& k)
+    { return (*(insert(k, mapped_type()).first)).second; }
+
+    template <class F, class ... Types>
+    insert_return_type update
+    (const key_type& k, F f, Types&& ... args);
+
+    template <class F, class ... Types>
+    insert_return_type update_unsafe
+    (const key_type& k, F f, Types&& ... args);
+
+
+    template <class F, class ... Types>
+    insert_return_type insert_or_update
+    (const key_type& k, const mapped_type& d, F f, Types&& ... args);
+
+    template <class F, class ... Types>
+    insert_return_type insert_or_update_unsafe
+    (const key_type& k, const mapped_type& d, F f, Types&& ... args);
+
+    size_type          erase_if(const key_type& k, const mapped_type& d);
+
+    // batched variants of insert and insert_or_update (returns #inserted)
+    size_type          insert_batch(const key_type* keys,
+                                    const mapped_type* data, size_type n);
+    template <class F>
+    size_type          insert_or_update_batch(const key_type* keys,
+                                              const mapped_type* data,
+                                              size_type n, F f);
+
+    size_type migrate(This_t& target, size_type s, size_type e);
+
+    size_type          _capacity;
+    size_type          _version;
+    std::atomic_size_t _current_copy_block;
+    // distributes the blocks of aligned migrations (see blockwise_migrate)
+    MigrationScheduler _migration;
+
+    // growing tables are migrated once this fill rate is exceeded (see
+    // BaseCircular::grow_fill_factor)
+    static constexpr double max_fill_factor  = 0.666;
+    static constexpr double grow_fill_factor = 0.6/2.;
+
+    // deleted cells are only removed by migrations (see BaseCircular::compact)
+    static constexpr bool compactable = false;
+
+    // elements are inserted in parallel (see BaseCircular::bulk_build)
+    static constexpr bool bulk_build = false;
+
+    // the table is never shrunk (see BaseCircular::unaligned_migration)
+    static constexpr bool unaligned_migration = false;
+
+    static size_type resize(size_type current, size_type inserted,
+                            size_type deleted,
+                            double grow_fill = grow_fill_factor, double = 0.)
+    {
+        auto nsize = current;
+        double fill_rate = double(inserted - deleted)/double(current);
+
+        if (fill_rate > grow_fill) nsize <<= 1;
+
+        return nsize;
+    }
+
+protected:
+    Allocator_t _allocator;
+    static_assert(std::is_same<typename Allocator_t::value_type, SoABlock>::value,
+                  "Wrong allocator type given to BaseSoA!");
+
+    size_type   _bitmask;
+    size_type   _right_shift;
+    HashFct     _hash;
+
+    // _capacity/8 blocks + one empty sentinel block (read by iterators at
+    // the end of the table)
+    SoABlock*   _t;
+    size_type h(const key_type & k) const { return _hash(k) >> _right_shift; }
+
+    inline SoACell  cell(size_type i) const
+    { return SoACell(&_t[i / SoABlock::size], i & (SoABlock::size-1)); }
+    inline key_type key_word(size_type i) const
+    {
+        return __atomic_load_n(&_t[i / SoABlock::size].key[i & (SoABlock::size-1)],
+                               __ATOMIC_RELAXED);
+    }
+
+private:
+    insert_return_intern insert_intern(const key_type& k, const mapped_type& d);
+    ReturnCode           erase_intern (const key_type& k);
+    ReturnCode           erase_if_intern (const key_type& k, const mapped_type& d);
+
+
+    template <class F, class ... Types>
+    insert_return_intern update_intern
+    (const key_type& k, F f, Types&& ... args);
+
+    template <class F, class ... Types>
+    insert_return_intern update_unsafe_intern
+    (const key_type& k, F f, Types&& ... args);
+
+
+    template <class F, class ... Types>
+    insert_return_intern insert_or_update_intern
+    (const key_type& k, const mapped_type& d, F f, Types&& ... args);
+
+    template <class F, class ... Types>
+    insert_return_intern insert_or_update_unsafe_intern
+    (const key_type& k, const mapped_type& d, F f, Types&& ... args);
+
+    // see BaseCircular::batch_intern/batch_order
+    template <bool Update, class F>
+    void batch_intern(const key_type* keys, const mapped_type* data,
+                      const size_type* order, size_type n,
+                      ReturnCode* codes, F f);
+
+    void batch_order (const key_type* keys, size_type n,
+                      size_type* order) const;
+
+    template <bool Update, class F>
+    size_type batch(const key_type* keys, const mapped_type* data,
+                    size_type n, F f);
+
+
+
+
+    // HELPER FUNCTION FOR ITERATOR CREATION ***********************************
+
+    inline iterator           make_iterator (const key_type& k, const mapped_type& d,
+                                            SoACell ptr)
+    { return iterator(std::make_pair(k,d), ptr, cell(_capacity)); }
+    inline const_iterator     make_citerator (const key_type& k, const mapped_type& d,
+                                            SoACell ptr) const
+    { return const_iterator(std::make_pair(k,d), ptr, cell(_capacity)); }
+    inline insert_return_intern make_insert_ret(const key_type& k, const mapped_type& d,
+                                            SoACell ptr, ReturnCode code)
+    { return std::make_pair(make_iterator(k,d, ptr), code); }
+    inline insert_return_intern make_insert_ret(iterator it, ReturnCode code)
+    { return std::make_pair(it, code); }
+
+
+
+
+    // OTHER HELPER FUNCTIONS **************************************************
+
+    void insert_unsafe(const key_type& k, const mapped_type& d);
+
+    static constexpr size_type batch_window = 16;
+
+    inline void prefetch(size_type pos) const
+    { __builtin_prefetch(&_t[(pos & _bitmask) / SoABlock::size]); }
+
+    // skips all cells that hold neither k nor empty (a whole key line at a
+    // time), returns the (unmasked) position of the next interesting cell
+    inline size_type probe(size_type i, const key_type& k) const
+    {
+        constexpr size_type line_size = KeyLineKernel::line_size;
+        while (true)
+        {
+            size_type lane = i & (line_size-1);
+            size_type r    = KeyLineKernel::first(
+                                 _t[(i & _bitmask) / line_size].key,
+                                 lane, k, SoAElement::BITMASK);
+            if (r < line_size) return i - lane + r;
+            i += line_size - lane;
+        }
+    }
+
+    // capacity is at least twice as large, as the inserted capacity
+    static size_type compute_capacity(size_type desired_capacity)
+    {
+        auto temp = 16384u;
+        while (temp < desired_capacity) temp <<= 1;
+        return temp << 1;
+    }
+
+    static size_type compute_right_shift(size_type capacity)
+    {
+        size_type log_size = 0;
+        while (capacity >>= 1) log_size++;
+        return 64 - log_size;                    // HashFct::significant_digits
+    }
+
+    static size_type n_blocks(size_type capacity)
+    { return capacity / SoABlock::size + 1; }
+
+public:
+    using range_iterator = iterator;
+    using const_range_iterator = const_iterator;
+
+    /* size has to divide capacity */
+    range_iterator       range (size_t rstart, size_t rend);
+    const_range_iterator crange(size_t rstart, size_t rend);
+    range_iterator       range_end ()       { return  end(); }
+    const_range_iterator range_cend() const { return cend(); }
+    size_t               capacity()   const { return _capacity; }
+
+    // no probe statistics are recorded (see BaseCircular::probe_stats)
+    ProbeStatistics      probe_stats() const { return ProbeStatistics(); }
+    void                 share_stats(const BaseSoA&) { }
+
+    // calls f(key, data) for all elements, whose home cell in a table of
+    // capacity cap is in [s,e) (see BaseCircular::for_each_home)
+    template <class F>
+    void for_each_home(size_type cap, size_type s, size_type e, F f) const;
+
+    // resumable scan in hash order (see BaseCircular::scan)
+    template <class F>
+    size_type scan(size_type cursor, size_type max, F f) const;
+
+};
+
+
+
+
+
+
+
+
+
+// CONSTRUCTORS/ASSIGNMENTS ****************************************************
+
+template<class HashFct, class A>
+BaseSoA<HashFct,A>::BaseSoA(size_type capacity_)
+    : _capacity(compute_capacity(capacity_)),
+      _version(0),
+      _current_copy_block(0),
+      _migration(_capacity),
+      _bitmask(_capacity-1),
+      _right_shift(compute_right_shift(_capacity))
+{
+    _t = _allocator.allocate(n_blocks(_capacity));
+    if ( !_t ) throw std::bad_alloc();
+
+    std::fill(reinterpret_cast<char*>(_t),
+              reinterpret_cast<char*>(_t + n_blocks(_capacity)), 0);
+}
+
+/*should always be called with a capacity_=2^k  */
+template<class HashFct, class A>
+BaseSoA<HashFct,A>::BaseSoA(size_type capacity_, size_type version_)
+    : _capacity(capacity_),
+      _version(version_),
+      _current_copy_block(0),
+      _migration(_capacity),
+      _bitmask(_capacity-1),
+      _right_shift(compute_right_shift(_capacity))
+{
+    _t = _allocator.allocate(n_blocks(_capacity));
+    if ( !_t ) throw std::bad_alloc();
+
+    // cells are initialized during the migration, only the sentinel is not
+    std::fill(_t[_capacity/SoABlock::size].key,
+              _t[_capacity/SoABlock::size].key + SoABlock::size, 0);
+}
+
+template<class HashFct, class A>
+BaseSoA<HashFct,A>::~BaseSoA()
+{
+    if (_t) _allocator.deallocate(_t, n_blocks(_capacity));
+}
+
+
+template<class HashFct, class A>
+BaseSoA<HashFct,A>::BaseSoA(BaseSoA&& rhs)
+    : _capacity(rhs._capacity), _version(rhs._version),
+      _current_copy_block(rhs._current_copy_block.load()),
+      _migration(_capacity),
+      _bitmask(rhs._bitmask), _right_shift(rhs._right_shift), _t(nullptr)
+{
+    if (_current_copy_block.load())
+        std::invalid_argument("Cannot move a growing table!");
+    rhs._capacity = 0;
+    rhs._bitmask = 0;
+    rhs._right_shift = HashFct::significant_digits;
+    std::swap(_t, rhs._t);
+}
+
+template<class HashFct, class A>
+BaseSoA<HashFct,A>&
+BaseSoA<HashFct,A>::operator=(BaseSoA&& rhs)
+{
+    if (rhs._current_copy_block.load())
+        std::invalid_argument("Cannot move a growing table!");
+    std::swap(_capacity, rhs._capacity);
+    _version    = rhs._version;
+    _current_copy_block.store(0);
+    _migration.reset(_capacity);
+    rhs._migration.reset(rhs._capacity);
+    std::swap(_bitmask, rhs._bitmask);
+    std::swap(_right_shift, rhs._right_shift);
+    std::swap(_t, rhs._t);
+
+    return *this;
+}
+
+
+
+
+
+
+
+
+// ITERATOR FUNCTIONALITY ******************************************************
+
+template<class HashFct, class A>
+inline typename BaseSoA<HashFct,A>::iterator
+BaseSoA<HashFct,A>::begin()
+{
+    for (size_t i = 0; i<_capacity; ++i)
+    {
+        auto temp = cell(i).load();
+        if (!temp.is_empty() && !temp.is_deleted())
+            return make_iterator(temp.get_key(), temp.get_data(), cell(i));
+    }
+    return end();
+}
+
+template<class HashFct, class A>
+inline typename BaseSoA<HashFct,A>::iterator
+BaseSoA<HashFct,A>::end()
+{ return iterator(std::make_pair(key_type(), mapped_type()),nullptr,nullptr); }
+
+
+template<class HashFct, class A>
+inline typename BaseSoA<HashFct,A>::const_iterator
+BaseSoA<HashFct,A>::cbegin() const
+{
+    for (size_t i = 0; i<_capacity; ++i)
+    {
+        auto temp = cell(i).load();
+        if (!temp.is_empty() && !temp.is_deleted())
+            return make_citerator(temp.get_key(), temp.get_data(), cell(i));
+    }
+    return end();
+}
+
+template<class HashFct, class A>
+inline typename BaseSoA<HashFct,A>::const_iterator
+BaseSoA<HashFct,A>::cend() const
+{
+    return const_iterator(std::make_pair(key_type(),mapped_type()),
+                          nullptr,nullptr);
+}
+
+
+// RANGE ITERATOR FUNCTIONALITY ************************************************
+
+template<class HashFct, class A>
+inline typename BaseSoA<HashFct,A>::range_iterator
+BaseSoA<HashFct,A>::range(size_t rstart, size_t rend)
+{
+    auto temp_rend = std::min(rend, _capacity);
+    for (size_t i = rstart; i < temp_rend; ++i)
+    {
+        auto temp = cell(i).load();
+        if (!temp.is_empty() && !temp.is_deleted())
+            return range_iterator(std::make_pair(temp.get_key(),
+                                                 temp.get_data()),
+                                  cell(i), cell(temp_rend));
+    }
+    return range_end();
+}
+
+template<class HashFct, class A>
+inline typename BaseSoA<HashFct,A>::const_range_iterator
+BaseSoA<HashFct,A>::crange(size_t rstart, size_t rend)
+{
+    auto temp_rend = std::min(rend, _capacity);
+    for (size_t i = rstart; i < temp_rend; ++i)
+    {
+        auto temp = cell(i).load();
+        if (!temp.is_empty() && !temp.is_deleted())
+            return const_range_iterator(std::make_pair(temp.get_key(),
+                                                       temp.get_data()),
+                                        cell(i), cell(temp_rend));
+    }
+    return range_cend();
+}
+
+
+
+// PARALLEL SCAN ***************************************************************
+
+template<class HashFct, class A> template <class F>
+inline void BaseSoA<HashFct,A>::for_each_home(size_type cap,
+                                              size_type s, size_type e,
+                                              F f) const
+{
+    const bool      same   = cap == _capacity;
+    const size_type rshift = compute_right_shift(cap);
+    size_type a = s;
+    size_type b = e;
+    if (! same)
+    {
+        // both capacities are powers of two
+        a = (cap > _capacity) ? s / (cap / _capacity) : s * (_capacity / cap);
+        b = (cap > _capacity) ? (e - 1) / (cap / _capacity) + 1
+                              : e * (_capacity / cap);
+    }
+
+    bool check = true;
+    for (size_type i = a; i < b + _capacity; ++i)
+    {
+        auto curr = cell(i & _bitmask).load();
+        if (curr.is_empty())
+        {
+            if (i >= b) return;
+            check = ! same;
+            continue;
+        }
+        if (i >= b) check = true;
+        if (curr.is_deleted()) continue;
+
+        const key_type k = curr.get_key();
+        if (check)
+        {
+            size_type home = _hash(k) >> rshift;
+            if (home < s || home >= e) continue;
+        }
+        f(k, curr.get_data());
+    }
+}
+
+template<class HashFct, class A> template <class F>
+inline typename BaseSoA<HashFct,A>::size_type
+BaseSoA<HashFct,A>::scan(size_type cursor, size_type max, F f) const
+{
+    size_type n = 0;
+    size_type e = cursor >> _right_shift;
+    while (n < max && e < _capacity)
+    {
+        size_type s = e;
+        e = s + std::max<size_type>(std::min(_capacity - s, max - n), 1);
+        for_each_home(_capacity, s, e,
+                      [&n, &f](const key_type& k, const mapped_type& d)
+                      { ++n; f(k, d); });
+    }
+    return (e < _capacity) ? e << _right_shift : 0;
+}
+
+
+// MAIN HASH TABLE FUNCTIONALITY (INTERN) **************************************
+// the probe skips all cells that are neither empty nor hold k, thus each
+// loop only has to distinguish between these two cases (cells might have
+// changed since the probe, then we continue with the next cell)
+
+template<class HashFct, class A>
+inline typename BaseSoA<HashFct,A>::insert_return_intern
+BaseSoA<HashFct,A>::insert_intern(const key_type& k, const mapped_type& d)
+{
+    for (size_type i = h(k); ; ++i)
+    {
+        i = probe(i, k);
+        SoACell    ptr  = cell(i & _bitmask);
+        value_intern curr = ptr.load();
+
+        if (curr.compare_key(k))
+            return make_insert_ret(k, curr.get_data(), ptr,
+                                   ReturnCode::UNSUCCESS_ALREADY_USED);
+        else if (curr.is_empty())
+        {
+            if ( ptr.cas(curr, value_intern(k,d)) )
+                return make_insert_ret(k,d, ptr, ReturnCode::SUCCESS_IN);
+
+            //somebody changed the current element! recheck it
+            --i;
+        }
+    }
+    return make_insert_ret(end(), ReturnCode::UNSUCCESS_FULL);
+}
+
+
+template<class HashFct, class A> template<class F, class ... Types>
+inline typename BaseSoA<HashFct,A>::insert_return_intern
+BaseSoA<HashFct,A>::update_intern(const key_type& k, F f, Types&& ... args)
+{
+    for (size_type i = h(k); ; ++i)
+    {
+        i = probe(i, k);
+        SoACell    ptr  = cell(i & _bitmask);
+        value_intern curr = ptr.load();
+
+        if (curr.compare_key(k))
+        {
+            mapped_type data;
+            bool        succ;
+            std::tie(data, succ) = ptr.atomic_update(curr, f,
+                                                     std::forward<Types>(args)...);
+            if (succ)
+                return make_insert_ret(k,data, ptr, ReturnCode::SUCCESS_UP);
+            i--;
+        }
+        else if (curr.is_empty())
+        {
+            return make_insert_ret(end(), ReturnCode::UNSUCCESS_NOT_FOUND);
+        }
+    }
+    return make_insert_ret(end(), ReturnCode::UNSUCCESS_NOT_FOUND);
+}
+
+template<class HashFct, class A> template<class F, class ... Types>
+inline typename BaseSoA<HashFct,A>::insert_return_intern
+BaseSoA<HashFct,A>::update_unsafe_intern(const key_type& k, F f, Types&& ... args)
+{
+    for (size_type i = h(k); ; ++i)
+    {
+        i = probe(i, k);
+        SoACell    ptr  = cell(i & _bitmask);
+        value_intern curr = ptr.load();
+
+        if (curr.compare_key(k))
+        {
+            mapped_type data = ptr.non_atomic_update(f,
+                                   std::forward<Types>(args)...).first;
+            return make_insert_ret(k,data, ptr, ReturnCode::SUCCESS_UP);
+        }
+        else if (curr.is_empty())
+        {
+            return make_insert_ret(end(), ReturnCode::UNSUCCESS_NOT_FOUND);
+        }
+    }
+    return make_insert_ret(end(), ReturnCode::UNSUCCESS_NOT_FOUND);
+}
+
+
+template<class HashFct, class A> template<class F, class ... Types>
+inline typename BaseSoA<HashFct,A>::insert_return_intern
+BaseSoA<HashFct,A>::insert_or_update_intern(const key_type& k,
+                                            const mapped_type& d,
+                                            F f, Types&& ... args)
+{
+    for (size_type i = h(k); ; ++i)
+    {
+        i = probe(i, k);
+        SoACell    ptr  = cell(i & _bitmask);
+        value_intern curr = ptr.load();
+
+        if (curr.compare_key(k))
+        {
+            mapped_type data;
+            bool        succ;
+            std::tie(data, succ) = ptr.atomic_update(curr, f,
+                                                     std::forward<Types>(args)...);
+            if (succ)
+                return make_insert_ret(k,data, ptr, ReturnCode::SUCCESS_UP);
+            i--;
+        }
+        else if (curr.is_empty())
+        {
+            if ( ptr.cas(curr, value_intern(k,d)) )
+                return make_insert_ret(k,d, ptr, ReturnCode::SUCCESS_IN);
+
+            //somebody changed the current element! recheck it
+            --i;
+        }
+    }
+    return make_insert_ret(end(), ReturnCode::UNSUCCESS_FULL);
+}
+
+template<class HashFct, class A> template<class F, class ... Types>
+inline typename BaseSoA<HashFct,A>::insert_return_intern
+BaseSoA<HashFct,A>::insert_or_update_unsafe_intern(const key_type& k,
+                                                   const mapped_type& d,
+                                                   F f, Types&& ... args)
+{
+    for (size_type i = h(k); ; ++i)
+    {
+        i = probe(i, k);
+        SoACell    ptr  = cell(i & _bitmask);
+        value_intern curr = ptr.load();
+
+        if (curr.compare_key(k))
+        {
+            mapped_type data = ptr.non_atomic_update(f,
+                                   std::forward<Types>(args)...).first;
+            return make_insert_ret(k,data, ptr, ReturnCode::SUCCESS_UP);
+        }
+        else if (curr.is_empty())
+        {
+            if ( ptr.cas(curr, value_intern(k,d)) )
+                return make_insert_ret(k,d, ptr, ReturnCode::SUCCESS_IN);
+
+            //somebody changed the current element! recheck it
+            --i;
+        }
+    }
+    return make_insert_ret(end(), ReturnCode::UNSUCCESS_FULL);
+}
+
+template<class HashFct, class A>
+inline ReturnCode BaseSoA<HashFct,A>::erase_intern(const key_type& k)
+{
+    for (size_type i = h(k); ; ++i)
+    {
+        i = probe(i, k);
+        SoACell    ptr  = cell(i & _bitmask);
+        value_intern curr = ptr.load();
+
+        if (curr.compare_key(k))
+        {
+            if (ptr.atomic_delete(curr))
+                return ReturnCode::SUCCESS_DEL;
+            i--;
+        }
+        else if (curr.is_empty())
+        {
+            return ReturnCode::UNSUCCESS_NOT_FOUND;
+        }
+    }
+    return ReturnCode::UNSUCCESS_NOT_FOUND;
+}
+
+template<class HashFct, class A>
+inline ReturnCode BaseSoA<HashFct,A>::erase_if_intern(const key_type& k,
+                                                      const mapped_type& d)
+{
+    for (size_type i = h(k); ; ++i)
+    {
+        i = probe(i, k);
+        SoACell    ptr  = cell(i & _bitmask);
+        value_intern curr = ptr.load();
+
+        if (curr.compare_key(k))
+        {
+            if (curr.get_data() != d) return ReturnCode::UNSUCCESS_NOT_FOUND;
+
+            if (ptr.atomic_delete(curr))
+                return ReturnCode::SUCCESS_DEL;
+            i--;
+        }
+        else if (curr.is_empty())
+        {
+            return ReturnCode::UNSUCCESS_NOT_FOUND;
+        }
+    }
+    return ReturnCode::UNSUCCESS_NOT_FOUND;
+}
+
+
+
+
+
+// MAIN HASH TABLE FUNCTIONALITY (EXTERN) **************************************
+
+template<class HashFct, class A>
+inline typename BaseSoA<HashFct,A>::iterator
+BaseSoA<HashFct,A>::find(const key_type& k)
+{
+    for (size_type i = h(k); ; ++i)
+    {
+        i = probe(i, k);
+        value_intern curr = cell(i & _bitmask).load();
+        if (curr.compare_key(k))
+            return make_iterator(k, curr.get_data(), cell(i & _bitmask));
+        if (curr.is_empty())
+            return end();
+    }
+    return end();
+}
+
+template<class HashFct, class A>
+inline typename BaseSoA<HashFct,A>::const_iterator
+BaseSoA<HashFct,A>::find(const key_type& k) const
+{
+    for (size_type i = h(k); ; ++i)
+    {
+        i = probe(i, k);
+        value_intern curr = cell(i & _bitmask).load();
+        if (curr.compare_key(k))
+            return make_citerator(k, curr.get_data(), cell(i & _bitmask));
+        if (curr.is_empty())
+            return cend();
+    }
+    return cend();
+}
+
+template<class HashFct, class A>
+inline typename BaseSoA<HashFct,A>::size_type
+BaseSoA<HashFct,A>::find_batch(const key_type* keys, size_type n,
+                               mapped_type* out, bool* found) const
+{
+    // same pipelining as in BaseCircular::find_batch, but each round probes
+    // one whole key line per slot
+    constexpr size_type line_size = KeyLineKernel::line_size;
+    size_type idx[batch_window];
+    size_type pos[batch_window];
+    size_type active  = 0;
+    size_type next    = 0;
+    size_type n_found = 0;
+
+    for (; active < batch_window && next < n; ++active, ++next)
+    {
+        idx[active] = next;
+        pos[active] = h(keys[next]);
+        prefetch(pos[active]);
+    }
+
+    while (active)
+    {
+        for (size_type s = 0; s < active; )
+        {
+            const key_type& k = keys[idx[s]];
+            bool done = false;
+            size_type lane = pos[s] & (line_size-1);
+            size_type r    = KeyLineKernel::first(
+                                 _t[(pos[s] & _bitmask) / line_size].key,
+                                 lane, k, SoAElement::BITMASK);
+            if (r < line_size)
+            {
+                pos[s] += r - lane;
+                value_intern curr = cell(pos[s] & _bitmask).load();
+                if (curr.compare_key(k))
+                {
+                    out  [idx[s]] = curr.get_data();
+                    found[idx[s]] = true;
+                    ++n_found;
+                    done = true;
+                }
+                else if (curr.is_empty())
+                {
+                    found[idx[s]] = false;
+                    done = true;
+                }
+                // otherwise the cell was changed, it is reprobed next round
+            }
+            else
+            {
+                pos[s] += line_size - lane;
+                prefetch(pos[s]);
+            }
+
+            if (!done)      { ++s; }
+            else if (next < n)
+            {
+                // refill the slot, its prefetch has time until the next round
+                idx[s] = next;
+                pos[s] = h(keys[next]);
+                prefetch(pos[s]);
+                ++next; ++s;
+            }
+            else
+            {
+                --active;
+                idx[s] = idx[active];
+                pos[s] = pos[active];
+            }
+        }
+    }
+    return n_found;
+}
+
+template<class HashFct, class A> template<bool Update, class F>
+inline void
+BaseSoA<HashFct,A>::batch_intern(const key_type* keys,
+                                 const mapped_type* data,
+                                 const size_type* order, size_type n,
+                                 ReturnCode* codes, F f)
+{
+    // same pipelining as in find_batch, slot holds the position in order
+    constexpr size_type line_size = KeyLineKernel::line_size;
+    size_type slot[batch_window];
+    size_type pos [batch_window];
+    size_type active = 0;
+    size_type next   = 0;
+
+    for (; active < batch_window && next < n; ++active, ++next)
+    {
+        slot[active] = next;
+        pos [active] = h(keys[order[next]]);
+        prefetch(pos[active]);
+    }
+
+    while (active)
+    {
+        for (size_type s = 0; s < active; )
+        {
+            const size_type j    = order[slot[s]];
+            const key_type& k    = keys[j];
+            ReturnCode      code = ReturnCode::ERROR;
+            size_type lane = pos[s] & (line_size-1);
+            size_type r    = KeyLineKernel::first(
+                                 _t[(pos[s] & _bitmask) / line_size].key,
+                                 lane, k, SoAElement::BITMASK);
+            if (r < line_size)
+            {
+                pos[s] += r - lane;
+                SoACell      ptr  = cell(pos[s] & _bitmask);
+                value_intern curr = ptr.load();
+                if (curr.compare_key(k))
+                {
+                    if (!Update)
+                        code = ReturnCode::UNSUCCESS_ALREADY_USED;
+                    else if (ptr.atomic_update(curr, f, data[j]).second)
+                        code = ReturnCode::SUCCESS_UP;
+                }
+                else if (curr.is_empty())
+                {
+                    if (ptr.cas(curr, value_intern(k, data[j])))
+                        code = ReturnCode::SUCCESS_IN;
+                }
+                // otherwise the cell was changed, it is reprobed next round
+            }
+            else
+            {
+                pos[s] += line_size - lane;
+                prefetch(pos[s]);
+            }
+
+            if (code == ReturnCode::ERROR) { ++s; continue; }
+
+            codes[slot[s]] = code;
+            if (next < n)
+            {
+                slot[s] = next;
+                pos [s] = h(keys[order[next]]);
+                prefetch(pos[s]);
+                ++next; ++s;
+            }
+            else
+            {
+                --active;
+                slot[s] = slot[active];
+                pos [s] = pos [active];
+            }
+        }
+    }
+}
+
+template<class HashFct, class A>
+inline void
+BaseSoA<HashFct,A>::batch_order(const key_type* keys, size_type n,
+                                size_type* order) const
+{
+    std::vector<std::pair<size_type, size_type> > temp(n);
+    for (size_type i = 0; i < n; ++i) temp[i] = std::make_pair(_hash(keys[i]), i);
+    std::sort(temp.begin(), temp.end());
+    for (size_type i = 0; i < n; ++i) order[i] = temp[i].second;
+}
+
+template<class HashFct, class A>
+inline typename BaseSoA<HashFct,A>::insert_return_type
+BaseSoA<HashFct,A>::insert(const key_type& k, const mapped_type& d)
+{
+    iterator   it = end();
+    ReturnCode c  = ReturnCode::ERROR;
+    std::tie(it,c) = insert_intern(k,d);
+    return std::make_pair(it, successful(c));
+}
+
+template<class HashFct, class A>
+inline typename BaseSoA<HashFct,A>::size_type
+BaseSoA<HashFct,A>::erase(const key_type& k)
+{
+    ReturnCode c = erase_intern(k);
+    return (successful(c)) ? 1 : 0;
+}
+
+template<class HashFct, class A>
+inline typename BaseSoA<HashFct,A>::size_type
+BaseSoA<HashFct,A>::erase_if(const key_type& k, const mapped_type& d)
+{
+    ReturnCode c = erase_if_intern(k,d);
+    return (successful(c)) ? 1 : 0;
+}
+
+template<class HashFct, class A> template <class F, class ... Types>
+inline typename BaseSoA<HashFct,A>::insert_return_type
+BaseSoA<HashFct,A>::update(const key_type& k, F f, Types&& ... args)
+{
+    iterator   it = end();
+    ReturnCode c  = ReturnCode::ERROR;
+    std::tie(it,c) = update_intern(k,f, std::forward<Types>(args)...);
+    return std::make_pair(it, successful(c));
+}
+
+template<class HashFct, class A> template <class F, class ... Types>
+inline typename BaseSoA<HashFct,A>::insert_return_type
+BaseSoA<HashFct,A>::update_unsafe(const key_type& k, F f, Types&& ... args)
+{
+    iterator   it = end();
+    ReturnCode c  = ReturnCode::ERROR;
+    std::tie(it,c) = update_unsafe_intern(k,f, std::forward<Types>(args)...);
+    return std::make_pair(it, successful(c));
+}
+
+template<class HashFct, class A> template <class F, class ... Types>
+inline typename BaseSoA<HashFct,A>::insert_return_type
+BaseSoA<HashFct,A>::insert_or_update(const key_type& k,
+                                     const mapped_type& d,
+                                     F f, Types&& ... args)
+{
+    iterator   it = end();
+    ReturnCode c  = ReturnCode::ERROR;
+    std::tie(it,c) = insert_or_update_intern(k,d,f,
+                                             std::forward<Types>(args)...);
+    return std::make_pair(it, (c == ReturnCode::SUCCESS_IN));
+}
+
+template<class HashFct, class A> template <class F, class ... Types>
+inline typename BaseSoA<HashFct,A>::insert_return_type
+BaseSoA<HashFct,A>::insert_or_update_unsafe(const key_type& k,
+                                            const mapped_type& d,
+                                            F f, Types&& ... args)
+{
+    iterator   it = end();
+    ReturnCode c  = ReturnCode::ERROR;
+    std::tie(it,c) = insert_or_update_unsafe_intern(k,d,f,
+                                                    std::forward<Types>(args)...);
+    return std::make_pair(it, (c == ReturnCode::SUCCESS_IN));
+}
+
+template<class HashFct, class A>
+inline typename BaseSoA<HashFct,A>::size_type
+BaseSoA<HashFct,A>::insert_batch(const key_type* keys,
+                                 const mapped_type* data, size_type n)
+{
+    return batch<false>(keys, data, n, example::Overwrite());
+}
+
+template<class HashFct, class A> template <class F>
+inline typename BaseSoA<HashFct,A>::size_type
+BaseSoA<HashFct,A>::insert_or_update_batch(const key_type* keys,
+                                           const mapped_type* data,
+                                           size_type n, F f)
+{
+    return batch<true>(keys, data, n, f);
+}
+
+template<class HashFct, class A> template <bool Update, class F>
+inline typename BaseSoA<HashFct,A>::size_type
+BaseSoA<HashFct,A>::batch(const key_type* keys, const mapped_type* data,
+                          size_type n, F f)
+{
+    std::vector<size_type>  order(n);
+    std::vector<ReturnCode> codes(n);
+    batch_order(keys, n, order.data());
+    batch_intern<Update>(keys, data, order.data(), n, codes.data(), f);
+    return std::count(codes.begin(), codes.end(), ReturnCode::SUCCESS_IN);
+}
+
+
+
+
+
+// MIGRATION/GROWING STUFF *****************************************************
+// same block partitioning as BaseCircular::migrate, cells are not marked,
+// since synchronized growing ensures, that no other operations are running
+
+template<class HashFct, class A>
+inline typename BaseSoA<HashFct,A>::size_type
+BaseSoA<HashFct,A>::migrate(This_t& target, size_type s, size_type e)
+{
+    size_type n = 0;
+    auto i = s;
+
+    //HOW MUCH BIGGER IS THE TARGET TABLE
+    auto shift = 0u;
+    while (target._capacity > (_capacity << shift)) ++shift;
+
+
+    //FINDS THE FIRST EMPTY BUCKET (START OF IMPLICIT BLOCK)
+    while (i<e && key_word(i) != 0) ++i;
+
+    for (size_type j = i<<shift; j < e<<shift; ++j) target.cell(j).set_empty();
+
+    //MIGRATE UNTIL THE END OF THE BLOCK
+    for (; i<e; ++i)
+    {
+        auto curr = key_word(i);
+        if (curr != 0 && curr != SoAElement::BITMASK)
+        {
+            target.insert_unsafe(curr, cell(i).get_data());
+            ++n;
+        }
+    }
+
+    auto b = true; // b indicates, if t[i-1] was non-empty
+
+    //CONTINUE UNTIL WE FIND AN EMPTY BUCKET
+    //THE TARGET POSITIONS WILL NOT BE INITIALIZED
+    for (; b; ++i)
+    {
+        auto pos  = i&_bitmask;
+        auto t_pos= pos<<shift;
+        for (size_type j = 0; j < 1ull<<shift; ++j) target.cell(t_pos+j).set_empty();
+
+        auto curr = key_word(pos);
+        if ( (b = (curr != 0)) && curr != SoAElement::BITMASK )
+        {
+            target.insert_unsafe(curr, cell(pos).get_data());
+            n++;
+        }
+    }
+
+    return n;
+}
+
+template<class HashFct, class A>
+inline void BaseSoA<HashFct,A>::insert_unsafe(const key_type& k,
+                                              const mapped_type& d)
+{
+    for (size_type i = h(k); ; ++i)
+    {
+        size_type temp = i & _bitmask;
+        if (key_word(temp) == 0)
+        {
+            cell(temp).set_unsafe(k, d);
+            return;
+        }
+    }
+    throw std::bad_alloc();
+}
+
+}
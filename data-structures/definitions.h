@@ -17,13 +17,22 @@
 
 #include "data-structures/simpleelement.h"
 #include "data-structures/markableelement.h"
+#include "data-structures/stringelement.h"
+#include "data-structures/packedelement.h"
+#include "data-structures/wideelement.h"
 #include "data-structures/base_circular.h"
+#include "data-structures/soaelement.h"
+#include "data-structures/base_soa.h"
+#include "data-structures/tag_circular.h"
+#include "data-structures/robin_circular.h"
 #include "data-structures/strategy/wstrat_user.h"
 #include "data-structures/strategy/wstrat_pool.h"
 #include "data-structures/strategy/estrat_async.h"
 #include "data-structures/strategy/estrat_sync.h"
 #include "data-structures/strategy/estrat_sync_alt.h"
+#include "data-structures/strategy/estrat_incremental.h"
 #include "data-structures/grow_table.h"
+#include "data-structures/grow_set.h"
 
 namespace growt {
 
@@ -46,6 +55,10 @@ template<class HashFct    = std::hash<typename SimpleElement::key_type>,
          class Allocator  = std::allocator<char> >
 using usGrow  = GrowTable<NoGrow<MarkableElement, HashFct, Allocator>, WStratUser, EStratSync>;
 
+template<class HashFct    = std::hash<typename MarkableElement::key_type>,
+         class Allocator  = std::allocator<char> >
+using uiGrow  = GrowTable<NoGrow<MarkableElement, HashFct, Allocator>, WStratUser, EStratIncremental>;
+
 template<class HashFct    = std::hash<typename SimpleElement::key_type>,
          class Allocator  = std::allocator<char> >
 using usnGrow = GrowTable<NoGrow<MarkableElement, HashFct, Allocator>, WStratUser, EStratSyncNUMA>;
@@ -63,6 +76,159 @@ template<class HashFct   = std::hash<typename SimpleElement::key_type>,
          class Allocator = std::allocator<char> >
 using psnGrow = GrowTable<NoGrow<MarkableElement, HashFct, Allocator>, WStratPool, EStratSyncNUMA>;
 
+
+// records probe distance histograms (see probe_stats.h)
+template<class HashFct   = std::hash<typename SimpleElement::key_type>,
+         class Allocator = std::allocator<char> >
+using folkloreStats = BaseCircular<SimpleElement, HashFct, Allocator, ProbeStats>;
+
+template<class HashFct   = std::hash<typename MarkableElement::key_type>,
+         class Allocator = std::allocator<char> >
+using uaGrowStats   = GrowTable<BaseCircular<MarkableElement, HashFct, Allocator, ProbeStats>, WStratUser, EStratAsync>;
+
+template<class HashFct   = std::hash<typename MarkableElement::key_type>,
+         class Allocator = std::allocator<char> >
+using usGrowStats   = GrowTable<BaseCircular<MarkableElement, HashFct, Allocator, ProbeStats>, WStratUser, EStratSync>;
+
+
+// grows by the factor 3/2 instead of 2 (see growth_policy.h)
+template<class HashFct   = std::hash<typename MarkableElement::key_type>,
+         class Allocator = std::allocator<char> >
+using uaGrow15      = GrowTable<BaseCircular<MarkableElement, HashFct, Allocator, NoProbeStats, GrowFactor<3,2> >, WStratUser, EStratAsync>;
+
+template<class HashFct   = std::hash<typename MarkableElement::key_type>,
+         class Allocator = std::allocator<char> >
+using usGrow15      = GrowTable<BaseCircular<MarkableElement, HashFct, Allocator, NoProbeStats, GrowFactor<3,2> >, WStratUser, EStratSync>;
+
+
+// iterators, scans, and (synchronized) migrations skip empty groups of 64
+// cells (see occupancy_summary.h)
+template<class HashFct   = std::hash<typename SimpleElement::key_type>,
+         class Allocator = std::allocator<char> >
+using folkloreOcc   = BaseCircular<SimpleElement, HashFct, Allocator, NoProbeStats, GrowDouble, OccupancySummary>;
+
+template<class HashFct   = std::hash<typename MarkableElement::key_type>,
+         class Allocator = std::allocator<char> >
+using uaGrowOcc     = GrowTable<BaseCircular<MarkableElement, HashFct, Allocator, NoProbeStats, GrowDouble, OccupancySummary>, WStratUser, EStratAsync>;
+
+template<class HashFct   = std::hash<typename SimpleElement::key_type>,
+         class Allocator = std::allocator<char> >
+using usGrowOcc     = GrowTable<BaseCircular<SimpleElement, HashFct, Allocator, NoProbeStats, GrowDouble, OccupancySummary>, WStratUser, EStratSync>;
+
+
+// split key/value layout (only synchronized growing)
+template<class HashFct   = std::hash<typename SoAElement::key_type>,
+         class Allocator = std::allocator<char> >
+using folkloreSoA = BaseSoA<HashFct, Allocator>;
+
+template<class HashFct   = std::hash<typename SoAElement::key_type>,
+         class Allocator = std::allocator<char> >
+using usGrowSoA   = GrowTable<BaseSoA<HashFct, Allocator>, WStratUser, EStratSync>;
+
+template<class HashFct   = std::hash<typename SoAElement::key_type>,
+         class Allocator = std::allocator<char> >
+using psGrowSoA   = GrowTable<BaseSoA<HashFct, Allocator>, WStratPool, EStratSync>;
+
+
+// additional control byte per cell (fast unsuccessful finds)
+template<class HashFct   = std::hash<typename SimpleElement::key_type>,
+         class Allocator = std::allocator<char> >
+using folkloreTag = TagCircular<SimpleElement, HashFct, Allocator>;
+
+template<class HashFct   = std::hash<typename MarkableElement::key_type>,
+         class Allocator = std::allocator<char> >
+using uaGrowTag   = GrowTable<TagCircular<MarkableElement, HashFct, Allocator>, WStratUser, EStratAsync>;
+
+template<class HashFct   = std::hash<typename MarkableElement::key_type>,
+         class Allocator = std::allocator<char> >
+using usGrowTag   = GrowTable<TagCircular<MarkableElement, HashFct, Allocator>, WStratUser, EStratSync>;
+
+
+// robin hood insertions (only synchronized growing)
+template<class HashFct   = std::hash<typename SimpleElement::key_type>,
+         class Allocator = std::allocator<char> >
+using folkloreRH  = RobinCircular<SimpleElement, HashFct, Allocator>;
+
+template<class HashFct   = std::hash<typename MarkableElement::key_type>,
+         class Allocator = std::allocator<char> >
+using usGrowRH    = GrowTable<RobinCircular<MarkableElement, HashFct, Allocator>, WStratUser, EStratSync>;
+
+template<class HashFct   = std::hash<typename MarkableElement::key_type>,
+         class Allocator = std::allocator<char> >
+using psGrowRH    = GrowTable<RobinCircular<MarkableElement, HashFct, Allocator>, WStratPool, EStratSync>;
+
+
+// 31 bit keys and 32 bit data packed into 8 byte cells (64 bit CAS)
+using Packed32 = PackedElement<32,32>;
+
+template<class HashFct   = std::hash<typename Packed32::key_type>,
+         class Allocator = std::allocator<char> >
+using folklorePacked = BaseCircular<Packed32, HashFct, Allocator>;
+
+template<class HashFct   = std::hash<typename Packed32::key_type>,
+         class Allocator = std::allocator<char> >
+using uaGrowPacked   = GrowTable<NoGrow<Packed32, HashFct, Allocator>, WStratUser, EStratAsync>;
+
+template<class HashFct   = std::hash<typename Packed32::key_type>,
+         class Allocator = std::allocator<char> >
+using usGrowPacked   = GrowTable<NoGrow<Packed32, HashFct, Allocator>, WStratUser, EStratSync>;
+
+template<class HashFct   = std::hash<typename Packed32::key_type>,
+         class Allocator = std::allocator<char> >
+using paGrowPacked   = GrowTable<NoGrow<Packed32, HashFct, Allocator>, WStratPool, EStratAsync>;
+
+template<class HashFct   = std::hash<typename Packed32::key_type>,
+         class Allocator = std::allocator<char> >
+using psGrowPacked   = GrowTable<NoGrow<Packed32, HashFct, Allocator>, WStratPool, EStratSync>;
+
+
+// sets of 63 bit keys (key-only 8 byte cells)
+using PackedKey = PackedElement<64,0>;
+
+template<class HashFct   = std::hash<typename PackedKey::key_type>,
+         class Allocator = std::allocator<char> >
+using uaGrowSet      = GrowSet<NoGrow<PackedKey, HashFct, Allocator>, WStratUser, EStratAsync>;
+
+template<class HashFct   = std::hash<typename PackedKey::key_type>,
+         class Allocator = std::allocator<char> >
+using usGrowSet      = GrowSet<NoGrow<PackedKey, HashFct, Allocator>, WStratUser, EStratSync>;
+
+template<class HashFct   = std::hash<typename PackedKey::key_type>,
+         class Allocator = std::allocator<char> >
+using paGrowSet      = GrowSet<NoGrow<PackedKey, HashFct, Allocator>, WStratPool, EStratAsync>;
+
+template<class HashFct   = std::hash<typename PackedKey::key_type>,
+         class Allocator = std::allocator<char> >
+using psGrowSet      = GrowSet<NoGrow<PackedKey, HashFct, Allocator>, WStratPool, EStratSync>;
+
+
+// inline values of up to 64 bytes (cells are read optimistically, see
+// wideelement.h)
+template<class V,
+         class HashFct   = std::hash<uint64_t>,
+         class Allocator = std::allocator<char> >
+using folkloreWide   = BaseCircular<WideElement<V>, HashFct, Allocator>;
+
+template<class V,
+         class HashFct   = std::hash<uint64_t>,
+         class Allocator = std::allocator<char> >
+using uaGrowWide     = GrowTable<BaseCircular<WideElement<V>, HashFct, Allocator>, WStratUser, EStratAsync>;
+
+template<class V,
+         class HashFct   = std::hash<uint64_t>,
+         class Allocator = std::allocator<char> >
+using usGrowWide     = GrowTable<BaseCircular<WideElement<V>, HashFct, Allocator>, WStratUser, EStratSync>;
+
+// string keys (cells hold a fingerprint and a pointer to the key/data record)
+template<class Allocator = std::allocator<char> >
+using folkloreString = BaseCircular<StringElement, StringKeyHash, Allocator>;
+
+template<class Allocator = std::allocator<char> >
+using uaGrowString   = GrowTable<BaseCircular<StringElement, StringKeyHash, Allocator>, WStratUser, EStratAsync>;
+
+template<class Allocator = std::allocator<char> >
+using usGrowString   = GrowTable<BaseCircular<StringElement, StringKeyHash, Allocator>, WStratUser, EStratSync>;
+
 }
 
 #endif // DEFINITIONS_H
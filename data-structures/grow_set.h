@@ -0,0 +1,114 @@
+/*******************************************************************************
+ * data-structures/grow_set.h
+ *
+ * Defines a concurrent set on top of our growtable architecture:
+ *   GrowSet         - the global facade (owns a GrowTable)
+ *   GrowSetHandle   - local handles (thread specific, wrap a GrowTableHandle)
+ * Growing works exactly like in the underlying GrowTable (same worker and
+ * exclusion strategies). With a key-only element (PackedElement<64,0>),
+ * cells have 8 bytes, i.e., migrations move half the bytes of a map.
+ *
+ * Part of Project growt - https://github.com/TooBiased/growt.git
+ *
+ * Copyright (C) 2015-2016 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "data-structures/grow_table.h"
+
+namespace growt {
+
+template<class GrowTable>
+class GrowSetHandle;
+
+template<class HashTable,
+         template <class> class WorkerStrat,
+         template <class> class ExclusionStrat>
+class GrowSet
+{
+private:
+    using Table_t          = GrowTable<HashTable, WorkerStrat, ExclusionStrat>;
+
+    Table_t _table;
+
+public:
+    using key_type         = typename HashTable::key_type;
+    using size_type        = size_t;
+    using Handle           = GrowSetHandle<Table_t>;
+
+    GrowSet (size_t size) : _table(size) { }
+
+    GrowSet (const GrowSet& source)            = delete;
+    GrowSet& operator= (const GrowSet& source) = delete;
+
+    GrowSet (GrowSet&& source)            = default;
+    GrowSet& operator= (GrowSet&& source) = default;
+
+    ~GrowSet() = default;
+
+    Handle get_handle() { return Handle(_table); }
+
+    // see GrowTable
+    void set_compaction(bool enable)      { _table.set_compaction(enable); }
+    void set_shrink_fill(double low_fill) { _table.set_shrink_fill(low_fill); }
+    void set_max_fill (double max_fill)   { _table.set_max_fill(max_fill); }
+    void set_grow_fill(double grow_fill)  { _table.set_grow_fill(grow_fill); }
+};
+
+
+
+
+// HANDLE OBJECTS EVERY THREAD HAS TO CREATE ONE HANDLE (THEY CANNOT BE SHARED)
+template<class GrowTable>
+class GrowSetHandle
+{
+private:
+    using TableHandle_t    = typename GrowTable::Handle;
+
+public:
+    using key_type         = typename TableHandle_t::key_type;
+    using mapped_type      = typename TableHandle_t::mapped_type;
+    using size_type        = size_t;
+
+    // the table handle is constructed in place (its strategy data cannot
+    // be moved safely)
+    GrowSetHandle(GrowTable& table) : _handle(table) { }
+
+    GrowSetHandle(const GrowSetHandle& source) = delete;
+    GrowSetHandle& operator=(const GrowSetHandle& source) = delete;
+
+    GrowSetHandle(GrowSetHandle&& source)            = default;
+    GrowSetHandle& operator=(GrowSetHandle&& source) = default;
+
+    ~GrowSetHandle() = default;
+
+    // returns true if k was not contained before
+    bool      insert  (const key_type& k)
+    { return _handle.insert(k, mapped_type()).second; }
+    // no iterator is created (see BaseCircular::contains)
+    bool      contains(const key_type& k) const
+    { return _handle.contains(k); }
+    size_type erase   (const key_type& k)
+    { return _handle.erase(k); }
+
+    // returns the number of newly inserted keys
+    size_type insert_batch(const key_type* keys, size_type n)
+    {
+        std::vector<mapped_type> data(n);
+        return _handle.insert_batch(keys, data.data(), n);
+    }
+
+    size_type element_count_approx() { return _handle.element_count_approx(); }
+    size_type migration_count() const { return _handle.migration_count(); }
+
+private:
+    TableHandle_t _handle;
+};
+
+}
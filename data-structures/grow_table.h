@@ -19,47 +19,114 @@
 
 #include <atomic>
 #include <memory>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <thread>
 
 #include "data-structures/returnelement.h"
 #include "data-structures/grow_iterator.h"
+#include "data-structures/probe_stats.h"
+#include "data-structures/migration_scheduler.h"
+#include "data-structures/backoff.h"
 #include "example/update_fcts.h"
 
 namespace growt {
 
 static const size_t migration_block_size = 4096;
 
+// an unaligned target (see BaseCircular::migrate) has to be initialized
+// completely, before any element is inserted, therefore, blocks are
+// distributed twice (first blocks of the target are initialized, then
+// blocks of the source are migrated), one counter is used for both passes
 template<class Table_t>
-size_t blockwise_migrate(Table_t source, Table_t target)
+size_t blockwise_migrate_unaligned(Table_t source, Table_t target,
+                                   std::true_type)
 {
-    size_t n = 0;
+    size_t n    = 0;
+    size_t tcap = target->_capacity;
+    size_t end  = tcap + source->_capacity;
 
-    //get block + while block legal migrate and get new block
     size_t temp = source->_current_copy_block.fetch_add(migration_block_size);
-    while (temp < source->_capacity)
+    while (temp < tcap)
+    {
+        target->initialize(temp, std::min(temp+migration_block_size, tcap));
+        source->_finished_copy_block.fetch_add(migration_block_size);
+        temp = source->_current_copy_block.fetch_add(migration_block_size);
+    }
+    for (size_t r = 0; source->_finished_copy_block.load() < tcap; )
+        backoff(r);
+
+    while (temp < end)
     {
-        n += source->migrate(*target, temp,
-                             std::min(uint(temp+migration_block_size),
-                                      uint(source->_capacity)));
+        n += source->migrate(*target, temp - tcap,
+                             std::min(temp+migration_block_size, end) - tcap);
         temp = source->_current_copy_block.fetch_add(migration_block_size);
     }
     return n;
 }
 
-template<size_t MxFill>
-size_t resize(size_t curr_size, size_t n_in, size_t n_del)
+template<class Table_t>
+size_t blockwise_migrate_unaligned(Table_t, Table_t, std::false_type)
+{ return 0; }
+
+template<class Table_t>
+size_t blockwise_migrate(Table_t source, Table_t target)
 {
-    auto nsize = curr_size;
-    double fill_rate = double(n_in - n_del)/double(curr_size);
+    using BaseTable_t = typename std::pointer_traits<Table_t>::element_type;
+    size_t shift = 0;
+    while (target->_capacity > source->_capacity << shift) ++shift;
+    if (target->_capacity != source->_capacity << shift)
+        return blockwise_migrate_unaligned(source, target,
+              std::integral_constant<bool, BaseTable_t::unaligned_migration>());
+
+    // blocks are distributed by the source's scheduler (see
+    // MigrationScheduler), _current_copy_block signals the running migration
+    source->_current_copy_block.fetch_add(1);
+
+    size_t n    = 0;
+    size_t cap  = source->_capacity;
+    size_t bs   = source->_migration.parameters().block_size;
+    size_t home = source->_migration.join();
 
-    if (fill_rate > double(MxFill)/200.) nsize <<= 1;
+    //get block + while block legal migrate and get new block
+    size_t temp = source->_migration.claim(home, cap);
+    while (temp < cap)
+    {
+        n += source->migrate(*target, temp, std::min(temp+bs, cap));
+        temp = source->_migration.claim(home, cap);
+    }
+    return n;
+}
 
-    return nsize;
+// every thread that joins a compaction pass helps to finish it, blocks are
+// distributed like in blockwise_migrate, removed(n) is called after each
+// block, the function returns once all blocks of the pass are finished
+template<class Table_t, class F>
+void blockwise_compact(Table_t table, F removed)
+{
+    size_t cap  = table->_capacity;
+    size_t temp = table->_current_compact_block.load();
+    size_t end  = (temp / cap + 1) * cap;
+    while (temp < end)
+    {
+        if (! table->_current_compact_block
+                  .compare_exchange_weak(temp, temp+migration_block_size))
+            continue;
+        removed(table->compact(temp % cap,
+                               temp % cap + migration_block_size));
+        table->_finished_compact_block.fetch_add(migration_block_size);
+        temp = table->_current_compact_block.load();
+    }
+    for (size_t r = 0; table->_finished_compact_block.load() < end; )
+        backoff(r);
 }
 
 
 
 
 
+
 // FORWARD DECLARATION OF THE HANDLE CLASS
 template<class> class GrowTableHandle;
 // AND THE STATIONARY DATA OBJECT (GLOBAL OBJECT ON HEAP)
@@ -103,6 +170,38 @@ public:
         return Handle(*_gt_data);
     }
 
+    // deleted cells are removed in place, instead of migrating the table
+    // to a table of the same size (see GrowTableHandle::compact), this
+    // avoids most migrations of delete heavy workloads, but more deleted
+    // cells remain in the table (off by default)
+    void set_compaction(bool enable) { _gt_data->_compaction.store(enable); }
+
+    // the table is shrunk (usually to a half or a quarter of its size),
+    // once less than low_fill*capacity elements remain (see
+    // BaseCircular::resize), this needs a base table that can migrate into
+    // smaller tables (unaligned_migration), watermarks above 2/3 of the
+    // grow fill act like 2/3 of it (0 disables shrinking, default)
+    void set_shrink_fill(double low_fill) { _gt_data->_shrink_fill.store(low_fill); }
+
+    // the table is migrated, once max_fill*capacity cells are used
+    // (including deleted cells), the migration grows the table, if more
+    // than grow_fill*capacity elements remain (defaults are given by the
+    // base table, e.g. BaseCircular::max_fill_factor)
+    void set_max_fill (double max_fill)  { _gt_data->_max_fill .store(max_fill);  }
+    void set_grow_fill(double grow_fill) { _gt_data->_grow_fill.store(grow_fill); }
+
+    // migrates the table once, directly into a table that holds n elements
+    // without growing (see GrowTableHandle::reserve)
+    void reserve(size_t n) { get_handle().reserve(n); }
+
+    // fills the (empty) table with n elements using the given number of
+    // threads, the table is grown once, then the elements are written
+    // without atomics (see GrowTableHandle::build), returns #inserted
+    size_t build(const std::pair<typename HashTable::key_type,
+                                 typename HashTable::mapped_type>* data,
+                 size_t n, size_t threads)
+    { return get_handle().build(data, n, threads); }
+
 };
 
 
@@ -120,6 +219,7 @@ private:
     using WorkerStrat_t    = typename Parent::WorkerStrat_t;
     using ExclusionStrat_t = typename Parent::ExclusionStrat_t;
 
+    friend Parent;
     friend WorkerStrat_t;
     friend ExclusionStrat_t;
 
@@ -131,7 +231,9 @@ public:
 
     GrowTableData(size_type size_)
         : _global_exclusion(size_), _global_worker(), // handle_ptr(64),
-          _elements(0), _dummies(0), _grow_count(0)
+          _elements(0), _dummies(0), _grow_count(0), _compaction(false),
+          _shrink_fill(0.), _max_fill(BaseTable_t::max_fill_factor),
+          _grow_fill(BaseTable_t::grow_fill_factor), _reserved(0)
     { }
 
     GrowTableData(const GrowTableData& source) = delete;
@@ -151,6 +253,36 @@ private:
     alignas(64) std::atomic_int _elements;
     alignas(64) std::atomic_int _dummies;
     alignas(64) std::atomic_int _grow_count;
+
+    std::atomic_bool _compaction;
+    std::atomic<double> _shrink_fill;
+    std::atomic<double> _max_fill;
+    std::atomic<double> _grow_fill;
+    // capacity requested by reserve, used by migrations until it is reached
+    std::atomic_size_t  _reserved;
+
+    // capacity of the next table, depends on the approximate counts and on
+    // the fill rates of this table (see BaseCircular::resize)
+    size_t next_capacity(size_t capacity) const
+    {
+        size_t reserved = _reserved.load(std::memory_order_acquire);
+        if (reserved > capacity) return reserved;
+        return BaseTable_t::resize(capacity,
+                                   _elements.load(std::memory_order_acquire),
+                                   _dummies .load(std::memory_order_acquire),
+                                   _grow_fill  .load(std::memory_order_relaxed),
+                                   _shrink_fill.load(std::memory_order_relaxed));
+    }
+
+    // capacity (reached by growing steps of the base table) that holds n
+    // elements, before max_fill triggers the next migration
+    size_t reserve_capacity(size_t capacity, size_t n) const
+    {
+        double max_fill = _max_fill.load(std::memory_order_relaxed);
+        while (double(capacity) * max_fill < double(n))
+            capacity = BaseTable_t::resize(capacity, capacity, 0, 0.);
+        return capacity;
+    }
 };
 
 
@@ -226,6 +358,22 @@ public:
     iterator           find  (const key_type& k);
     const_iterator     find  (const key_type& k) const;
 
+    // lookup without an iterator (see GrowSet)
+    bool               contains(const key_type& k) const;
+
+    // batched lookup (the table is acquired once for the whole batch)
+    size_type          find_batch(const key_type* keys, size_type n,
+                                  mapped_type* out, bool* found);
+
+    // batched insertions (return #inserted), existing elements are
+    // updated with f(current_data, data[i]) by insert_or_update_batch
+    size_type          insert_batch(const key_type* keys,
+                                    const mapped_type* data, size_type n);
+    template <class F>
+    size_type          insert_or_update_batch(const key_type* keys,
+                                              const mapped_type* data,
+                                              size_type n, F f);
+
     insert_return_type insert_or_assign(const key_type& k, const mapped_type& d)
     { return insert_or_update(k, d, example::Overwrite(), d); }
 
@@ -252,6 +400,31 @@ public:
     size_type          erase_if (const key_type& k, const mapped_type& d);
 
     size_type element_count_approx() { return _gt_data.element_count_approx(); }
+
+    // number of migrations since the table was created
+    size_type migration_count() const
+    { return cexecute([](HashPtrRef_t t) { return t->_version; }); }
+
+    // block size and ranges of the current table's next migration (see
+    // migration_scheduler.h)
+    MigrationScheduler::Parameters migration_parameters() const
+    { return cexecute([](HashPtrRef_t t) { return t->_migration.parameters(); }); }
+
+    // grows the table to hold n elements with a single migration (instead of
+    // one migration per growing step), all threads help as usual
+    void reserve(size_type n);
+
+    // bulk insertion into an empty table, no other operations can run
+    // concurrently (see BaseCircular::build), base tables without bulk_build
+    // are filled by parallel handles (one per thread, then any occurrence
+    // of a duplicate key can win)
+    size_type build(const std::pair<key_type, mapped_type>* data,
+                    size_type n, size_type threads);
+
+    // probe distance histograms of all handles (recorded by the base table,
+    // kept while the table grows), see probe_stats.h
+    ProbeStatistics probe_stats() const
+    { return cexecute([](HashPtrRef_t t) { return t->probe_stats(); }); }
     //size_type element_count_unsafe();
 
 private:
@@ -289,6 +462,39 @@ private:
         return result;
     }
 
+    // single key operations, the exclusion strategy can choose the table
+    // depending on the key (see EStratIncremental)
+    template<typename Functor, typename ... Types>
+    inline typename std::result_of<Functor(HashPtrRef_t, const key_type&, Types&& ...)>::type
+    kexecute (Functor f, const key_type& k, Types&& ... param)
+    {
+        HashPtrRef_t temp = _local_exclusion.get_table(k);
+        auto result = std::forward<Functor>(f)
+                          (temp, k, std::forward<Types>(param)...);
+        rls_table();
+        return result;
+    }
+
+    template<typename Functor, typename ... Types>
+    inline typename std::result_of<Functor(HashPtrRef_t, const key_type&, Types&& ...)>::type
+    kcexecute (Functor f, const key_type& k, Types&& ... param) const
+    {
+        HashPtrRef_t temp = _local_exclusion.get_table(k);
+        auto result = std::forward<Functor>(f)
+                          (temp, k, std::forward<Types>(param)...);
+        rls_table();
+        return result;
+    }
+
+    // batches are processed in chunks (each sorted by hash), after each chunk
+    // the local counters are updated and failed elements are queued for
+    // a retry (after the table was grown)
+    static constexpr size_type _batch_chunk = 64;
+
+    template <bool Update, class F>
+    size_type batch(const key_type* keys, const mapped_type* data,
+                    size_type n, F f);
+
     inline iterator make_iterator(const basetable_iterator& bit, size_t version)
     { return iterator(bit, version, *this); }
     inline iterator make_citerator(const basetable_citerator& bcit, size_t version)
@@ -302,7 +508,22 @@ private:
     inline basetable_iterator bcend()
     { return basetable_citerator(std::make_pair(key_type(), mapped_type()), nullptr, nullptr);}
 
-    static constexpr double _max_fill_factor = 0.666;
+    // instead of a migration that would not grow the table, deleted cells
+    // are removed in place (see BaseCircular::compact), this is only
+    // successful if the fill rate drops below _compact_fill_factor*max_fill
+    static constexpr double _compact_fill_factor = 0.9;
+    using compactable_t = std::integral_constant<bool, BaseTable_t::compactable>;
+
+    bool compact(HashPtrRef_t, std::false_type) { return false; }
+    bool compact(HashPtrRef_t table, std::true_type);
+
+    // true if the next migration would shrink the table (see set_shrink_fill)
+    bool shrink_due(HashPtrRef_t table);
+
+    size_type build(const std::pair<key_type, mapped_type>* data,
+                    size_type n, size_type threads, std::true_type);
+    size_type build(const std::pair<key_type, mapped_type>* data,
+                    size_type n, size_type threads, std::false_type);
 
     // LOCAL COUNTERS FOR SIZE ESTIMATION WITH SOME PADDING FOR
     // REDUCING CACHE EFFECTS
@@ -311,7 +532,10 @@ public:
 
 private:
     void inc_inserted(int v);
+    void inc_inserted(int v, int n);
     void inc_deleted(int v);
+    // a reused cell was counted as a deleted cell (dummy) before
+    void inc_reused(int v, int n = 1);
 
     class alignas(64) LocalCount
     {
@@ -378,6 +602,27 @@ public:
         return cap;
     }
 
+    // calls f(key, data) for the elements of the current table, whose home
+    // cell in a table of capacity cap is in [s,e) (see parallel_scan.h)
+    template <class F>
+    void for_each_home(size_type cap, size_type s, size_type e, F f)
+    {
+        execute([cap, s, e, &f](HashPtrRef_t t)
+                { t->for_each_home(cap, s, e, f); return 0; });
+    }
+
+    // visits the elements with hash >= cursor (at least max_elems, unless
+    // the end is reached), returns the cursor of the next call (0 at the
+    // end), elements that exist during the whole scan are visited at least
+    // once, even if the table is migrated between calls (see
+    // BaseCircular::scan)
+    template <class F>
+    size_type scan(size_type cursor, size_type max_elems, F f)
+    {
+        return execute([cursor, max_elems, &f](HashPtrRef_t t)
+                       { return t->scan(cursor, max_elems, f); });
+    }
+
 };
 
 
@@ -473,7 +718,7 @@ GrowTableHandle<GrowTableData>::insert(const key_type& k, const mapped_type& d)
 {
     int v = -1;
     basetable_insert_return_type result = std::make_pair(bend(), ReturnCode::ERROR);
-    std::tie (v, result) = execute([](HashPtrRef_t t, const key_type& k, const mapped_type& d)
+    std::tie (v, result) = kexecute([](HashPtrRef_t t, const key_type& k, const mapped_type& d)
                                      ->std::pair<int,basetable_insert_return_type>
                                    {
                                        std::pair<int,basetable_insert_return_type> result =
@@ -488,6 +733,9 @@ GrowTableHandle<GrowTableData>::insert(const key_type& k, const mapped_type& d)
     case ReturnCode::TSX_SUCCESS_IN:
         inc_inserted(v);
         return make_insert_ret(result.first, v, true);
+    case ReturnCode::SUCCESS_IN_REUSED:
+        inc_reused(v);
+        return make_insert_ret(result.first, v, true);
     case ReturnCode::UNSUCCESS_ALREADY_USED:
     case ReturnCode::TSX_UNSUCCESS_ALREADY_USED:
         return make_insert_ret(result.first, v, false);
@@ -511,7 +759,7 @@ GrowTableHandle<GrowTableData>::update(const key_type& k, F f, Types&& ... args)
     int v = -1;
     basetable_insert_return_type result = std::make_pair(bend(), ReturnCode::ERROR);
 
-    std::tie (v, result) = execute(
+    std::tie (v, result) = kexecute(
         [](HashPtrRef_t t, const key_type& k, F f, Types&& ... args)
         ->std::pair<int,basetable_insert_return_type>
         {
@@ -550,7 +798,7 @@ GrowTableHandle<GrowTableData>::update_unsafe(const key_type& k, F f, Types&& ..
     int v = -1;
     basetable_insert_return_type result = std::make_pair(bend(), ReturnCode::ERROR);
 
-    std::tie (v, result) = execute(
+    std::tie (v, result) = kexecute(
         [](HashPtrRef_t t, const key_type& k, F f, Types&& ... args)
         ->std::pair<int,basetable_insert_return_type>
         {
@@ -589,7 +837,7 @@ GrowTableHandle<GrowTableData>::insert_or_update(const key_type& k, const mapped
     int v = -1;
     basetable_insert_return_type result = std::make_pair(bend(), ReturnCode::ERROR);
 
-    std::tie (v, result) = execute(
+    std::tie (v, result) = kexecute(
         [](HashPtrRef_t t, const key_type& k, const mapped_type& d, F f, Types&& ... args)
         ->std::pair<int,basetable_insert_return_type>
         {
@@ -605,6 +853,9 @@ GrowTableHandle<GrowTableData>::insert_or_update(const key_type& k, const mapped
     case ReturnCode::TSX_SUCCESS_IN:
         inc_inserted(v);
         return make_insert_ret(result.first, v, true);
+    case ReturnCode::SUCCESS_IN_REUSED:
+        inc_reused(v);
+        return make_insert_ret(result.first, v, true);
     case ReturnCode::SUCCESS_UP:
     case ReturnCode::TSX_SUCCESS_UP:
         return make_insert_ret(result.first, v, false);
@@ -628,7 +879,7 @@ GrowTableHandle<GrowTableData>::insert_or_update_unsafe(const key_type& k, const
     int v = -1;
     basetable_insert_return_type result = std::make_pair(bend(), ReturnCode::ERROR);
 
-    std::tie (v, result) = execute(
+    std::tie (v, result) = kexecute(
         [](HashPtrRef_t t, const key_type& k, const mapped_type& d, F f, Types&& ... args)
         ->std::pair<int,basetable_insert_return_type>
         {
@@ -644,6 +895,9 @@ GrowTableHandle<GrowTableData>::insert_or_update_unsafe(const key_type& k, const
     case ReturnCode::TSX_SUCCESS_IN:
         inc_inserted(v);
         return make_insert_ret(result.first, v, true);
+    case ReturnCode::SUCCESS_IN_REUSED:
+        inc_reused(v);
+        return make_insert_ret(result.first, v, true);
     case ReturnCode::SUCCESS_UP:
     case ReturnCode::TSX_SUCCESS_UP:
         return make_insert_ret(result.first, v, false);
@@ -666,7 +920,7 @@ GrowTableHandle<GrowTableData>::find(const key_type& k)
 {
     int v = -1;
     basetable_iterator bit = bend();
-    std::tie (v, bit) = execute([](HashPtrRef_t t, const key_type & k) -> std::pair<int, basetable_iterator>
+    std::tie (v, bit) = kexecute([](HashPtrRef_t t, const key_type & k) -> std::pair<int, basetable_iterator>
                                 { return std::make_pair<int, basetable_iterator>(t->_version, t->find(k)); },
                      k);
     return make_iterator(bit, v);
@@ -678,19 +932,145 @@ GrowTableHandle<GrowTableData>::find(const key_type& k) const
 {
     int v = -1;
     basetable_citerator bit = bcend();
-    std::tie (v, bit) = cexecute([](HashPtrRef_t t, const key_type & k) -> std::pair<int, basetable_citerator>
+    std::tie (v, bit) = kcexecute([](HashPtrRef_t t, const key_type & k) -> std::pair<int, basetable_citerator>
                                 { return std::make_pair<int, basetable_iterator>(t->_version, t->find(k)); },
                      k);
     return make_citerator(bit, v);
 }
 
+template<class GrowTableData>
+inline bool GrowTableHandle<GrowTableData>::contains(const key_type& k) const
+{
+    return kcexecute([](HashPtrRef_t t, const key_type& k) -> bool
+                    { return t->contains(k); },
+                    k);
+}
+
+template<class GrowTableData>
+inline typename GrowTableHandle<GrowTableData>::size_type
+GrowTableHandle<GrowTableData>::find_batch(const key_type* keys, size_type n,
+                                           mapped_type* out, bool* found)
+{
+    return execute([](HashPtrRef_t t, const key_type* keys, size_type n,
+                      mapped_type* out, bool* found) -> size_type
+                   { return t->find_batch(keys, n, out, found); },
+                   keys, n, out, found);
+}
+
+template<class GrowTableData>
+inline typename GrowTableHandle<GrowTableData>::size_type
+GrowTableHandle<GrowTableData>::insert_batch(const key_type* keys,
+                                             const mapped_type* data,
+                                             size_type n)
+{
+    return batch<false>(keys, data, n, example::Overwrite());
+}
+
+template<class GrowTableData> template <class F>
+inline typename GrowTableHandle<GrowTableData>::size_type
+GrowTableHandle<GrowTableData>::insert_or_update_batch(const key_type* keys,
+                                                       const mapped_type* data,
+                                                       size_type n, F f)
+{
+    return batch<true>(keys, data, n, f);
+}
+
+template<class GrowTableData> template <bool Update, class F>
+inline typename GrowTableHandle<GrowTableData>::size_type
+GrowTableHandle<GrowTableData>::batch(const key_type* keys,
+                                      const mapped_type* data,
+                                      size_type n, F f)
+{
+    std::vector<size_type> order(n);
+    std::vector<size_type> retry;
+    ReturnCode             codes[_batch_chunk];
+    size_type              inserted = 0;
+
+    // the hash order does not depend on the table size,
+    // therefore, it remains valid after the table is grown
+    // each chunk is sorted on its own, sorting the whole batch would fill
+    // the table one part after the other, far beyond the fill factor
+    // (growing is triggered by the global number of elements), the
+    // resulting clusters could span whole migration blocks
+    execute([](HashPtrRef_t t, const key_type* keys, size_type n,
+               size_type* order) -> int
+            {
+                for (size_type s = 0; s < n; s += _batch_chunk)
+                {
+                    size_type m = std::min(_batch_chunk, n - s);
+                    t->batch_order(keys+s, m, order+s);
+                    for (size_type j = s; j < s+m; ++j) order[j] += s;
+                }
+                return 0;
+            },
+            keys, n, order.data());
+
+    while (! order.empty())
+    {
+        for (size_type s = 0; s < order.size(); s += _batch_chunk)
+        {
+            size_type m = std::min(_batch_chunk, order.size() - s);
+            int v = execute(
+                [](HashPtrRef_t t, const key_type* keys, const mapped_type* data,
+                   const size_type* order, size_type m, ReturnCode* codes, F f)
+                -> int
+                {
+                    t->template batch_intern<Update>(keys, data, order, m,
+                                                     codes, f);
+                    return t->_version;
+                }, keys, data, order.data()+s, m, &codes[0], f);
+
+            size_type ins     = 0;
+            size_type reused  = 0;
+            bool      full    = false;
+            bool      invalid = false;
+            for (size_type j = 0; j < m; ++j)
+            {
+                switch(codes[j])
+                {
+                case ReturnCode::SUCCESS_IN:
+                case ReturnCode::TSX_SUCCESS_IN:
+                    ++ins;
+                    break;
+                case ReturnCode::SUCCESS_IN_REUSED:
+                    ++reused;
+                    break;
+                case ReturnCode::UNSUCCESS_FULL:
+                case ReturnCode::TSX_UNSUCCESS_FULL:
+                    full = true;
+                    retry.push_back(order[s+j]);
+                    break;
+                case ReturnCode::UNSUCCESS_INVALID:
+                case ReturnCode::TSX_UNSUCCESS_INVALID:
+                    invalid = true;
+                    retry.push_back(order[s+j]);
+                    break;
+                default:
+                    break;
+                }
+            }
+
+            // grow before counting, otherwise counting could trigger
+            // a grow of its own, and help_grow would be called needlessly
+            if (full)         grow();
+            else if (invalid) help_grow();
+            inserted += ins + reused;
+            if (ins)          inc_inserted(v, ins);
+            if (reused)       inc_reused(v, reused);
+        }
+        order.swap(retry);
+        retry.clear();
+    }
+    return inserted;
+}
+
 template<class GrowTableData>
 inline typename GrowTableHandle<GrowTableData>::size_type
 GrowTableHandle<GrowTableData>::erase(const key_type& k)
 {
     int v = -1;
     ReturnCode result = ReturnCode::ERROR;
-    std::tie (v, result) = execute([](HashPtrRef_t t, const key_type& k)
+    std::tie (v, result) = kexecute([](HashPtrRef_t t, const key_type& k)
                                      ->std::pair<int,ReturnCode>
                                    {
                                        std::pair<int,ReturnCode> result =
@@ -726,7 +1106,7 @@ GrowTableHandle<GrowTableData>::erase_if(const key_type& k, const mapped_type& d
 {
     int v = -1;
     ReturnCode result = ReturnCode::ERROR;
-    std::tie (v, result) = execute([](HashPtrRef_t t,
+    std::tie (v, result) = kexecute([](HashPtrRef_t t,
                                       const key_type& k,
                                       const mapped_type& d)
                                      ->std::pair<int,ReturnCode>
@@ -807,6 +1187,87 @@ GrowTableHandle<GrowTableData>::cend()  const
 
 
 
+// RESERVE *********************************************************************
+
+template<class GrowTableData>
+inline void GrowTableHandle<GrowTableData>::reserve(size_type n)
+{
+    while (true)
+    {
+        size_type cap      = execute([](HashPtrRef_t t) { return t->_capacity; });
+        size_type target   = _gt_data.reserve_capacity(cap, n);
+        auto&     reserved = _gt_data._reserved;
+        size_type temp     = reserved.load(std::memory_order_relaxed);
+        if (target <= cap)
+        {
+            // reached reservations are removed (shrinking works again)
+            while (temp && temp <= cap
+                   && ! reserved.compare_exchange_weak(temp, 0)) { }
+            return;
+        }
+
+        // the next migration uses the reserved capacity (a running
+        // migration is finished first, then we try again)
+        while (temp < target
+               && ! reserved.compare_exchange_weak(temp, target,
+                                                   std::memory_order_acq_rel)) { }
+        grow();
+    }
+}
+
+
+
+// BULK BUILD ******************************************************************
+
+template<class GrowTableData>
+inline typename GrowTableHandle<GrowTableData>::size_type
+GrowTableHandle<GrowTableData>::build(const std::pair<key_type, mapped_type>* data,
+                                      size_type n, size_type threads)
+{
+    reserve(n);
+    return build(data, n, threads,
+                 std::integral_constant<bool, BaseTable_t::bulk_build>());
+}
+
+template<class GrowTableData>
+inline typename GrowTableHandle<GrowTableData>::size_type
+GrowTableHandle<GrowTableData>::build(const std::pair<key_type, mapped_type>* data,
+                                      size_type n, size_type threads,
+                                      std::true_type)
+{
+    size_type inserted = execute(
+        [](HashPtrRef_t t, const std::pair<key_type, mapped_type>* data,
+           size_type n, size_type threads)
+        { return t->build(data, n, threads); },
+        data, n, threads);
+    _gt_data._elements.fetch_add(inserted, std::memory_order_relaxed);
+    return inserted;
+}
+
+template<class GrowTableData>
+inline typename GrowTableHandle<GrowTableData>::size_type
+GrowTableHandle<GrowTableData>::build(const std::pair<key_type, mapped_type>* data,
+                                      size_type n, size_type threads,
+                                      std::false_type)
+{
+    threads = std::max<size_type>(threads, 1);
+    std::vector<size_type>   inserted(threads, 0);
+    std::vector<std::thread> workers;
+    auto fill = [this, data, n, threads, &inserted](size_type t)
+    {
+        This_t handle(_gt_data);
+        for (size_type i = n*t/threads; i < n*(t+1)/threads; ++i)
+            if (handle.insert(data[i].first, data[i].second).second)
+                ++inserted[t];
+    };
+    for (size_type t = 1; t < threads; ++t) workers.emplace_back(fill, t);
+    fill(0);
+    for (auto& w : workers) w.join();
+    return std::accumulate(inserted.begin(), inserted.end(), size_type(0));
+}
+
+
+
 // COUNTING FUNCTIONALITY ******************************************************
 
 template<class GrowTableData>
@@ -814,8 +1275,10 @@ inline void GrowTableHandle<GrowTableData>::update_numbers()
 {
     _counts._updates  = 0;
 
-    auto table = get_table();
-    if (table->_version != size_t(_counts._version))
+    // the size estimate does not wait for a running (incremental) migration,
+    // counts of its target (newer version) are kept
+    auto table = _local_exclusion.peek_table();
+    if (table->_version > size_t(_counts._version))
     {
         _counts.set(table->_version, 0,0,0);
         rls_table();
@@ -827,7 +1290,10 @@ inline void GrowTableHandle<GrowTableData>::update_numbers()
     auto temp       = _gt_data._elements.fetch_add(_counts._inserted, std::memory_order_relaxed);
     temp           += _counts._inserted;
 
-    if (temp  > table->_capacity * _max_fill_factor)
+    if ((temp  > table->_capacity
+                 * _gt_data._max_fill.load(std::memory_order_relaxed)
+         && ! compact(table, compactable_t()))
+        || shrink_due(table))
     {
         rls_table();
         grow();
@@ -836,10 +1302,40 @@ inline void GrowTableHandle<GrowTableData>::update_numbers()
     _counts.set(_counts._version, 0,0,0);
 }
 
+template<class GrowTableData>
+inline bool GrowTableHandle<GrowTableData>::shrink_due(HashPtrRef_t table)
+{
+    if (_gt_data._shrink_fill.load(std::memory_order_relaxed) <= 0.) return false;
+
+    return _gt_data.next_capacity(table->_capacity) < table->_capacity;
+}
+
+template<class GrowTableData>
+inline bool GrowTableHandle<GrowTableData>::compact(HashPtrRef_t table,
+                                                    std::true_type)
+{
+    size_type cap = table->_capacity;
+    if (! _gt_data._compaction.load(std::memory_order_relaxed)
+        || _gt_data.next_capacity(cap) != cap) return false;
+
+    blockwise_compact(table, [this](int n)
+                      {
+                          _gt_data._dummies .fetch_sub(n, std::memory_order_relaxed);
+                          _gt_data._elements.fetch_sub(n, std::memory_order_relaxed);
+                      });
+    int elements = _gt_data._elements.load(std::memory_order_acquire);
+
+    return elements <= cap * _compact_fill_factor
+                           * _gt_data._max_fill.load(std::memory_order_relaxed);
+}
+
+// operations on an older table count towards the current counts, this
+// happens during incremental migrations (operations use both tables, and
+// the elements of the source are migrated), see EStratIncremental
 template<class GrowTableData>
 inline void GrowTableHandle<GrowTableData>::inc_inserted(int v)
 {
-    if (_counts._version == v)
+    if (_counts._version >= v)
     {
         ++_counts._inserted;
         if (++_counts._updates > 64)
@@ -854,10 +1350,27 @@ inline void GrowTableHandle<GrowTableData>::inc_inserted(int v)
 }
 
 
+template<class GrowTableData>
+inline void GrowTableHandle<GrowTableData>::inc_inserted(int v, int n)
+{
+    if (_counts._version >= v)
+    {
+        _counts._inserted += n;
+        if ((_counts._updates += n) > 64)
+        {
+            update_numbers();
+        }
+    }
+    else
+    {
+        _counts.set(v,n,n,0);
+    }
+}
+
 template<class GrowTableData>
 inline void GrowTableHandle<GrowTableData>::inc_deleted(int v)
 {
-    if (_counts._version == v)
+    if (_counts._version >= v)
     {
         ++_counts._deleted;
         if (++_counts._updates > 64)
@@ -871,6 +1384,23 @@ inline void GrowTableHandle<GrowTableData>::inc_deleted(int v)
     }
 }
 
+template<class GrowTableData>
+inline void GrowTableHandle<GrowTableData>::inc_reused(int v, int n)
+{
+    if (_counts._version >= v)
+    {
+        _counts._deleted -= n;
+        if ((_counts._updates += n) > 64)
+        {
+            update_numbers();
+        }
+    }
+    else
+    {
+        _counts.set(v,n,0,-n);
+    }
+}
+
 // template <typename GrowTableData>
 // inline typename GrowTableHandle<GrowTableData>::size_type
 // GrowTableHandle<GrowTableData>::element_count_unsafe()
@@ -0,0 +1,102 @@
+/*******************************************************************************
+ * data-structures/growth_policy.h
+ *
+ * Growth policies for our tables (template parameter Growth of
+ * BaseCircular). They define the possible capacities, the range reduction
+ * from hash values to cells, and the capacity after growing or shrinking.
+ * Both range reductions are monotone in the hash value, thus, migrations
+ * can copy the table block by block, and scans can continue in the hash
+ * order of home cells after a migration (see BaseCircular::scan).
+ *   GrowDouble         - powers of two, h(k) uses the leading bits of the
+ *                        hash value, probes wrap with a bitmask (default)
+ *   GrowFactor<N,D>    - capacities grow by the factor N/D (e.g. 5/4 or
+ *                        3/2), h(k) = (hash * capacity) >> 64 (multiply
+ *                        shift), probes wrap with a comparison
+ *
+ * Part of Project growt - https://github.com/TooBiased/growt.git
+ *
+ * Copyright (C) 2015-2016 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <stdlib.h>
+#include <cstdint>
+
+namespace growt {
+
+class GrowDouble
+{
+public:
+    using size_type = size_t;
+
+    // capacity is at least twice as large, as the inserted capacity
+    static size_type capacity(size_type desired_capacity)
+    {
+        size_type temp = 16384u;
+        while (temp < desired_capacity) temp <<= 1;
+        return temp << 1;
+    }
+
+    static size_type grow  (size_type capacity) { return capacity << 1; }
+    static size_type shrink(size_type capacity) { return capacity >> 1; }
+
+    static size_type reduce(size_type hash, size_type, size_type right_shift)
+    { return hash >> right_shift; }
+
+    // the smallest hash value with reduce(hash) == cell (see scan)
+    static size_type first_hash(size_type cell, size_type, size_type right_shift)
+    { return cell << right_shift; }
+
+    // probe indices are below 2*capacity (one round starting at h(k))
+    static size_type wrap(size_type i, size_type, size_type bitmask)
+    { return i & bitmask; }
+};
+
+// capacities are multiples of granularity (one migration block), this
+// keeps the cache line alignment of the cells
+template<size_t Num, size_t Den>
+class GrowFactor
+{
+public:
+    using size_type = size_t;
+
+    static_assert(Num > Den, "GrowFactor needs a factor larger than one!");
+
+    static constexpr size_type granularity = 4096;
+
+    static size_type capacity(size_type desired_capacity)
+    {
+        size_type temp = (desired_capacity < 16384u) ? 16384u
+                                                     : desired_capacity;
+        return round_up(temp << 1);
+    }
+
+    static size_type grow  (size_type capacity)
+    { return round_up(capacity / Den * Num); }
+    static size_type shrink(size_type capacity)
+    { return round_up(capacity / Num * Den); }
+
+    static size_type reduce(size_type hash, size_type capacity, size_type)
+    {
+        return size_type((static_cast<unsigned __int128>(hash) * capacity)
+                         >> 64);
+    }
+
+    static size_type first_hash(size_type cell, size_type capacity, size_type)
+    {
+        return size_type(((static_cast<unsigned __int128>(cell) << 64)
+                          + capacity - 1) / capacity);
+    }
+
+    static size_type wrap(size_type i, size_type capacity, size_type)
+    { return (i < capacity) ? i : i - capacity; }
+
+private:
+    static size_type round_up(size_type capacity)
+    { return (capacity + granularity - 1) / granularity * granularity; }
+};
+
+}
@@ -50,11 +50,41 @@ public:
     static MarkableElement get_empty()
     { return MarkableElement( 0, 0 ); }
 
+    static MarkableElement get_deleted()
+    { return MarkableElement( BITMASK, 0 ); }
+
+    // cells used while a deleted cell is reused (see
+    // BaseCircular::claim_intern), a reservation counts as deleted, an
+    // aborted reservation is a deleted cell that is not yet reusable
+    static MarkableElement get_reservation(const key_type& k)
+    { return MarkableElement( RESERVED, k ); }
+    static MarkableElement get_aborted(const key_type& k)
+    { return MarkableElement( BITMASK, k ); }
+
+    // an empty cell, that is locked while the cell in front of it is
+    // cleared (see BaseCircular::compact), it looks like a reservation for
+    // key 0 (which cannot be inserted)
+    static MarkableElement get_locked()
+    { return MarkableElement( RESERVED, 0 ); }
+
+    // keys that can be stored, 0 is the empty key, the largest keys mark
+    // deleted cells and reservations (see BaseCircular::rejected)
+    static bool valid_key(const key_type& k) { return k && k < RESERVED; }
+
+    // deleted cells can be reused, since all updates compare the whole cell
+    static constexpr bool reuse_deleted = true;
+    static constexpr bool owns_memory   = false;
+    static constexpr bool markable      = true;
+
     key_type    key;
     mapped_type data;
 
     bool is_empty()   const;
     bool is_deleted() const;
+    bool is_reusable()   const;
+    bool is_reservation(const key_type & k) const;
+    bool is_aborted(const key_type & k) const;
+    bool is_locked()  const;
     bool is_marked()  const;
     bool compare_key(const key_type & k) const;
     bool atomic_mark(MarkableElement& expected);
@@ -100,6 +130,7 @@ private:
 
     static const unsigned long long BITMASK    = (1ull << 63) -1;
     static const unsigned long long MARKED_BIT =  1ull << 63;
+    static const unsigned long long RESERVED   = BITMASK - 1;
 };
 
 
@@ -111,16 +142,22 @@ inline MarkableElement::MarkableElement(const value_type& p) : key(p.first), dat
 
 // Roman used: _mm_loadu_ps Think about using
 // _mm_load_ps because the memory should be aligned
+// copies are read with one (volatile) 16 byte load, otherwise the compiler
+// may split the copy and re-read the cell, e.g. the key of the empty check
+// and the expected value of the following cas could come from different
+// states of the cell
 inline MarkableElement::MarkableElement(const MarkableElement &e)
 {
     //as128i() = (int128_t) _mm_loadu_ps((float *) &e);
-    as128i() = reinterpret_cast<int128_t>(_mm_loadu_si128((__m128i*) &e));
+    as128i() = reinterpret_cast<int128_t>(
+        __m128i(*reinterpret_cast<const volatile __m128i_u*>(&e)));
 }
 
 inline MarkableElement & MarkableElement::operator=(const MarkableElement & e)
 {
     //as128i() = (int128_t) _mm_loadu_ps((float *) &e);
-    as128i() = reinterpret_cast<int128_t>(_mm_loadu_si128((__m128i*) &e));
+    as128i() = reinterpret_cast<int128_t>(
+        __m128i(*reinterpret_cast<const volatile __m128i_u*>(&e)));
     return *this;
 }
 
@@ -136,7 +173,15 @@ inline MarkableElement::MarkableElement(MarkableElement &&e)
 
 
 inline bool MarkableElement::is_empty()   const { return (key & BITMASK) == 0; }
-inline bool MarkableElement::is_deleted() const { return (key & BITMASK) == BITMASK; }
+inline bool MarkableElement::is_deleted() const { return (key & BITMASK) >= RESERVED; }
+inline bool MarkableElement::is_reusable() const
+{ return key == BITMASK && data == 0; }
+inline bool MarkableElement::is_reservation(const key_type & k) const
+{ return (key & BITMASK) == RESERVED && data == k; }
+inline bool MarkableElement::is_aborted(const key_type & k) const
+{ return (key & BITMASK) == BITMASK && data == k; }
+inline bool MarkableElement::is_locked()  const
+{ return (key & BITMASK) == RESERVED && data == 0; }
 inline bool MarkableElement::is_marked()  const { return (key & MARKED_BIT); }
 inline bool MarkableElement::compare_key(const key_type & k) const
 { return (key & BITMASK) == k; }
@@ -169,7 +214,8 @@ inline bool MarkableElement::cas( MarkableElement & expected,
 inline bool MarkableElement::atomic_delete(const MarkableElement & expected)
 {
     auto temp = expected;
-    temp.key = BITMASK;
+    temp.key  = BITMASK;
+    temp.data = 0;
     auto result =__sync_bool_compare_and_swap_16(& as128i(),
                                            expected.as128i(),
                                            temp.as128i());
@@ -0,0 +1,190 @@
+/*******************************************************************************
+ * data-structures/migration_scheduler.h
+ *
+ * MigrationScheduler distributes the blocks of an (aligned) migration.
+ * The block size is chosen per table, depending on its capacity and the
+ * number of hardware threads (each potential helper should get a few
+ * blocks, but claims should not be too frequent). The blocks are split into
+ * ranges, each with its own block counter. Every helper gets a home range,
+ * once it is exhausted, blocks are stolen from other ranges (first from
+ * ranges of the same NUMA node).
+ *
+ * On NUMA systems, the ranges are split between the nodes, and helpers get
+ * home ranges of their own node. Since aligned targets are initialized by
+ * the thread that migrates the corresponding source block (see
+ * BaseCircular::migrate), their pages are first-touched on the same node,
+ * i.e., the ranges of every table stay on their node (as long as the
+ * allocator does not touch the memory beforehand).
+ *
+ * Part of Project growt - https://github.com/TooBiased/growt.git
+ *
+ * Copyright (C) 2015-2016 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+#include <thread>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+namespace growt {
+
+class MigrationScheduler
+{
+public:
+    static constexpr size_t max_ranges        = 64;
+    static constexpr size_t max_nodes         = 8;
+    static constexpr size_t min_block_size    = 512;
+    static constexpr size_t max_block_size    = 1ull << 16;
+    static constexpr size_t blocks_per_helper = 8;
+
+    // chosen once for each table (when it is created)
+    struct Parameters
+    {
+        size_t block_size;
+        size_t n_blocks;
+        size_t n_ranges;
+        size_t n_nodes;
+        size_t n_helpers;     // expected helpers (hardware threads)
+    };
+
+    MigrationScheduler(size_t capacity) { reset(capacity); }
+
+    // only while no migration is running (e.g. when tables are moved)
+    void reset(size_t capacity)
+    {
+        _params = compute_parameters(capacity);
+        _joined.store(0, std::memory_order_relaxed);
+        for (auto& r : _range) r.next.store(0, std::memory_order_relaxed);
+    }
+
+    const Parameters& parameters() const { return _params; }
+
+    // tables created afterwards use this block size (0 = adaptive), e.g.,
+    // to compare with the fixed block size of 4096 (see tests/mig_test.cpp)
+    static std::atomic_size_t& fixed_block_size()
+    {
+        static std::atomic_size_t block_size(0);
+        return block_size;
+    }
+
+    // the number of nodes (read once from sysfs), 1 if the system has only
+    // one node, or its topology is unknown
+    static size_t nodes()
+    {
+        static const size_t n = read_nodes();
+        return n;
+    }
+
+    // the node of the calling thread's current cpu
+    static size_t current_node()
+    {
+        unsigned cpu = 0, node = 0;
+        if (syscall(SYS_getcpu, &cpu, &node, nullptr)) return 0;
+        return node;
+    }
+
+    // returns the home range of a new helper
+    size_t join()
+    {
+        size_t per_node = _params.n_ranges / _params.n_nodes;
+        size_t node     = (_params.n_nodes > 1)
+                          ? current_node() % _params.n_nodes : 0;
+        size_t i = _joined.fetch_add(1, std::memory_order_relaxed);
+        return node * per_node + i % per_node;
+    }
+
+    // returns the first cell of the next block (capacity if all blocks are
+    // claimed), blocks are taken from the home range, then from other
+    // ranges of the same node, and finally from all other ranges
+    size_t claim(size_t home, size_t capacity)
+    {
+        size_t per_node = _params.n_ranges / _params.n_nodes;
+        size_t first    = home - home % per_node;
+
+        for (size_t k = 0; k < per_node; ++k)
+        {
+            size_t temp = claim_from(first + (home - first + k) % per_node);
+            if (temp < _params.n_blocks) return temp * _params.block_size;
+        }
+        for (size_t k = per_node; k < _params.n_ranges; ++k)
+        {
+            size_t temp = claim_from((first + k) % _params.n_ranges);
+            if (temp < _params.n_blocks) return temp * _params.block_size;
+        }
+        return capacity;
+    }
+
+private:
+    struct alignas(64) Range { std::atomic_size_t next; };
+
+    Parameters         _params;
+    std::atomic_size_t _joined;
+    Range              _range[max_ranges];
+
+    // blocks of range r: [begin(r), begin(r+1))
+    size_t range_begin(size_t r) const
+    { return r * _params.n_blocks / _params.n_ranges; }
+
+    size_t claim_from(size_t r)
+    {
+        size_t b = range_begin(r);
+        size_t e = range_begin(r+1);
+        auto&  c = _range[r].next;
+        if (c.load(std::memory_order_relaxed) >= e - b) return _params.n_blocks;
+
+        size_t i = c.fetch_add(1, std::memory_order_acq_rel);
+        return (i < e - b) ? b + i : _params.n_blocks;
+    }
+
+    static Parameters compute_parameters(size_t capacity)
+    {
+        static const size_t hw = std::max<size_t>(
+                                     std::thread::hardware_concurrency(), 1);
+        Parameters p;
+        p.n_helpers  = hw;
+        p.block_size = fixed_block_size().load(std::memory_order_relaxed);
+        if (! p.block_size)
+        {
+            size_t target = capacity / (hw * blocks_per_helper);
+            p.block_size  = max_block_size;
+            while (p.block_size > target && p.block_size > min_block_size)
+                p.block_size >>= 1;
+        }
+        p.block_size = std::max<size_t>(std::min(p.block_size, capacity), 1);
+        p.n_blocks   = (capacity + p.block_size - 1) / p.block_size;
+
+        p.n_ranges   = std::min(std::max(hw, nodes()), max_ranges);
+        p.n_ranges   = std::max<size_t>(std::min(p.n_ranges, p.n_blocks), 1);
+        p.n_nodes    = std::min(nodes(), p.n_ranges);
+        p.n_ranges  -= p.n_ranges % p.n_nodes;
+        return p;
+    }
+
+    static size_t read_nodes()
+    {
+        // e.g. "0-3" or "0,2-3", the highest listed node counts
+        auto file = std::fopen("/sys/devices/system/node/online", "r");
+        if (! file) return 1;
+
+        size_t max = 0, curr = 0;
+        int    c;
+        while ((c = std::fgetc(file)) != EOF)
+        {
+            if (std::isdigit(c)) { curr = curr * 10 + (c - '0'); continue; }
+            max  = std::max(max, curr);
+            curr = 0;
+        }
+        max = std::max(max, curr);
+        std::fclose(file);
+        return std::min(max + 1, max_nodes);
+    }
+};
+
+}
@@ -0,0 +1,89 @@
+/*******************************************************************************
+ * data-structures/occupancy_summary.h
+ *
+ * Occupancy policies for our tables (template parameter Occupancy of
+ * BaseCircular). A summary has one bit per group of 64 cells, the bit is
+ * set once an element is written into the group (relaxed atomics, writers
+ * only write to the summary if the bit is not set yet). Bits are never
+ * cleared, i.e., groups with a cleared bit are empty, groups with a set bit
+ * can be empty (e.g. after deletions, such groups disappear with the next
+ * migration). Iterators, scans, and migrations skip empty groups.
+ *   NoOccupancy      - no summary (default, compiled away completely)
+ *   OccupancySummary - one bit per group (capacity/512 bytes)
+ *
+ * Part of Project growt - https://github.com/TooBiased/growt.git
+ *
+ * Copyright (C) 2015-2016 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <stdlib.h>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+
+namespace growt {
+
+class OccupancySummary
+{
+public:
+    static constexpr bool   enabled    = true;
+    static constexpr size_t group_size = 64;
+    static constexpr size_t word_cells = group_size * 64;
+
+    OccupancySummary(size_t capacity = 0)
+        : _words(new std::atomic<uint64_t>[(capacity + word_cells - 1)
+                                           / word_cells]()) { }
+
+    // called after an element was written into cell i
+    void set(size_t i)
+    {
+        auto&    word = _words[i / word_cells];
+        uint64_t bit  = uint64_t(1) << (i / group_size % 64);
+        if (! (word.load(std::memory_order_relaxed) & bit))
+            word.fetch_or(bit, std::memory_order_relaxed);
+    }
+
+    // the first cell >= i, whose group can contain elements (or e), whole
+    // words (4096 cells) are skipped at once
+    size_t next(size_t i, size_t e) const
+    {
+        while (i < e)
+        {
+            uint64_t bits = _words[i / word_cells].load(
+                                std::memory_order_relaxed)
+                            >> (i / group_size % 64);
+            if (bits & 1) return i;
+            if (bits)
+                return std::min(e, (i / group_size + __builtin_ctzll(bits))
+                                   * group_size);
+            i = (i / word_cells + 1) * word_cells;
+        }
+        return e;
+    }
+
+    // summary used by iterators (nullptr without summary)
+    const OccupancySummary* summary() const { return this; }
+
+private:
+    std::unique_ptr<std::atomic<uint64_t>[]> _words;
+};
+
+class NoOccupancy
+{
+public:
+    static constexpr bool enabled = false;
+
+    NoOccupancy(size_t = 0) { }
+
+    void   set(size_t) { }
+    size_t next(size_t i, size_t) const { return i; }
+
+    const OccupancySummary* summary() const { return nullptr; }
+};
+
+}
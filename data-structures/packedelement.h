@@ -0,0 +1,167 @@
+/*******************************************************************************
+ * data-structures/packedelement.h
+ *
+ * PackedElements represent the cells of a table with small keys and data,
+ * both are packed into one 8 byte word (KeyBits + DataBits = 64). All
+ * changes are 64 bit CAS operations (no cmpxchg16b), and twice as many
+ * cells fit into each cache line. The highest key bit is used to mark
+ * copied cells (used in uaGrow and paGrow), i.e., keys are smaller than
+ * 2^(KeyBits-1)-1 (0 is the empty key, the largest one marks deleted cells)
+ * and data is stored modulo 2^DataBits (e.g. wrapping counters). Other keys
+ * are rejected by the tables (see BaseCircular::rejected).
+ *   PackedElement<32,32> - 31 bit keys with 32 bit data
+ *   PackedElement<64, 0> - 63 bit keys without data (get_data() == 0)
+ *
+ * Part of Project growt - https://github.com/TooBiased/growt.git
+ *
+ * Copyright (C) 2015-2016 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <stdlib.h>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+#include "data-structures/returnelement.h"
+
+namespace growt {
+
+template <size_t KeyBits, size_t DataBits>
+class PackedElement
+{
+    static_assert(KeyBits + DataBits == 64 && KeyBits > 1,
+                  "PackedElement needs KeyBits + DataBits == 64!");
+
+public:
+    using key_type    = uint64_t;
+    using mapped_type = uint64_t;
+    using value_type  = std::pair<const key_type, mapped_type>;
+
+    PackedElement() = default;
+    PackedElement(const key_type& k, const mapped_type& d)
+        : word(((k & KEY_MASK) << DataBits) | (d & DATA_MASK))
+    { assert(k <= KEY_MASK && "key does not fit into the packed element"); }
+    PackedElement(const value_type& p)
+        : PackedElement(p.first, p.second) { }
+
+    static PackedElement get_empty()
+    { return PackedElement( 0, 0 ); }
+
+    static PackedElement get_deleted()
+    { return PackedElement( KEY_MASK, 0 ); }
+
+    // keys that can be stored (0 is the empty key, KEY_MASK the deleted one)
+    static bool valid_key(const key_type& k) { return k && k < KEY_MASK; }
+
+    // updates compare the whole word, but a reused cell could not hold the
+    // reservation of a full key (see MarkableElement), thus, no reuse
+    static constexpr bool reuse_deleted = false;
+    static constexpr bool owns_memory   = false;
+    static constexpr bool markable      = true;
+
+    uint64_t word;
+
+    bool is_empty()   const { return key_bits() == 0; }
+    bool is_deleted() const { return key_bits() == KEY_MASK; }
+    bool is_marked()  const { return word & MARKED_BIT; }
+    bool compare_key(const key_type & k) const { return key_bits() == k; }
+    bool atomic_mark(PackedElement& expected);
+    key_type    get_key()  const
+    { return (is_deleted()) ? 0 : key_bits(); }
+    mapped_type get_data() const { return word & DATA_MASK; }
+    bool set_data(const mapped_type);
+
+    bool cas(      PackedElement & expected,
+             const PackedElement & desired);
+
+    bool atomic_delete(const PackedElement & expected);
+
+    template<class F, class ...Types>
+    std::pair<mapped_type, bool> atomic_update(   PackedElement & expected,
+                         F f, Types&& ... args);
+    template<class F, class ...Types>
+    std::pair<mapped_type, bool> non_atomic_update(F f, Types&& ... args);
+
+    inline bool operator==(PackedElement& r) { return (key_bits() == r.key_bits()); }
+    inline bool operator!=(PackedElement& r) { return (key_bits() != r.key_bits()); }
+
+    inline ReturnElement get_return() const
+    {  return ReturnElement(get_key(), get_data());  }
+
+    inline operator ReturnElement()
+    {  return ReturnElement(get_key(), get_data());  }
+
+    inline operator value_type() const
+    {  return std::make_pair(get_key(), get_data()); }
+
+private:
+    uint64_t key_bits() const { return (word >> DataBits) & KEY_MASK; }
+
+    // the mark is the highest key bit, i.e., the highest bit of the word
+    static const uint64_t MARKED_BIT = 1ull << 63;
+    static const uint64_t KEY_MASK   = ~0ull >> (DataBits + 1);
+    static const uint64_t DATA_MASK  = (DataBits) ? ~0ull >> KeyBits : 0;
+};
+
+
+
+
+template <size_t KB, size_t DB>
+inline bool PackedElement<KB,DB>::set_data(const mapped_type d)
+{
+    PackedElement temp = *this;
+    if (temp.is_marked()) return false;
+    return cas(temp, PackedElement(temp.key_bits(), d));
+}
+
+template <size_t KB, size_t DB>
+inline bool PackedElement<KB,DB>::atomic_mark(PackedElement& expected)
+{
+    return __sync_bool_compare_and_swap(&word, expected.word,
+                                        expected.word | MARKED_BIT);
+}
+
+template <size_t KB, size_t DB>
+inline bool PackedElement<KB,DB>::cas( PackedElement & expected,
+                                 const PackedElement & desired)
+{
+    return __sync_bool_compare_and_swap(&word, expected.word, desired.word);
+}
+
+template <size_t KB, size_t DB>
+inline bool PackedElement<KB,DB>::atomic_delete(const PackedElement & expected)
+{
+    return __sync_bool_compare_and_swap(&word, expected.word,
+                                        get_deleted().word);
+}
+
+
+
+
+template <size_t KB, size_t DB> template<class F, class ...Types>
+inline std::pair<typename PackedElement<KB,DB>::mapped_type, bool>
+PackedElement<KB,DB>::atomic_update(PackedElement &exp,
+                                    F f, Types&& ... args)
+{
+    auto temp = exp.get_data();
+    f(temp, std::forward<Types>(args)...);
+    PackedElement desired(exp.key_bits(), temp);
+    return std::make_pair(desired.get_data(), cas(exp, desired));
+}
+
+template <size_t KB, size_t DB> template<class F, class ...Types>
+inline std::pair<typename PackedElement<KB,DB>::mapped_type, bool>
+PackedElement<KB,DB>::non_atomic_update(F f, Types&& ... args)
+{
+    auto temp = get_data();
+    f(temp, std::forward<Types>(args)...);
+    *this = PackedElement(key_bits(), temp);
+    return std::make_pair(get_data(), true);
+}
+
+}
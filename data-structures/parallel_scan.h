@@ -0,0 +1,94 @@
+/*******************************************************************************
+ * data-structures/parallel_scan.h
+ *
+ * parallel_for_each and parallel_reduce visit all elements of a table with
+ * the given number of threads. The cells are split into blocks (chosen by
+ * capacity, distributed with work stealing by a MigrationScheduler, see
+ * migration_scheduler.h). A block contains the elements whose home cell is
+ * in its range, i.e., clusters that cross its end belong to it.
+ *
+ * The blocks are pinned to the capacity of the table when the scan starts.
+ * Each block is visited within one table access (see execute), thus,
+ * migrations can only finish between blocks. If a block finds a newer table,
+ * it is visited in that table (its elements are selected by hash, see
+ * BaseCircular::for_each_home). Elements that exist throughout the scan are
+ * visited exactly once. Concurrent migrations (EStratAsync) only mark cells
+ * during a block, marked cells keep their (copied) values.
+ *
+ * f must not change the table, sync strategies cannot grow the table while
+ * it is accessed.
+ *
+ * Part of Project growt - https://github.com/TooBiased/growt.git
+ *
+ * Copyright (C) 2015-2016 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "data-structures/migration_scheduler.h"
+
+namespace growt {
+
+// handle_factory() creates the handle of each thread, e.g.,
+// [&table]() { return table.get_handle(); }, non-growing tables are their
+// own handle ([&table]() -> auto& { return table; })
+//
+// returns the combination of identity and f(key, data) for all elements,
+// the partial results of threads are combined in order of their ids
+template <class HandleFactory, class T, class F, class Combine>
+T parallel_reduce(HandleFactory handle_factory, T identity, F f,
+                  Combine combine, size_t threads)
+{
+    threads = std::max<size_t>(threads, 1);
+
+    size_t cap = 0;
+    {
+        decltype(auto) handle = handle_factory();
+        cap = handle.capacity();
+    }
+    MigrationScheduler blocks(cap);
+    const size_t block_size = blocks.parameters().block_size;
+
+    std::vector<T> partial(threads, identity);
+    auto scan = [&](size_t id)
+    {
+        decltype(auto) handle = handle_factory();
+        size_t home  = blocks.join();
+        T      local = identity;
+        for (size_t s = blocks.claim(home, cap); s < cap;
+             s = blocks.claim(home, cap))
+        {
+            handle.for_each_home(cap, s, std::min(s + block_size, cap),
+                                 [&](const auto& k, const auto& d)
+                                 { local = combine(std::move(local), f(k, d)); });
+        }
+        partial[id] = std::move(local);
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < threads; ++t) workers.emplace_back(scan, t);
+    scan(0);
+    for (auto& w : workers) w.join();
+
+    T result = std::move(identity);
+    for (auto& p : partial) result = combine(std::move(result), std::move(p));
+    return result;
+}
+
+// calls f(key, data) for all elements (see parallel_reduce)
+template <class HandleFactory, class F>
+void parallel_for_each(HandleFactory handle_factory, F f, size_t threads)
+{
+    parallel_reduce(handle_factory, 0,
+                    [&f](const auto& k, const auto& d) { f(k, d); return 0; },
+                    [](int, int) { return 0; }, threads);
+}
+
+}
@@ -0,0 +1,264 @@
+/*******************************************************************************
+ * data-structures/probe_kernel.h
+ *
+ * ProbeKernels scan a whole cache line of table cells at once. They find the
+ * first cell (of the line) that can end a probe for a key k, i.e., a cell
+ * holding k, an empty cell, or a marked cell. Which instruction set is used
+ * is decided at compile time (AVX-512 > AVX2 > scalar), the scalar version
+ * does not skip any cells (every cell is probed individually).
+ *
+ * Part of Project growt - https://github.com/TooBiased/growt.git
+ *
+ * Copyright (C) 2015-2016 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#ifndef PROBE_KERNEL_H
+#define PROBE_KERNEL_H
+
+#include <stdlib.h>
+#include <cstdint>
+
+#if (defined(__AVX512F__) || defined(__AVX2__)) && !defined(GROWT_PROBE_SCALAR)
+#include <immintrin.h>
+#elif defined(__SSE2__) && !defined(GROWT_PROBE_SCALAR)
+#include <emmintrin.h>
+#endif
+
+namespace growt {
+
+class SimpleElement;
+class MarkableElement;
+
+// describes how the key word (first 8 bytes of a 16 byte cell) is interpreted
+// elements without specialization are always probed one cell at a time
+template <class E>
+struct probe_traits
+{
+    static constexpr bool     vectorizable = false;
+    static constexpr uint64_t key_mask     = ~0ull;
+    static constexpr uint64_t marked_bit   = 0ull;
+};
+
+template <>
+struct probe_traits<SimpleElement>
+{
+    static constexpr bool     vectorizable = true;
+    static constexpr uint64_t key_mask     = ~0ull;
+    static constexpr uint64_t marked_bit   = 0ull;
+};
+
+template <>
+struct probe_traits<MarkableElement>
+{
+    static constexpr bool     vectorizable = true;
+    static constexpr uint64_t key_mask     = (1ull << 63) -1;
+    static constexpr uint64_t marked_bit   =  1ull << 63;
+};
+
+
+
+#if   defined(__AVX512F__) && !defined(GROWT_PROBE_SCALAR)
+#define GROWT_PROBE_ISA "avx512"
+#elif defined(__AVX2__)    && !defined(GROWT_PROBE_SCALAR)
+#define GROWT_PROBE_ISA "avx2"
+#else
+#define GROWT_PROBE_ISA "scalar"
+#endif
+
+template <class E, bool = probe_traits<E>::vectorizable && sizeof(E) == 16>
+class ProbeKernel
+{
+public:
+    static constexpr bool   vectorized = false;
+    static constexpr size_t line_size  = 1;
+
+    // scalar fallback: every cell has to be looked at individually
+    // (keys need not be 64 bit words, e.g. StringElement)
+    template <class K>
+    static inline size_t first(const E*, size_t lane, const K&)
+    { return lane; }
+};
+
+#if (defined(__AVX512F__) || defined(__AVX2__)) && !defined(GROWT_PROBE_SCALAR)
+template <class E>
+class ProbeKernel<E, true>
+{
+    using traits = probe_traits<E>;
+public:
+    static constexpr bool   vectorized = true;
+    static constexpr size_t line_size  = 4;      // 64 byte = 4 cells
+
+    // returns the first lane >= lane of line (4 cells) that holds the key k,
+    // or is empty/marked; returns line_size if there is no such lane
+    // (only the key words are read, they are 8 byte aligned => atomic)
+    static inline size_t first(const E* line, size_t lane, uint64_t k)
+    {
+        uint32_t mask = match(line, k) & (~0u << lane);
+        return (mask) ? size_t(__builtin_ctz(mask)) : line_size;
+    }
+
+private:
+#if defined(__AVX512F__)
+    static inline uint32_t match(const E* line, uint64_t k)
+    {
+        // keys are stored in the even 64bit lanes (k0 d0 k1 d1 ...)
+        const __mmask8 keys = 0x55;
+        __m512i cells = _mm512_loadu_si512(reinterpret_cast<const void*>(line));
+        __m512i masked = _mm512_and_si512(cells,
+                             _mm512_set1_epi64(int64_t(traits::key_mask)));
+        __mmask8 m =
+            _mm512_mask_cmpeq_epi64_mask(keys, masked,
+                                         _mm512_set1_epi64(int64_t(k)))
+          | _mm512_mask_cmpeq_epi64_mask(keys, masked, _mm512_setzero_si512())
+          | _mm512_mask_test_epi64_mask (keys, cells,
+                             _mm512_set1_epi64(int64_t(traits::marked_bit)));
+        // compress the even bits (one bit per cell)
+        uint32_t r = m;
+        return ( r       & 1u) | ((r >> 1) & 2u)
+             | ((r >> 2) & 4u) | ((r >> 3) & 8u);
+    }
+#else
+    static inline uint32_t match(const E* line, uint64_t k)
+    {
+        auto p = reinterpret_cast<const __m256i*>(line);
+        __m256i a = _mm256_loadu_si256(p);       // k0 d0 k1 d1
+        __m256i b = _mm256_loadu_si256(p+1);     // k2 d2 k3 d3
+        // k0 k2 k1 k3 -> k0 k1 k2 k3
+        __m256i cells  = _mm256_permute4x64_epi64(_mm256_unpacklo_epi64(a, b),
+                                                  0xd8);
+        __m256i masked = _mm256_and_si256(cells,
+                             _mm256_set1_epi64x(int64_t(traits::key_mask)));
+        __m256i m = _mm256_or_si256(
+            _mm256_or_si256(
+                _mm256_cmpeq_epi64(masked, _mm256_set1_epi64x(int64_t(k))),
+                _mm256_cmpeq_epi64(masked, _mm256_setzero_si256())),
+            _mm256_and_si256(cells,
+                             _mm256_set1_epi64x(int64_t(traits::marked_bit))));
+        // the sign bit of each 64bit lane is set iff the cell matched
+        return uint32_t(_mm256_movemask_pd(_mm256_castsi256_pd(m)));
+    }
+#endif
+};
+#endif
+
+
+
+// probes a line of 8 densely stored key words (see soaelement.h)
+// returns the first lane >= lane, whose key word (masked with key_mask) is
+// empty or equal to k, returns line_size if there is no such lane
+class KeyLineKernel
+{
+public:
+    static constexpr size_t line_size = 8;       // 64 byte = 8 keys
+
+#if (defined(__AVX512F__) || defined(__AVX2__)) && !defined(GROWT_PROBE_SCALAR)
+    static inline size_t first(const uint64_t* keys, size_t lane,
+                               uint64_t k, uint64_t key_mask)
+    {
+        uint32_t mask = match(keys, k, key_mask) & (~0u << lane);
+        return (mask) ? size_t(__builtin_ctz(mask)) : line_size;
+    }
+
+private:
+#if defined(__AVX512F__)
+    static inline uint32_t match(const uint64_t* keys, uint64_t k,
+                                 uint64_t key_mask)
+    {
+        __m512i masked = _mm512_and_si512(
+            _mm512_loadu_si512(reinterpret_cast<const void*>(keys)),
+            _mm512_set1_epi64(int64_t(key_mask)));
+        return _mm512_cmpeq_epi64_mask(masked, _mm512_set1_epi64(int64_t(k)))
+             | _mm512_cmpeq_epi64_mask(masked, _mm512_setzero_si512());
+    }
+#else
+    static inline uint32_t match(const uint64_t* keys, uint64_t k,
+                                 uint64_t key_mask)
+    {
+        auto p = reinterpret_cast<const __m256i*>(keys);
+        return  match4(_mm256_loadu_si256(p  ), k, key_mask)
+             | (match4(_mm256_loadu_si256(p+1), k, key_mask) << 4);
+    }
+
+    static inline uint32_t match4(__m256i words, uint64_t k, uint64_t key_mask)
+    {
+        __m256i masked = _mm256_and_si256(words,
+                             _mm256_set1_epi64x(int64_t(key_mask)));
+        __m256i m = _mm256_or_si256(
+            _mm256_cmpeq_epi64(masked, _mm256_set1_epi64x(int64_t(k))),
+            _mm256_cmpeq_epi64(masked, _mm256_setzero_si256()));
+        return uint32_t(_mm256_movemask_pd(_mm256_castsi256_pd(m)));
+    }
+#endif
+#else
+    // scalar fallback: the key words are dense, so a simple loop suffices
+    static inline size_t first(const uint64_t* keys, size_t lane,
+                               uint64_t k, uint64_t key_mask)
+    {
+        for (; lane < line_size; ++lane)
+        {
+            uint64_t w = __atomic_load_n(&keys[lane], __ATOMIC_RELAXED) & key_mask;
+            if (w == k || w == 0) return lane;
+        }
+        return line_size;
+    }
+#endif
+};
+
+
+
+// probes a group of control bytes (see tag_circular.h)
+// returns a bitmask of all bytes that are empty (0) or equal to tag
+class TagGroupKernel
+{
+public:
+#if   defined(__AVX512BW__) && !defined(GROWT_PROBE_SCALAR)
+    static constexpr size_t group_size = 64;
+
+    static inline uint64_t match(const uint8_t* group, uint8_t tag)
+    {
+        __m512i g = _mm512_loadu_si512(reinterpret_cast<const void*>(group));
+        return _mm512_cmpeq_epi8_mask(g, _mm512_set1_epi8(char(tag)))
+             | _mm512_cmpeq_epi8_mask(g, _mm512_setzero_si512());
+    }
+#elif defined(__AVX2__)   && !defined(GROWT_PROBE_SCALAR)
+    static constexpr size_t group_size = 32;
+
+    static inline uint64_t match(const uint8_t* group, uint8_t tag)
+    {
+        __m256i g = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(group));
+        __m256i m = _mm256_or_si256(
+            _mm256_cmpeq_epi8(g, _mm256_set1_epi8(char(tag))),
+            _mm256_cmpeq_epi8(g, _mm256_setzero_si256()));
+        return uint32_t(_mm256_movemask_epi8(m));
+    }
+#elif defined(__SSE2__)   && !defined(GROWT_PROBE_SCALAR)
+    static constexpr size_t group_size = 16;
+
+    static inline uint64_t match(const uint8_t* group, uint8_t tag)
+    {
+        __m128i g = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+        __m128i m = _mm_or_si128(_mm_cmpeq_epi8(g, _mm_set1_epi8(char(tag))),
+                                 _mm_cmpeq_epi8(g, _mm_setzero_si128()));
+        return uint32_t(_mm_movemask_epi8(m));
+    }
+#else
+    static constexpr size_t group_size = 16;
+
+    static inline uint64_t match(const uint8_t* group, uint8_t tag)
+    {
+        uint64_t m = 0;
+        for (size_t j = 0; j < group_size; ++j)
+        {
+            uint8_t g = __atomic_load_n(&group[j], __ATOMIC_RELAXED);
+            if (g == tag || g == 0) m |= 1ull << j;
+        }
+        return m;
+    }
+#endif
+};
+
+}
+
+#endif // PROBE_KERNEL_H
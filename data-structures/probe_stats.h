@@ -0,0 +1,209 @@
+/*******************************************************************************
+ * data-structures/probe_stats.h
+ *
+ * Instrumentation policies for our tables (template parameter Stats of
+ * BaseCircular). They record probe distances (#cells between the home cell
+ * and the cell that ended the probe) of insertions, successful finds, and
+ * unsuccessful finds.
+ *   NoProbeStats - records nothing (default, compiled away completely)
+ *   ProbeStats   - records into fixed-bucket histograms, every thread
+ *                  writes into its own slot, slots are merged on demand
+ *
+ * Part of Project growt - https://github.com/TooBiased/growt.git
+ *
+ * Copyright (C) 2015-2016 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <stdlib.h>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <ostream>
+
+namespace growt {
+
+// distances below 16 have their own bucket, larger distances are grouped
+// by their logarithm ([16,32), [32,64), ...), the last bucket is open
+class ProbeHistogram
+{
+public:
+    static constexpr size_t num_buckets = 32;
+    static constexpr size_t num_linear  = 16;
+
+    static size_t bucket(size_t d)
+    {
+        if (d < num_linear) return d;
+        size_t b = num_linear + (63 - __builtin_clzll(d)) - 4;
+        return (b < num_buckets) ? b : num_buckets-1;
+    }
+
+    // smallest distance that falls into bucket b
+    static size_t bucket_begin(size_t b)
+    { return (b < num_linear) ? b : size_t(1) << (b - num_linear + 4); }
+
+    ProbeHistogram() : _buckets(), _sum(0), _max(0) { }
+
+    uint64_t count() const
+    {
+        uint64_t c = 0;
+        for (size_t b = 0; b < num_buckets; ++b) c += _buckets[b];
+        return c;
+    }
+    uint64_t operator[](size_t b) const { return _buckets[b]; }
+    uint64_t sum()                const { return _sum; }
+    uint64_t max()                const { return _max; }
+    double   average()            const
+    {
+        auto c = count();
+        return (c) ? double(_sum)/double(c) : 0.;
+    }
+
+    // lower bound of the q-quantile (the first distance of its bucket)
+    size_t quantile(double q) const
+    {
+        uint64_t c = count();
+        uint64_t r = 0;
+        for (size_t b = 0; b < num_buckets; ++b)
+        {
+            r += _buckets[b];
+            if (r && double(r) >= q*double(c)) return bucket_begin(b);
+        }
+        return 0;
+    }
+
+    ProbeHistogram& operator+=(const ProbeHistogram& rhs)
+    {
+        for (size_t b = 0; b < num_buckets; ++b) _buckets[b] += rhs._buckets[b];
+        _sum += rhs._sum;
+        _max  = (rhs._max > _max) ? rhs._max : _max;
+        return *this;
+    }
+
+    // concurrent recording/merging, there is usually only one writer per
+    // histogram (see ProbeStats), relaxed atomics are used nevertheless
+    void add_atomic(size_t d)
+    {
+        __atomic_fetch_add(&_buckets[bucket(d)], 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&_sum, d, __ATOMIC_RELAXED);
+        uint64_t m = __atomic_load_n(&_max, __ATOMIC_RELAXED);
+        while (d > m && ! __atomic_compare_exchange_n(&_max, &m, d, true,
+                                                      __ATOMIC_RELAXED,
+                                                      __ATOMIC_RELAXED)) { }
+    }
+
+    void merge_atomic(const ProbeHistogram& rhs)
+    {
+        for (size_t b = 0; b < num_buckets; ++b)
+            _buckets[b] += __atomic_load_n(&rhs._buckets[b], __ATOMIC_RELAXED);
+        _sum += __atomic_load_n(&rhs._sum, __ATOMIC_RELAXED);
+        uint64_t m = __atomic_load_n(&rhs._max, __ATOMIC_RELAXED);
+        _max  = (m > _max) ? m : _max;
+    }
+
+private:
+    uint64_t _buckets[num_buckets];
+    uint64_t _sum;
+    uint64_t _max;
+};
+
+
+
+// one histogram per operation type
+struct ProbeStatistics
+{
+    ProbeHistogram insert;
+    ProbeHistogram hit;                  // successful finds
+    ProbeHistogram miss;                 // unsuccessful finds
+
+    ProbeStatistics& operator+=(const ProbeStatistics& rhs)
+    {
+        insert += rhs.insert;
+        hit    += rhs.hit;
+        miss   += rhs.miss;
+        return *this;
+    }
+};
+
+inline std::ostream& operator<<(std::ostream& out, const ProbeHistogram& hist)
+{
+    return out << "n "      << hist.count()
+               << " avg "   << hist.average()
+               << " p50 "   << hist.quantile(0.5)
+               << " p99 "   << hist.quantile(0.99)
+               << " max "   << hist.max();
+}
+
+inline std::ostream& operator<<(std::ostream& out, const ProbeStatistics& stats)
+{
+    return out << "insert: " << stats.insert << "\n"
+               << "hit:    " << stats.hit    << "\n"
+               << "miss:   " << stats.miss   << "\n";
+}
+
+
+
+class NoProbeStats
+{
+public:
+    static constexpr bool enabled = false;
+
+    void insert(size_t) const { }
+    void hit   (size_t) const { }
+    void miss  (size_t) const { }
+
+    void share(const NoProbeStats&) { }
+    ProbeStatistics merge() const { return ProbeStatistics(); }
+};
+
+
+
+// every thread gets a number on its first recording, it writes into the slot
+// with this number (mod num_slots), thus recording is lock-free and usually
+// without contention, the slots are shared by all tables of one growing
+// table (see share(...) and BaseCircular::migrate)
+class ProbeStats
+{
+public:
+    static constexpr bool   enabled   = true;
+    static constexpr size_t num_slots = 64;
+
+    ProbeStats() : _slots(new Slot[num_slots]) { }
+
+    void insert(size_t d) const { local().insert.add_atomic(d); }
+    void hit   (size_t d) const { local().hit   .add_atomic(d); }
+    void miss  (size_t d) const { local().miss  .add_atomic(d); }
+
+    void share(const ProbeStats& source) { _slots = source._slots; }
+
+    ProbeStatistics merge() const
+    {
+        ProbeStatistics result;
+        for (size_t i = 0; i < num_slots; ++i)
+        {
+            result.insert.merge_atomic(_slots[i].insert);
+            result.hit   .merge_atomic(_slots[i].hit);
+            result.miss  .merge_atomic(_slots[i].miss);
+        }
+        return result;
+    }
+
+private:
+    struct alignas(64) Slot : public ProbeStatistics { };
+
+    std::shared_ptr<Slot[]> _slots;
+
+    static size_t thread_number()
+    {
+        static std::atomic_size_t next(0);
+        thread_local size_t id = next.fetch_add(1, std::memory_order_relaxed);
+        return id;
+    }
+
+    Slot& local() const { return _slots[thread_number() & (num_slots-1)]; }
+};
+
+}
@@ -23,12 +23,14 @@ enum class ReturnCode
     // bit pattern:  1 = success ;   2 = not found key ;   4 = found key
     //               8 = insert  ;  16 = update        ;  32 = delete
     //              64 = full    ; 128 = invalid cell  ; 256 = TSX
+    //             512 = reused (a deleted cell was reused)
 
     ERROR                      = 0,
 
     SUCCESS_IN                 = 9,   // success+insert
     SUCCESS_UP                 = 17,  // success+update
     SUCCESS_DEL                = 33,  // success+delete
+    SUCCESS_IN_REUSED          = 521, // success+insert+reused
 
     UNSUCCESS_NOT_FOUND        = 2,
     UNSUCCESS_ALREADY_USED     = 4,
@@ -52,6 +54,11 @@ inline bool successful(ReturnCode ec)
     return (static_cast<uint>(ec) & 1u);
 }
 
+inline bool successful_insert(ReturnCode ec)
+{
+    return (static_cast<uint>(ec) & 9u) == 9u;
+}
+
 
 class ReturnElement
 {
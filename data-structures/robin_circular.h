@@ -0,0 +1,620 @@
+/*******************************************************************************
+ * data-structures/robin_circular.h
+ *
+ * Robin Hood variant of our non growing table. Inserts displace elements that
+ * are closer to their home cell (richer), therefore, each cluster is sorted by
+ * home cell and finds can stop at the first richer element. This keeps the
+ * maximum displacement small and allows higher fill rates.
+ *
+ * Displacing inserts (and inserts into tombstones) lock the affected part of
+ * the table (one lock per lock_block_size cells). They move the elements one
+ * cell to the right back to front. Every element is copied before its
+ * original is replaced, thus, finds, updates, and deletions (scanning from
+ * left to right) need no locks. Inserts at the end of a cluster use one CAS.
+ *
+ * Moved cells cannot be marked, therefore, this table can only be grown
+ * with synchronized growing (EStratSync), where no updates run during the
+ * migration.
+ *
+ * Part of Project growt - https://github.com/TooBiased/growt.git
+ *
+ * Copyright (C) 2015-2016 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <stdlib.h>
+#include <functional>
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include <algorithm>
+
+#include "utils/default_hash.hpp"
+#include "data-structures/base_circular.h"
+
+namespace growt {
+
+template<class E, class HashFct = utils_tm::hash_tm::default_hash,
+         class A = std::allocator<E>>
+class RobinCircular : public BaseCircular<E, HashFct, A>
+{
+private:
+    using This_t          = RobinCircular<E,HashFct,A>;
+    using Base_t          = BaseCircular<E,HashFct,A>;
+
+    template <class> friend class GrowTableHandle;
+    friend Base_t;
+
+public:
+    using value_intern       = E;
+
+    using key_type           = typename Base_t::key_type;
+    using mapped_type        = typename Base_t::mapped_type;
+    using iterator           = typename Base_t::iterator;
+    using const_iterator     = typename Base_t::const_iterator;
+    using size_type          = typename Base_t::size_type;
+    using mapped_reference   = typename Base_t::mapped_reference;
+    using insert_return_type = typename Base_t::insert_return_type;
+
+    using Handle             = This_t&;
+
+    using Base_t::_capacity;
+    using Base_t::end;
+    using Base_t::cend;
+
+    // sorted clusters stay short, even at high fill rates
+    static constexpr double max_fill_factor = 0.85;
+
+    // elements are moved by insertions, deleted cells stay until migration
+    static constexpr bool compactable = false;
+
+    // insertions move elements (see insert_unsafe), ranges of cells cannot
+    // be filled independently
+    static constexpr bool bulk_build = false;
+
+    // migrations into smaller tables are not supported (see
+    // BaseCircular::unaligned_migration), therefore, the table is never
+    // shrunk
+    static constexpr bool unaligned_migration = false;
+
+    static size_type resize(size_type current, size_type inserted,
+                            size_type deleted,
+                            double grow_fill = Base_t::grow_fill_factor,
+                            double = 0.)
+    { return Base_t::resize(current, inserted, deleted, grow_fill); }
+
+protected:
+    using insert_return_intern = typename Base_t::insert_return_intern;
+
+    using Base_t::_t;
+    using Base_t::_bitmask;
+    using Base_t::_hash;
+    using Base_t::h;
+    using Base_t::make_iterator;
+    using Base_t::make_citerator;
+    using Base_t::make_insert_ret;
+    using Base_t::rejected;
+    using Base_t::batch_window;
+    using typename Base_t::probe_kernel;
+
+public:
+    RobinCircular(size_type size_ = 1<<18);
+    RobinCircular(size_type size_, size_type version_);
+
+    RobinCircular(RobinCircular&& rhs)            = default;
+    RobinCircular& operator=(RobinCircular&& rhs) = default;
+
+    Handle get_handle() { return *this; }
+
+    insert_return_type insert(const key_type& k, const mapped_type& d);
+    iterator           find  (const key_type& k);
+    const_iterator     find  (const key_type& k) const;
+
+    insert_return_type insert_or_assign(const key_type& k, const mapped_type& d)
+    { return insert_or_update(k, d, example::Overwrite(), d); }
+
+    mapped_reference operator[](const key_type& k)
+    { return (*(insert(k, mapped_type()).first)).second; }
+
+    template <class F, class ... Types>
+    insert_return_type insert_or_update
+    (const key_type& k, const mapped_type& d, F f, Types&& ... args);
+
+    template <class F, class ... Types>
+    insert_return_type insert_or_update_unsafe
+    (const key_type& k, const mapped_type& d, F f, Types&& ... args);
+
+    size_type          insert_batch(const key_type* keys,
+                                    const mapped_type* data, size_type n);
+    template <class F>
+    size_type          insert_or_update_batch(const key_type* keys,
+                                              const mapped_type* data,
+                                              size_type n, F f);
+
+    // displacing inserts copy elements one cell to the right, while we scan
+    // from left to right, thus, an element can be read in consecutive cells
+    // (see BaseCircular::for_each_home)
+    template <class F>
+    void for_each_home(size_type cap, size_type s, size_type e, F f) const
+    {
+        bool     first = true;
+        key_type last  = key_type();
+        Base_t::for_each_home(cap, s, e,
+                              [&](const key_type& k, const mapped_type& d)
+                              {
+                                  if (! first && k == last) return;
+                                  first = false;
+                                  last  = k;
+                                  f(k, d);
+                              });
+    }
+
+protected:
+    static constexpr size_type lock_block_size = 256;
+    static constexpr size_type npos            = ~size_type(0);
+
+    std::unique_ptr<std::atomic_bool[]> _locks;
+    size_type                           _lock_mask;
+
+    insert_return_intern insert_intern(const key_type& k, const mapped_type& d);
+
+    template <class F, class ... Types>
+    insert_return_intern insert_or_update_intern
+    (const key_type& k, const mapped_type& d, F f, Types&& ... args);
+
+    template <class F, class ... Types>
+    insert_return_intern insert_or_update_unsafe_intern
+    (const key_type& k, const mapped_type& d, F f, Types&& ... args);
+
+    // inserts k (if it is not present), otherwise found(pos, curr, result)
+    // is called, it returns false if the operation has to be repeated
+    template <class Found>
+    insert_return_intern robin_insert(const key_type& k, const mapped_type& d,
+                                      Found found);
+
+    template <bool Update, class F>
+    void batch_intern(const key_type* keys, const mapped_type* data,
+                      const size_type* order, size_type n,
+                      ReturnCode* codes, F f);
+
+    template <bool Update, class F>
+    size_type batch(const key_type* keys, const mapped_type* data,
+                    size_type n, F f);
+
+    // used during the migration (no concurrency)
+    void insert_unsafe(const value_intern& e);
+
+
+
+    // ROBIN HOOD HELPER FUNCTIONS *********************************************
+
+    // displacement of the element e stored at (unmasked) position i
+    inline size_type distance(const value_intern& e, size_type i) const
+    { return (i - h(e.get_key())) & _bitmask; }
+
+    // scans the cluster of k, returns true if k is found at pos. Otherwise,
+    // pos is the first cell that is empty or holds a richer element (k has
+    // to be inserted there), and tomb is the first cell of a run of
+    // tombstones directly in front of pos (or npos)
+    bool locate(const key_type& k, size_type home, size_type& pos,
+                size_type& tomb, value_intern& curr) const;
+
+    // moves the elements in [pos, e) one cell to the right (back to front),
+    // then x is stored at pos. A concurrent update/deletion of a moved
+    // element changes its original, it is carried over into the copy, until
+    // the original is replaced. Returns false if the free cell e was taken.
+    bool shift(size_type pos, size_type e, value_intern free,
+               value_intern x);
+
+    // locks are acquired in ascending order, [first, next) (unmasked lock
+    // ids) is locked, the range is extended until it contains position i
+    inline void lock_upto(size_type& next, size_type i)
+    {
+        for (; next <= i / lock_block_size; ++next)
+        {
+            auto& l = _locks[next & _lock_mask];
+            while (l.exchange(true, std::memory_order_acquire))
+                while (l.load(std::memory_order_relaxed)) { }
+        }
+    }
+
+    inline void unlock(size_type first, size_type next)
+    {
+        for (; first < next; ++first)
+            _locks[first & _lock_mask].store(false, std::memory_order_release);
+    }
+};
+
+
+
+
+
+
+
+
+
+// CONSTRUCTORS/ASSIGNMENTS ****************************************************
+
+template<class E, class HashFct, class A>
+RobinCircular<E,HashFct,A>::RobinCircular(size_type capacity_)
+    : Base_t(capacity_),
+      _locks(new std::atomic_bool[_capacity / lock_block_size]()),
+      _lock_mask(_capacity / lock_block_size - 1)
+{ }
+
+/*should always be called with a capacity_=2^k  */
+template<class E, class HashFct, class A>
+RobinCircular<E,HashFct,A>::RobinCircular(size_type capacity_, size_type version_)
+    : Base_t(capacity_, version_),
+      _locks(new std::atomic_bool[_capacity / lock_block_size]()),
+      _lock_mask(_capacity / lock_block_size - 1)
+{ }
+
+
+
+// ROBIN HOOD HELPER FUNCTIONS *************************************************
+
+template<class E, class HashFct, class A>
+inline bool RobinCircular<E,HashFct,A>::locate(const key_type& k,
+                                               size_type home,
+                                               size_type& pos,
+                                               size_type& tomb,
+                                               value_intern& curr) const
+{
+    tomb = npos;
+    for (pos = home; ; ++pos)
+    {
+        curr = _t[pos & _bitmask];
+        if (curr.is_empty())
+            return false;
+        else if (curr.is_deleted())
+        {
+            if (tomb == npos) tomb = pos;
+            continue;
+        }
+        else if (curr.compare_key(k))
+            return true;
+        else if (distance(curr, pos) < pos - home)
+            return false;
+        tomb = npos;
+    }
+    return false;
+}
+
+template<class E, class HashFct, class A>
+inline bool RobinCircular<E,HashFct,A>::shift(size_type pos, size_type e,
+                                              value_intern free,
+                                              value_intern x)
+{
+    value_intern copy = _t[(e-1) & _bitmask];
+    if (! _t[e & _bitmask].cas(free, copy)) return false;
+
+    for (size_type j = e-1; ; --j)
+    {
+        value_intern repl = (j == pos) ? x : value_intern(_t[(j-1) & _bitmask]);
+        while (! _t[j & _bitmask].cas(copy, repl))
+        {
+            // the original was changed, the copy (at j+1) is only seen
+            // after the original is replaced, therefore, it cannot change
+            value_intern curr = _t[j & _bitmask];
+            _t[(j+1) & _bitmask].cas(copy, curr);
+            copy = curr;
+        }
+        if (j == pos) return true;
+        copy = repl;
+    }
+    return true;
+}
+
+
+
+// MAIN HASH TABLE FUNCTIONALITY (INTERN) **************************************
+
+template<class E, class HashFct, class A> template<class Found>
+inline typename RobinCircular<E,HashFct,A>::insert_return_intern
+RobinCircular<E,HashFct,A>::robin_insert(const key_type& k, const mapped_type& d,
+                                         Found found)
+{
+    if (rejected(k)) return make_insert_ret(end(), ReturnCode::ERROR);
+    const size_type home = h(k);
+    const value_intern x(k,d);
+
+    while (true)
+    {
+        size_type    pos, tomb;
+        value_intern curr;
+        insert_return_intern result = make_insert_ret(end(), ReturnCode::ERROR);
+
+        if (locate(k, home, pos, tomb, curr))
+        {
+            if (found(pos & _bitmask, curr, result)) return result;
+            continue;
+        }
+
+        // k belongs to the end of its cluster (no element has to be moved)
+        if (tomb == npos && curr.is_empty())
+        {
+            if (_t[pos & _bitmask].cas(curr, x))
+                return make_insert_ret(k,d, &_t[pos & _bitmask],
+                                       ReturnCode::SUCCESS_IN);
+            continue;
+        }
+
+        // lock from the insertion point and check again
+        size_type first = ((tomb == npos) ? pos : tomb) / lock_block_size;
+        size_type next  = first;
+        lock_upto(next, first * lock_block_size);
+
+        if (locate(k, home, pos, tomb, curr) ||
+            ((tomb == npos) ? pos : tomb) / lock_block_size < first)
+        {
+            unlock(first, next);
+            continue;
+        }
+
+        size_type ins  = pos;
+        bool      succ = false;
+        if (tomb != npos)
+        {
+            ins  = tomb;
+            value_intern temp = _t[tomb & _bitmask];
+            succ = temp.is_deleted() && _t[tomb & _bitmask].cas(temp, x);
+        }
+        else if (curr.is_empty())
+        {
+            lock_upto(next, pos);
+            succ = _t[pos & _bitmask].cas(curr, x);
+        }
+        else
+        {
+            // find the first free cell behind pos
+            size_type    e = pos+1;
+            value_intern free;
+            for ( ; ; ++e)
+            {
+                lock_upto(next, e);
+                free = _t[e & _bitmask];
+                if (free.is_empty() || free.is_deleted()) break;
+            }
+            succ = shift(pos, e, free, x);
+        }
+        unlock(first, next);
+
+        if (succ)
+            return make_insert_ret(k,d, &_t[ins & _bitmask],
+                                   ReturnCode::SUCCESS_IN);
+    }
+    return make_insert_ret(end(), ReturnCode::UNSUCCESS_FULL);
+}
+
+template<class E, class HashFct, class A>
+inline typename RobinCircular<E,HashFct,A>::insert_return_intern
+RobinCircular<E,HashFct,A>::insert_intern(const key_type& k, const mapped_type& d)
+{
+    return robin_insert(k, d,
+        [this, &k](size_type pos, value_intern& curr, insert_return_intern& r)
+        {
+            r = make_insert_ret(k, curr.get_data(), &_t[pos],
+                                ReturnCode::UNSUCCESS_ALREADY_USED);
+            return true;
+        });
+}
+
+template<class E, class HashFct, class A> template<class F, class ... Types>
+inline typename RobinCircular<E,HashFct,A>::insert_return_intern
+RobinCircular<E,HashFct,A>::insert_or_update_intern(const key_type& k,
+                                                    const mapped_type& d,
+                                                    F f, Types&& ... args)
+{
+    return robin_insert(k, d,
+        [&](size_type pos, value_intern& curr, insert_return_intern& r)
+        {
+            mapped_type data;
+            bool        succ;
+            std::tie(data, succ) = _t[pos].atomic_update(curr, f,
+                                                         std::forward<Types>(args)...);
+            if (succ)
+                r = make_insert_ret(k,data, &_t[pos], ReturnCode::SUCCESS_UP);
+            //somebody changed (or moved) the current element! recheck it
+            return succ;
+        });
+}
+
+// the non atomic update can be lost, if the element is moved concurrently
+template<class E, class HashFct, class A> template<class F, class ... Types>
+inline typename RobinCircular<E,HashFct,A>::insert_return_intern
+RobinCircular<E,HashFct,A>::insert_or_update_unsafe_intern(const key_type& k,
+                                                           const mapped_type& d,
+                                                           F f, Types&& ... args)
+{
+    return robin_insert(k, d,
+        [&](size_type pos, value_intern&, insert_return_intern& r)
+        {
+            mapped_type data = _t[pos].non_atomic_update(f,
+                                   std::forward<Types>(args)...).first;
+            r = make_insert_ret(k,data, &_t[pos], ReturnCode::SUCCESS_UP);
+            return true;
+        });
+}
+
+
+
+// MAIN HASH TABLE FUNCTIONALITY (EXTERN) **************************************
+
+template<class E, class HashFct, class A>
+inline typename RobinCircular<E,HashFct,A>::iterator
+RobinCircular<E,HashFct,A>::find(const key_type& k)
+{
+    constexpr size_type line_size = probe_kernel::line_size;
+
+    size_type home = h(k);
+    for (size_type i = home; ; ++i)
+    {
+        // skips to the next cell holding k (or empty) within the line,
+        // if there is none, only the last cell of the line is checked
+        // (the cluster is sorted, if it is richer, k cannot be behind it)
+        size_type lane = i & (line_size-1);
+        size_type r    = probe_kernel::first(&_t[(i & _bitmask) - lane], lane, k);
+        i += ((r == line_size) ? line_size-1 : r) - lane;
+
+        value_intern curr(_t[i & _bitmask]);
+        if (curr.is_empty())
+            return end();
+        else if (curr.compare_key(k))
+            return make_iterator(k, curr.get_data(), &_t[i & _bitmask]);
+        else if (!curr.is_deleted() && distance(curr, i) < i - home)
+            return end();
+    }
+    return end();
+}
+
+template<class E, class HashFct, class A>
+inline typename RobinCircular<E,HashFct,A>::const_iterator
+RobinCircular<E,HashFct,A>::find(const key_type& k) const
+{
+    constexpr size_type line_size = probe_kernel::line_size;
+
+    size_type home = h(k);
+    for (size_type i = home; ; ++i)
+    {
+        // skips to the next cell holding k (or empty) within the line,
+        // if there is none, only the last cell of the line is checked
+        // (the cluster is sorted, if it is richer, k cannot be behind it)
+        size_type lane = i & (line_size-1);
+        size_type r    = probe_kernel::first(&_t[(i & _bitmask) - lane], lane, k);
+        i += ((r == line_size) ? line_size-1 : r) - lane;
+
+        value_intern curr(_t[i & _bitmask]);
+        if (curr.is_empty())
+            return cend();
+        else if (curr.compare_key(k))
+            return make_citerator(k, curr.get_data(), &_t[i & _bitmask]);
+        else if (!curr.is_deleted() && distance(curr, i) < i - home)
+            return cend();
+    }
+    return cend();
+}
+
+template<class E, class HashFct, class A>
+inline typename RobinCircular<E,HashFct,A>::insert_return_type
+RobinCircular<E,HashFct,A>::insert(const key_type& k, const mapped_type& d)
+{
+    iterator   it = end();
+    ReturnCode c  = ReturnCode::ERROR;
+    std::tie(it,c) = insert_intern(k,d);
+    return std::make_pair(it, successful(c));
+}
+
+template<class E, class HashFct, class A> template <class F, class ... Types>
+inline typename RobinCircular<E,HashFct,A>::insert_return_type
+RobinCircular<E,HashFct,A>::insert_or_update(const key_type& k,
+                                             const mapped_type& d,
+                                             F f, Types&& ... args)
+{
+    iterator   it = end();
+    ReturnCode c  = ReturnCode::ERROR;
+    std::tie(it,c) = insert_or_update_intern(k,d,f,
+                                             std::forward<Types>(args)...);
+    return std::make_pair(it, (c == ReturnCode::SUCCESS_IN));
+}
+
+template<class E, class HashFct, class A> template <class F, class ... Types>
+inline typename RobinCircular<E,HashFct,A>::insert_return_type
+RobinCircular<E,HashFct,A>::insert_or_update_unsafe(const key_type& k,
+                                                    const mapped_type& d,
+                                                    F f, Types&& ... args)
+{
+    iterator   it = end();
+    ReturnCode c  = ReturnCode::ERROR;
+    std::tie(it,c) = insert_or_update_unsafe_intern(k,d,f,
+                                                    std::forward<Types>(args)...);
+    return std::make_pair(it, (c == ReturnCode::SUCCESS_IN));
+}
+
+template<class E, class HashFct, class A> template<bool Update, class F>
+inline void
+RobinCircular<E,HashFct,A>::batch_intern(const key_type* keys,
+                                         const mapped_type* data,
+                                         const size_type* order, size_type n,
+                                         ReturnCode* codes, F f)
+{
+    // displacing inserts cannot be interleaved, the home cells of later
+    // elements are prefetched instead
+    for (size_type i = 0; i < n; ++i)
+    {
+        if (i + batch_window < n)
+            this->prefetch(h(keys[order[i+batch_window]]));
+
+        const size_type j = order[i];
+        codes[i] = (Update)
+            ? insert_or_update_intern(keys[j], data[j], f, data[j]).second
+            : insert_intern(keys[j], data[j]).second;
+    }
+}
+
+template<class E, class HashFct, class A>
+inline typename RobinCircular<E,HashFct,A>::size_type
+RobinCircular<E,HashFct,A>::insert_batch(const key_type* keys,
+                                         const mapped_type* data, size_type n)
+{
+    return batch<false>(keys, data, n, example::Overwrite());
+}
+
+template<class E, class HashFct, class A> template <class F>
+inline typename RobinCircular<E,HashFct,A>::size_type
+RobinCircular<E,HashFct,A>::insert_or_update_batch(const key_type* keys,
+                                                   const mapped_type* data,
+                                                   size_type n, F f)
+{
+    return batch<true>(keys, data, n, f);
+}
+
+template<class E, class HashFct, class A> template <bool Update, class F>
+inline typename RobinCircular<E,HashFct,A>::size_type
+RobinCircular<E,HashFct,A>::batch(const key_type* keys, const mapped_type* data,
+                                  size_type n, F f)
+{
+    std::vector<size_type>  order(n);
+    std::vector<ReturnCode> codes(n);
+    this->batch_order(keys, n, order.data());
+    batch_intern<Update>(keys, data, order.data(), n, codes.data(), f);
+    return std::count(codes.begin(), codes.end(), ReturnCode::SUCCESS_IN);
+}
+
+
+
+// MIGRATION/GROWING STUFF *****************************************************
+// BaseCircular::migrate is used, elements are reinserted with swaps
+
+template<class E, class HashFct, class A>
+inline void RobinCircular<E,HashFct,A>::insert_unsafe(const value_intern& e)
+{
+    value_intern x    = e;
+    size_type    home = h(x.get_key());
+
+    for (size_type i = home; ; ++i)
+    {
+        size_type temp = i & _bitmask;
+        value_intern curr(_t[temp]);
+        if (curr.is_empty())
+        {
+            _t[temp] = x;
+            return;
+        }
+
+        size_type dist = distance(curr, i);
+        if (dist < i - home)
+        {
+            _t[temp] = x;
+            x        = curr;
+            home     = i - dist;
+        }
+    }
+    throw std::bad_alloc();
+}
+
+}
@@ -50,6 +50,14 @@ public:
     static SimpleElement get_deleted()
     { return SimpleElement( (1ull<<63)-1ull, 0 ); }
 
+    // updates only change the data word (see TAtomic), a delayed update
+    // could change a reused cell, therefore deleted cells are not reused
+    static constexpr bool reuse_deleted = false;
+    static constexpr bool owns_memory   = false;
+
+    // cells cannot be marked (only synchronized growing, see EStratSync)
+    static constexpr bool markable      = false;
+
     key_type    key;
     mapped_type data;
 
@@ -103,15 +111,21 @@ inline SimpleElement::SimpleElement(const key_type& k, const mapped_type& d)
     : key(k), data(d) { }
 inline SimpleElement::SimpleElement(const value_type& p)
     : key(p.first), data(p.second) { }
+// copies are read with one (volatile) 16 byte load, otherwise the compiler
+// may split the copy and re-read the cell, e.g. the key of the empty check
+// and the expected value of the following cas could come from different
+// states of the cell
 inline SimpleElement::SimpleElement(const SimpleElement &e)
 {
     //as128i() = (int128_t) _mm_loadu_ps((float *) &e);
-    as128i() = reinterpret_cast<int128_t>(_mm_loadu_si128((__m128i*) &e));
+    as128i() = reinterpret_cast<int128_t>(
+        __m128i(*reinterpret_cast<const volatile __m128i_u*>(&e)));
 }
 inline SimpleElement & SimpleElement::operator=(const SimpleElement & e)
 {
     //as128i() = (int128_t) _mm_loadu_ps((float *) &e);
-    as128i() = reinterpret_cast<int128_t>(_mm_loadu_si128((__m128i*) &e));
+    as128i() = reinterpret_cast<int128_t>(
+        __m128i(*reinterpret_cast<const volatile __m128i_u*>(&e)));
     return *this;
 }
 inline SimpleElement::SimpleElement(SimpleElement &&e)
@@ -0,0 +1,198 @@
+/*******************************************************************************
+ * data-structures/soaelement.h
+ *
+ * Cells of our split key/value table (BaseSoA). Cells are grouped into
+ * blocks of 8, the keys of a block fill one cache line, followed by their
+ * data in the next line. Thus, probes only touch dense key lines.
+ * Key and data cannot be changed with one CAS. Therefore, inserting a cell
+ * is done in two steps: the key is claimed with the BUSY_BIT set, then the
+ * data is written and the key is released. Cells cannot be marked, this
+ * layout can only be used with synchronized growing (EStratSync).
+ *
+ * Part of Project growt - https://github.com/TooBiased/growt.git
+ *
+ * Copyright (C) 2015-2016 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#ifndef SOAELEMENT_H
+#define SOAELEMENT_H
+
+#include <stdlib.h>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+#include "data-structures/returnelement.h"
+#include "data-structures/simpleelement.h"
+
+namespace growt {
+
+// 8 cells, their keys fill the first cache line, their data the second
+struct alignas(128) SoABlock
+{
+    static constexpr size_t size = 8;
+
+    uint64_t key [size];
+    uint64_t data[size];
+};
+
+
+
+// copy of one cell (what is read from the table)
+class SoAElement
+{
+public:
+    using key_type    = uint64_t;
+    using mapped_type = uint64_t;
+    using value_type  = std::pair<const key_type, mapped_type>;
+
+    SoAElement() { }
+    SoAElement(const key_type& k, const mapped_type& d) : key(k), data(d) { }
+    SoAElement(const value_type& p) : key(p.first), data(p.second) { }
+
+    static SoAElement get_empty()
+    { return SoAElement( 0, 0 ); }
+
+    key_type    key;
+    mapped_type data;
+
+    bool is_empty()   const { return key == 0; }
+    bool is_deleted() const { return key == BITMASK; }
+    bool is_marked()  const { return false; }
+    bool compare_key(const key_type & k) const { return key == k; }
+    key_type    get_key()  const { return key;  }
+    mapped_type get_data() const { return data; }
+
+    inline operator value_type() const
+    {  return std::make_pair(get_key(), get_data()); }
+
+    static const unsigned long long BITMASK  = (1ull << 63) -1;
+    static const unsigned long long BUSY_BIT =  1ull << 63;
+};
+
+
+
+// references one cell of a block array, it behaves like a pointer to an
+// element (it is used in place of value_intern* in our iterators)
+class SoACell
+{
+public:
+    using key_type    = SoAElement::key_type;
+    using mapped_type = SoAElement::mapped_type;
+
+    constexpr SoACell() : _b(nullptr), _l(0) { }
+    constexpr SoACell(std::nullptr_t) : _b(nullptr), _l(0) { }
+    constexpr SoACell(SoABlock* b, size_t l) : _b(b), _l(l) { }
+
+    // POINTER INTERFACE (USED BY ITERATORS)
+    inline SoACell& operator++()
+    {
+        if (++_l == SoABlock::size) { _l = 0; ++_b; }
+        return *this;
+    }
+    inline bool operator==(const SoACell& r) const
+    { return _b == r._b && _l == r._l; }
+    inline bool operator!=(const SoACell& r) const
+    { return !(*this == r); }
+    inline bool operator< (const SoACell& r) const
+    { return _b < r._b || (_b == r._b && _l < r._l); }
+    inline SoACell*       operator->()       { return this; }
+    inline const SoACell* operator->() const { return this; }
+    inline SoAElement     operator* () const { return load(); }
+
+    // ELEMENT INTERFACE
+    // waits until a concurrent insertion into this cell is finished
+    // the data line is only touched if the cell holds an element
+    SoAElement load() const
+    {
+        key_type k = load_key();
+        while (k & SoAElement::BUSY_BIT) k = load_key();
+        if (k == 0) return SoAElement::get_empty();
+        return SoAElement(k, __atomic_load_n(data_ptr(), __ATOMIC_RELAXED));
+    }
+
+    bool is_empty()   const { return load_key() == 0; }
+    bool is_deleted() const { return load_key() == SoAElement::BITMASK; }
+    key_type    get_key()  const { return load().get_key();  }
+    mapped_type get_data() const { return load().get_data(); }
+
+    // only insertions into empty cells are possible (expected has to be empty)
+    bool cas(const SoAElement& expected, const SoAElement& desired)
+    {
+        key_type exp = expected.key;
+        if (! __atomic_compare_exchange_n(key_ptr(), &exp,
+                                          desired.key | SoAElement::BUSY_BIT,
+                                          false, __ATOMIC_ACQUIRE,
+                                          __ATOMIC_RELAXED))
+            return false;
+        __atomic_store_n(data_ptr(), desired.data, __ATOMIC_RELAXED);
+        __atomic_store_n(key_ptr() , desired.key , __ATOMIC_RELEASE);
+        return true;
+    }
+
+    bool atomic_delete(const SoAElement& expected)
+    {
+        key_type exp = expected.key;
+        return __atomic_compare_exchange_n(key_ptr(), &exp,
+                                           key_type(SoAElement::BITMASK),
+                                           false, __ATOMIC_RELAXED,
+                                           __ATOMIC_RELAXED);
+    }
+
+    // the key is never changed by an update, only the data word
+    template<class F, class ...Types>
+    std::pair<mapped_type, bool> atomic_update(SoAElement& expected,
+                                               F f, Types&& ... args)
+    {
+        return update(std::integral_constant<bool, THasAtomic<F>::value>(),
+                      expected, f, std::forward<Types>(args)...);
+    }
+
+    template<class F, class ...Types>
+    std::pair<mapped_type, bool> non_atomic_update(F f, Types&& ... args)
+    {
+        return std::make_pair(f(*data_ptr(), std::forward<Types>(args)...),
+                              true);
+    }
+
+    // only used while migrating (no concurrent accesses)
+    void set_empty()                        { *key_ptr() = 0; }
+    void set_unsafe(const key_type& k, const mapped_type& d)
+    { *key_ptr() = k; *data_ptr() = d; }
+
+private:
+    SoABlock* _b;
+    size_t    _l;
+
+    key_type*    key_ptr()  const { return &_b->key [_l]; }
+    mapped_type* data_ptr() const { return &_b->data[_l]; }
+    key_type     load_key() const
+    { return __atomic_load_n(key_ptr(), __ATOMIC_ACQUIRE); }
+
+    // USED IF f.atomic(...) EXISTS (see THasAtomic in simpleelement.h)
+    template<class F, class ...Types>
+    std::pair<mapped_type, bool> update(std::true_type, SoAElement&,
+                                        F f, Types&& ... args)
+    {
+        mapped_type temp = f.atomic(*data_ptr(), std::forward<Types>(args)...);
+        return std::make_pair(temp, true);
+    }
+
+    // USED OTHERWISE
+    template<class F, class ...Types>
+    std::pair<mapped_type, bool> update(std::false_type, SoAElement& exp,
+                                        F f, Types&& ... args)
+    {
+        mapped_type td = exp.data;
+        f(td, std::forward<Types>(args)...);
+        bool succ = __sync_bool_compare_and_swap(data_ptr(), exp.data, td);
+        return std::make_pair(td, succ);
+    }
+};
+
+}
+
+#endif // SOAELEMENT_H
@@ -15,9 +15,9 @@
 
 #include <atomic>
 #include <mutex>
-#include <memory>
+#include <limits>
+#include <vector>
 
-#include "data-structures/markableelement.h"
 
 /*******************************************************************************
  *
@@ -32,6 +32,9 @@
  *     - init()
  *     - deinit()
  *     - getTable()   (gets current table and protects it from destruction)
+ *     - getTable(k)  (gets the table that holds the key k, usually the
+ *                     current table, see EStratIncremental)
+ *     - peekTable()  (like getTable(), but only used for size estimates)
  *     - rlsTable()   (stops protecting the table)
  *     - grow()       (creates a new table and initiates a growing step)
  *     - helpGrow()   (called when an operation is unsuccessful,
@@ -45,6 +48,14 @@
  * but not change elements that have already been copied. This has to be
  * ensured through marking copied elements.
  *
+ * Old tables are reclaimed with epochs (table versions). Each handle owns
+ * a slot, in which it announces the version it currently uses (between
+ * get_table() and rls_table(), and during migrate()). Replaced tables are
+ * retired in version order, they are freed once no slot announces their
+ * version (or an older one). Therefore, get_table() only writes its own
+ * slot, and handles that are not inside an operation do not keep old
+ * tables alive.
+ *
  ******************************************************************************/
 
 namespace growt {
@@ -57,32 +68,64 @@ class EStratAsync
 {
 public:
     using BaseTable_t   = typename Parent::BaseTable_t;
-    using HashPtrRef    = std::shared_ptr<BaseTable_t>&;
-    using HashPtr       = std::shared_ptr<BaseTable_t>;
+    using HashPtrRef    = BaseTable_t*;
+    using key_type      = typename BaseTable_t::key_type;
+    using HashPtr       = BaseTable_t*;
 
-    static_assert(std::is_same<typename BaseTable_t::value_intern, MarkableElement>::value,
-                  "Asynchroneous migration can only be chosen with MarkableElement!!!" );
+    using value_intern  = typename BaseTable_t::value_intern;
+    static_assert(value_intern::markable,
+                  "Asynchroneous migration can only be chosen with markable elements (e.g. MarkableElement)!!!" );
 
     class local_data_t;
 
     // STORED AT THE GLOBAL OBJECT
-    //  - SHARED POINTERS TO BOTH THE CURRENT AND THE TARGET TABLE
+    //  - POINTERS TO BOTH THE CURRENT AND THE TARGET TABLE
     //  - VERSION COUNTERS
-    //  - MUTEX FOR SAVE CHANGING OF SHARED POINTERS
+    //  - MUTEX FOR SAVE CHANGING OF THE POINTERS
+    //  - ANNOUNCE SLOTS OF ALL HANDLES AND THE RETIRED TABLES
     class global_data_t
     {
     public:
-        global_data_t(size_t size_) : _g_epoch_r(0), _g_epoch_w(0), _n_helper(0)
+        global_data_t(size_t size_)
+            : _g_epoch_r(0), _g_epoch_w(0), _n_helper(0), _slots(nullptr)
         {
-            _g_table_r = _g_table_w = std::make_shared<BaseTable_t>(size_);
+            _g_table_r = _g_table_w = new BaseTable_t(size_);
         }
         global_data_t(const global_data_t& source) = delete;
         global_data_t& operator=(const global_data_t& source) = delete;
-        ~global_data_t() = default;
+        ~global_data_t()
+        {
+            // retired tables are freed oldest first (see reclaim)
+            for (auto t : _retired) delete t;
+            if (_g_table_w != _g_table_r) delete _g_table_w;
+            delete _g_table_r;
+
+            auto slot = _slots.load();
+            while (slot)
+            {
+                auto temp = slot->next;
+                delete slot;
+                slot = temp;
+            }
+        }
 
     private:
         friend local_data_t;
 
+        static constexpr size_t idle = std::numeric_limits<size_t>::max();
+
+        // prevents false sharing between handle specific slots
+        struct alignas(128) HandleSlot
+        {
+            std::atomic_size_t in_use;
+            std::atomic_size_t table;       // version used by an operation
+            std::atomic_size_t migration;   // version used by migrate()
+            HandleSlot*        next;
+
+            HandleSlot() : in_use(1), table(idle), migration(idle),
+                           next(nullptr) { }
+        };
+
         std::atomic_size_t _g_epoch_r;
         std::atomic_size_t _g_epoch_w;
         HashPtr _g_table_r;
@@ -90,29 +133,97 @@ public:
 
         std::mutex _grow_mutex;
         std::atomic_size_t _n_helper;
-        // return _g_epoch_r.load(std::memory_order_acquire); }
+
+        // slots are reused by later handles, the list only grows
+        std::atomic<HandleSlot*> _slots;
+        // replaced tables (ascending versions), guarded by _grow_mutex
+        std::vector<BaseTable_t*> _retired;
+
+        HandleSlot* register_handle()
+        {
+            for (auto slot = _slots.load(std::memory_order_acquire);
+                 slot; slot = slot->next)
+            {
+                size_t temp = 0;
+                if (! slot->in_use.load(std::memory_order_relaxed) &&
+                    slot->in_use.compare_exchange_strong(temp, 1))
+                    return slot;
+            }
+
+            auto slot  = new HandleSlot();
+            slot->next = _slots.load(std::memory_order_relaxed);
+            while (! _slots.compare_exchange_weak(slot->next, slot)) { }
+            return slot;
+        }
+
+        // has to be called while holding _grow_mutex (after the current
+        // table was replaced), frees all retired tables older than every
+        // announced version, newer tables may still be read by stale handles
+        // (tables are freed oldest first, marked cells can share memory with
+        //  their copies in the successor, see value_intern::owns_memory)
+        void reclaim()
+        {
+            if (_retired.empty()) return;
+
+            size_t min = idle;
+            for (auto slot = _slots.load(); slot; slot = slot->next)
+            {
+                min = std::min(min, slot->table.load());
+                min = std::min(min, slot->migration.load());
+            }
+
+            size_t i = 0;
+            for ( ; i < _retired.size() && _retired[i]->_version < min; ++i)
+                delete _retired[i];
+            _retired.erase(_retired.begin(), _retired.begin() + i);
+        }
     };
 
     // STORED AT EACH HANDLE
-    //  - CACHED TABLE (SHARED PTR) AND VERSION NUMBER
+    //  - CACHED TABLE AND VERSION NUMBER
+    //  - ANNOUNCE SLOT (SEE global_data_t::reclaim)
     //  - CONNECTIONS TO THE  WORKER STRATEGY AND THE GLOBAL TABLE
     class local_data_t
     {
     private:
         using WorkerStratL  = typename Parent::WorkerStrat_t::local_data_t;
+        using HandleSlot    = typename global_data_t::HandleSlot;
     public:
         local_data_t(Parent& parent, WorkerStratL& wstrat)
             : _parent(parent), _global(parent._global_exclusion),
               _worker_strat(wstrat),
-              _epoch(0), _table(nullptr)
+              _epoch(0), _table(nullptr), _slot(_global.register_handle())
         { }
 
         local_data_t(const local_data_t& source) = delete;
         local_data_t& operator=(const local_data_t& source) = delete;
 
-        local_data_t(local_data_t&& source) = default;
-        local_data_t& operator=(local_data_t&& source) = default;
-        ~local_data_t() = default;
+        local_data_t(local_data_t&& source)
+            : _parent(source._parent), _global(source._global),
+              _worker_strat(source._worker_strat),
+              _epoch(source._epoch), _table(source._table),
+              _slot(source._slot)
+        {
+            source._slot = nullptr;
+        }
+
+        local_data_t& operator=(local_data_t&& source)
+        {
+            if (this == &source) return *this;
+
+            this->~local_data_t();
+            new (this) local_data_t(std::move(source));
+            return *this;
+        }
+
+        ~local_data_t()
+        {
+            if (! _slot) return;
+
+            _slot->table.store(global_data_t::idle);
+            _slot->migration.store(global_data_t::idle);
+            _slot->in_use.store(0, std::memory_order_release);
+        }
 
         inline void init() { load(); }
         inline void deinit() { }
@@ -122,36 +233,49 @@ public:
         global_data_t& _global;
         WorkerStratL&  _worker_strat;
 
-        size_t _epoch;
-        std::shared_ptr<BaseTable_t> _table;
+        size_t         _epoch;
+        BaseTable_t*   _table;
+        HandleSlot*    _slot;
 
 
     public:
         inline HashPtrRef get_table()
         {
-            size_t t_epoch = _global._g_epoch_r.load(std::memory_order_acquire);
+            // the announcement has to be visible before the epoch is read
+            // (otherwise, the table could be retired and freed meanwhile)
+            _slot->table.store(_epoch, std::memory_order_seq_cst);
+            size_t t_epoch = _global._g_epoch_r.load(std::memory_order_seq_cst);
             if (t_epoch > _epoch)
             {
                 load();
+                // the old announcement protects the new table until here
+                _slot->table.store(_epoch, std::memory_order_release);
             }
             return _table;
         }
 
-        inline void rls_table() {   }
+        inline void rls_table()
+        {
+            _slot->table.store(global_data_t::idle, std::memory_order_release);
+        }
+
+        // single key operations and size estimates use the current table
+        inline HashPtrRef get_table(const key_type&) { return get_table(); }
+        inline HashPtrRef peek_table()               { return get_table(); }
 
         void grow()
         {
-            //std::shared_ptr<BaseTable_t> w_table;
             { // should be atomic (therefore locked)
                 std::lock_guard<std::mutex> lock(_global._grow_mutex);
-                if (_global._g_table_w->_version == _table->_version)
+                // the table is released, _table can only be used if it is
+                // still the target table
+                if (_global._g_table_w->_version == _epoch)
                 {
                     // first one to get here allocates new table
-                    auto w_table = std::make_shared<BaseTable_t>(
-                       BaseTable_t::resize(_table->_capacity,
-                           _parent._elements.load(std::memory_order_acquire),
-                           _parent._dummies.load(std::memory_order_acquire)),
-                       _table->_version+1);
+                    auto w_table = new BaseTable_t(
+                       _parent.next_capacity(_global._g_table_w->_capacity),
+                       _epoch+1);
+                    w_table->share_stats(*_global._g_table_w);
 
                     _global._g_table_w = w_table;
                     _global._g_epoch_w.store(w_table->_version,
@@ -206,31 +330,32 @@ public:
             _global._n_helper.fetch_add(1, std::memory_order_acq_rel);
 
             // getCurr() and getNext()
+            // (both are protected by the announcement, which is made
+            //  while no table can be retired)
             HashPtr curr, next;
             {
                 std::lock_guard<std::mutex> lock(_global._grow_mutex);
                 curr = _global._g_table_r;
                 next = _global._g_table_w;
+                _slot->migration.store(curr->_version);
             }
+            size_t n_version = next->_version;
 
-            if (curr->_version >= next->_version)
+            if (curr->_version < n_version)
             {
-                // late to the party
-                // leave_migration(): nhelper --
-                _global._n_helper.fetch_sub(1, std::memory_order_release);
-
-                return next->_version;
+                //global.g_count.fetch_add(
+                blockwise_migrate(curr, next);//,
+                //std::memory_order_acq_rel);
             }
+            // otherwise late to the party
 
-            //global.g_count.fetch_add(
-            blockwise_migrate(curr, next);//,
-            //std::memory_order_acq_rel);
-
+            _slot->migration.store(global_data_t::idle,
+                                   std::memory_order_release);
 
             // leave_migration(): nhelper --
             _global._n_helper.fetch_sub(1, std::memory_order_release);
 
-            return next->_version;
+            return n_version;
         }
 
     private:
@@ -240,6 +365,7 @@ public:
                 std::lock_guard<std::mutex> lock(_global._grow_mutex);
                 _epoch = _global._g_epoch_r.load(std::memory_order_acquire);
                 _table = _global._g_table_r;
+                _global.reclaim();
             }
         }
 
@@ -251,11 +377,17 @@ public:
             //CAS table into R-Position
             {
                 std::lock_guard<std::mutex> lock(_global._grow_mutex);
-                if (_global._g_table_r->_version == _epoch)
+                // without a running migration (r == w, e.g. help_grow after
+                // the handle already loaded the new table), the current
+                // table must not be retired
+                if (_global._g_table_r->_version == _epoch
+                    && _global._g_table_r != _global._g_table_w)
                 {
+                    _global._retired.push_back(_global._g_table_r);
                     _global._g_table_r = _global._g_table_w;
+                    // seq_cst, the slots are read after this (see get_table)
                     _global._g_epoch_r.store(_global._g_epoch_w.load(std::memory_order_acquire),
-                                           std::memory_order_release);
+                                           std::memory_order_seq_cst);
 
                     //auto temp = global.g_count.load(std::memory_order_acquire);
                     //parent.elements.store(temp, std::memory_order_release);
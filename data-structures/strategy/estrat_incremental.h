@@ -0,0 +1,477 @@
+/*******************************************************************************
+ * data-structures/strategy/estrat_incremental.h
+ *
+ * see below
+ *
+ * Part of Project growt - https://github.com/TooBiased/growt.git
+ *
+ * Copyright (C) 2015-2016 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <limits>
+#include <vector>
+
+#include "data-structures/backoff.h"
+
+
+/*******************************************************************************
+ *
+ * This is a exclusion strategy for our growtable (for the interface see
+ * estrat_async.h).
+ *
+ * This specific strategy migrates tables incrementally. A growing step only
+ * creates the target table, afterwards, both tables coexist until the
+ * migration is finished. Each operation migrates a few blocks
+ * (blocks_per_operation) before it does its own work. Thus, operations are
+ * delayed by the migration of some blocks, instead of the whole table.
+ *
+ * First, the target is initialized block by block. Afterwards, the blocks
+ * of the source are migrated, elements are inserted into the target with
+ * CAS operations. Like in the asynchronous strategy, copied cells are
+ * marked. Operations on a key use the target, once all cells of the key's
+ * cluster are marked, and the block that migrates this cluster is finished
+ * (see BaseCircular::marked_cluster), otherwise they use the source
+ * (operations that find marked cells are repeated). The migration is
+ * finished by the operation that finishes its last block.
+ *
+ * Operations on the whole table (e.g. iterators, find_batch) finish a
+ * running migration, before they start. Old tables are reclaimed with
+ * epochs, like in the asynchronous strategy.
+ *
+ * Migrations are not delegated to the worker strategy (use WStratUser).
+ *
+ ******************************************************************************/
+
+namespace growt {
+
+template<class Parent>
+class EStratIncremental
+{
+public:
+    using BaseTable_t   = typename Parent::BaseTable_t;
+    using HashPtrRef    = BaseTable_t*;
+    using key_type      = typename BaseTable_t::key_type;
+    using HashPtr       = BaseTable_t*;
+
+    using value_intern  = typename BaseTable_t::value_intern;
+    static_assert(value_intern::markable,
+                  "Incremental migration can only be chosen with markable elements (e.g. MarkableElement)!!!" );
+
+    // each operation migrates (or initializes) up to blocks_per_operation
+    // blocks of block_size cells
+    static constexpr size_t block_size           = 4096;
+    static constexpr size_t blocks_per_operation = 1;
+
+    class local_data_t;
+
+    // STORED AT THE GLOBAL OBJECT
+    //  - POINTER TO THE CURRENT TABLE AND ITS RUNNING MIGRATION
+    //  - VERSION COUNTER
+    //  - MUTEX FOR SAVE CHANGING OF THE POINTERS
+    //  - ANNOUNCE SLOTS OF ALL HANDLES AND THE RETIRED TABLES
+    class global_data_t
+    {
+    public:
+        global_data_t(size_t size_)
+            : _g_epoch(0), _g_migration(nullptr), _slots(nullptr)
+        {
+            _g_table = new BaseTable_t(size_);
+        }
+        global_data_t(const global_data_t& source) = delete;
+        global_data_t& operator=(const global_data_t& source) = delete;
+        ~global_data_t()
+        {
+            // retired tables are freed oldest first (see reclaim)
+            for (auto t : _retired) delete t;
+            for (auto m : _retired_migrations) delete m;
+            auto m = _g_migration.load();
+            if (m) delete m->target;
+            delete m;
+            delete _g_table;
+
+            auto slot = _slots.load();
+            while (slot)
+            {
+                auto temp = slot->next;
+                delete slot;
+                slot = temp;
+            }
+        }
+
+    private:
+        friend local_data_t;
+
+        static constexpr size_t idle = std::numeric_limits<size_t>::max();
+
+        // one migration from source to target, it is retired together with
+        // its source
+        struct Migration
+        {
+            Migration(HashPtr s, HashPtr t)
+                : source(s), target(t),
+                  n_init((t->_capacity + block_size - 1) / block_size),
+                  n_copy((s->_capacity + block_size - 1) / block_size),
+                  next_init(0), done_init(0), next_copy(0), done_copy(0),
+                  copied(new std::atomic_bool[n_copy])
+            {
+                for (size_t i = 0; i < n_copy; ++i) copied[i].store(false);
+            }
+
+            HashPtr source;
+            HashPtr target;
+            size_t  n_init;
+            size_t  n_copy;
+
+            alignas(64) std::atomic_size_t next_init;
+            alignas(64) std::atomic_size_t done_init;
+            alignas(64) std::atomic_size_t next_copy;
+            alignas(64) std::atomic_size_t done_copy;
+            std::unique_ptr<std::atomic_bool[]> copied;
+
+            bool copying() const
+            { return done_init.load(std::memory_order_acquire) == n_init; }
+        };
+
+        // prevents false sharing between handle specific slots
+        struct alignas(128) HandleSlot
+        {
+            std::atomic_size_t in_use;
+            std::atomic_size_t table;       // version used by an operation
+            HandleSlot*        next;
+
+            HandleSlot() : in_use(1), table(idle), next(nullptr) { }
+        };
+
+        std::atomic_size_t      _g_epoch;
+        HashPtr                 _g_table;
+        std::atomic<Migration*> _g_migration;
+
+        std::mutex _grow_mutex;
+
+        // slots are reused by later handles, the list only grows
+        std::atomic<HandleSlot*> _slots;
+        // replaced tables (ascending versions) and their migrations,
+        // guarded by _grow_mutex
+        std::vector<BaseTable_t*> _retired;
+        std::vector<Migration*>   _retired_migrations;
+
+        HandleSlot* register_handle()
+        {
+            for (auto slot = _slots.load(std::memory_order_acquire);
+                 slot; slot = slot->next)
+            {
+                size_t temp = 0;
+                if (! slot->in_use.load(std::memory_order_relaxed) &&
+                    slot->in_use.compare_exchange_strong(temp, 1))
+                    return slot;
+            }
+
+            auto slot  = new HandleSlot();
+            slot->next = _slots.load(std::memory_order_relaxed);
+            while (! _slots.compare_exchange_weak(slot->next, slot)) { }
+            return slot;
+        }
+
+        // has to be called while holding _grow_mutex, frees all retired
+        // tables (and migrations) older than every announced version
+        void reclaim()
+        {
+            if (_retired.empty()) return;
+
+            size_t min = idle;
+            for (auto slot = _slots.load(); slot; slot = slot->next)
+                min = std::min(min, slot->table.load());
+
+            size_t i = 0;
+            for ( ; i < _retired.size() && _retired[i]->_version < min; ++i)
+            {
+                delete _retired_migrations[i];
+                delete _retired[i];
+            }
+            _retired.erase(_retired.begin(), _retired.begin() + i);
+            _retired_migrations.erase(_retired_migrations.begin(),
+                                      _retired_migrations.begin() + i);
+        }
+    };
+
+    // STORED AT EACH HANDLE
+    //  - CACHED TABLE AND VERSION NUMBER
+    //  - ANNOUNCE SLOT (SEE global_data_t::reclaim)
+    //  - CONNECTIONS TO THE GLOBAL TABLE
+    class local_data_t
+    {
+    private:
+        using WorkerStratL  = typename Parent::WorkerStrat_t::local_data_t;
+        using HandleSlot    = typename global_data_t::HandleSlot;
+        using Migration     = typename global_data_t::Migration;
+    public:
+        local_data_t(Parent& parent, WorkerStratL&)
+            : _parent(parent), _global(parent._global_exclusion),
+              _epoch(0), _table(nullptr), _slot(_global.register_handle())
+        { }
+
+        local_data_t(const local_data_t& source) = delete;
+        local_data_t& operator=(const local_data_t& source) = delete;
+
+        local_data_t(local_data_t&& source)
+            : _parent(source._parent), _global(source._global),
+              _epoch(source._epoch), _table(source._table),
+              _slot(source._slot)
+        {
+            source._slot = nullptr;
+        }
+
+        local_data_t& operator=(local_data_t&& source)
+        {
+            if (this == &source) return *this;
+
+            this->~local_data_t();
+            new (this) local_data_t(std::move(source));
+            return *this;
+        }
+
+        ~local_data_t()
+        {
+            if (! _slot) return;
+
+            _slot->table.store(global_data_t::idle);
+            _slot->in_use.store(0, std::memory_order_release);
+        }
+
+        inline void init() { load(); }
+        inline void deinit() { }
+
+    private:
+        Parent&        _parent;
+        global_data_t& _global;
+
+        size_t         _epoch;
+        BaseTable_t*   _table;
+        HandleSlot*    _slot;
+
+
+    public:
+        // operations on the whole table wait for the running migration
+        inline HashPtrRef get_table()
+        {
+            Migration* m = announce();
+            while (m)
+            {
+                finish(m);
+                m = announce();
+            }
+            return _table;
+        }
+
+        inline HashPtrRef get_table(const key_type& k)
+        {
+            Migration* m = announce();
+            if (! m) return _table;
+            step(m);
+            if (! m->copying()) return _table;
+            // all blocks are migrated (the migration is ending)
+            if (m->done_copy.load(std::memory_order_acquire) == m->n_copy)
+                return m->target;
+
+            size_t start;
+            if (! _table->marked_cluster(k, start)) return _table;
+
+            // the block, that migrates k's cluster, is running
+            if (start < _table->_capacity)
+                for (size_t r = 0; ! m->copied[start / block_size]
+                                      .load(std::memory_order_acquire); )
+                    backoff(r);
+            return m->target;
+        }
+
+        inline HashPtrRef peek_table()
+        {
+            announce();
+            return _table;
+        }
+
+        inline void rls_table()
+        {
+            _slot->table.store(global_data_t::idle, std::memory_order_release);
+        }
+
+        void grow()
+        {
+            Migration* m = announce();
+            if (m)
+            {
+                // the target is already too full (e.g. after many
+                // insertions into the target during the migration)
+                if (_parent._elements.load(std::memory_order_relaxed)
+                    > m->target->_capacity
+                      * _parent._max_fill.load(std::memory_order_relaxed))
+                    finish(m);
+                else if (! step(m))
+                    wait_block(m);
+                rls_table();
+                return;
+            }
+
+            { // should be atomic (therefore locked)
+                std::lock_guard<std::mutex> lock(_global._grow_mutex);
+                if (_global._g_table == _table && ! _global._g_migration.load())
+                {
+                    // first one to get here allocates new table
+                    auto w_table = new BaseTable_t(
+                       _parent.next_capacity(_table->_capacity), _epoch+1);
+                    w_table->share_stats(*_table);
+
+                    // running compactions finish, new ones see the migration
+                    _table->_current_copy_block.store(1);
+                    _global._g_migration.store(new Migration(_table, w_table),
+                                               std::memory_order_release);
+                }
+            }
+            rls_table();
+        }
+
+        // operations that found marked cells wait for a running block, if
+        // there is nothing left to claim (instead of retrying until it is
+        // finished)
+        void help_grow()
+        {
+            Migration* m = announce();
+            if (m && ! step(m)) wait_block(m);
+            rls_table();
+        }
+
+        inline size_t migrate()
+        {
+            Migration* m = announce();
+            if (m) finish(m);
+            rls_table();
+            return _epoch;
+        }
+
+    private:
+        inline void load()
+        {
+            {
+                std::lock_guard<std::mutex> lock(_global._grow_mutex);
+                _epoch = _global._g_epoch.load(std::memory_order_acquire);
+                _table = _global._g_table;
+                _global.reclaim();
+            }
+        }
+
+        // protects _table (see EStratAsync::get_table), and returns its
+        // running migration (if there is one)
+        inline Migration* announce()
+        {
+            _slot->table.store(_epoch, std::memory_order_seq_cst);
+            while (true)
+            {
+                size_t t_epoch = _global._g_epoch.load(std::memory_order_seq_cst);
+                if (t_epoch > _epoch)
+                {
+                    load();
+                    // the old announcement protects the new table until here
+                    _slot->table.store(_epoch, std::memory_order_seq_cst);
+                }
+
+                Migration* m = _global._g_migration.load(std::memory_order_acquire);
+                if (! m || m->source == _table) return m;
+                // the migration of a newer table (ours was replaced meanwhile)
+            }
+        }
+
+        // initializes or migrates up to blocks_per_operation blocks, returns
+        // false, if there was no block left to claim
+        bool step(Migration* m)
+        {
+            bool progress = false;
+            for (size_t i = 0; i < blocks_per_operation; ++i, progress = true)
+            {
+                size_t b = m->n_init;
+                if (m->next_init.load(std::memory_order_relaxed) < m->n_init)
+                    b = m->next_init.fetch_add(1, std::memory_order_relaxed);
+                if (b < m->n_init)
+                {
+                    m->target->initialize(b * block_size,
+                                          std::min((b+1) * block_size,
+                                                   m->target->_capacity));
+                    m->done_init.fetch_add(1, std::memory_order_release);
+                    continue;
+                }
+
+                // the source is migrated, once the target is initialized
+                if (! m->copying()) return progress;
+
+                b = m->n_copy;
+                if (m->next_copy.load(std::memory_order_relaxed) < m->n_copy)
+                    b = m->next_copy.fetch_add(1, std::memory_order_relaxed);
+                if (b >= m->n_copy) return progress;
+
+                m->source->migrate(*m->target, b * block_size,
+                                   std::min((b+1) * block_size,
+                                            m->source->_capacity),
+                                   true);
+                m->copied[b].store(true, std::memory_order_release);
+                if (m->done_copy.fetch_add(1, std::memory_order_acq_rel) + 1
+                    == m->n_copy)
+                {
+                    end_grow(m);
+                    return true;
+                }
+            }
+            return true;
+        }
+
+        // waits until the target is initialized, or until one more block
+        // is migrated
+        void wait_block(Migration* m)
+        {
+            size_t r = 0;
+            if (! m->copying())
+            {
+                while (! m->copying()) backoff(r);
+                return;
+            }
+            size_t done = m->done_copy.load(std::memory_order_acquire);
+            while (done < m->n_copy
+                   && m->done_copy.load(std::memory_order_acquire) == done)
+                backoff(r);
+        }
+
+        // helps until all blocks are migrated, and waits for the others
+        void finish(Migration* m)
+        {
+            while (m->next_copy.load(std::memory_order_relaxed) < m->n_copy)
+                step(m);
+            for (size_t r = 0;
+                 _global._g_epoch.load(std::memory_order_acquire) == _epoch; )
+                backoff(r);
+        }
+
+        inline void end_grow(Migration* m)
+        {
+            {
+                std::lock_guard<std::mutex> lock(_global._grow_mutex);
+                _global._retired.push_back(m->source);
+                _global._retired_migrations.push_back(m);
+                _global._g_table = m->target;
+                _global._g_migration.store(nullptr, std::memory_order_release);
+                // seq_cst, the slots are read after this (see announce)
+                _global._g_epoch.store(m->target->_version,
+                                       std::memory_order_seq_cst);
+
+                auto temp = _parent._dummies.exchange(0, std::memory_order_acq_rel);
+                _parent._elements.fetch_sub(temp, std::memory_order_release);
+            }
+        }
+    };
+};
+
+}
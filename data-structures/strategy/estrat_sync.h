@@ -31,6 +31,9 @@
  *     - init()
  *     - deinit()
  *     - get_table()   (gets current table and protects it from destruction)
+ *     - get_table(k)  (gets the table that holds the key k, usually the
+ *                     current table, see EStratIncremental)
+ *     - peek_table()  (like get_table(), but only used for size estimates)
  *     - rls_table()   (stops protecting the table)
  *     - grow()       (creates a new table and initiates a growing step)
  *     - help_grow()   (called when an operation is unsuccessful,
@@ -55,12 +58,11 @@ template <class Parent>
 class EStratSync
 {
 public:
-    static constexpr size_t max_sim_threads = 256;
-
     using BaseTable_t   = typename Parent::BaseTable_t;
     using WorkerStratL  = typename Parent::WorkerStrat_t::local_data_t;
     using HashPtr       = std::atomic<BaseTable_t*>;
     using HashPtrRef    = BaseTable_t*;
+    using key_type      = typename BaseTable_t::key_type;
 
 
     class local_data_t;
@@ -72,13 +74,14 @@ public:
     {
     public:
 
-        global_data_t(size_t size_) : _currently_growing(0), _handle_id(0)
+        global_data_t(size_t size_) : _currently_growing(0), _n_groups(1)
         {
             auto temp = new BaseTable_t(size_);
             _g_table_r.store( temp, std::memory_order_relaxed );
             _g_table_w.store( temp, std::memory_order_relaxed );
-            //for (size_t i = 0; i<max_sim_threads; ++i)
-            //    _handle_flags[i]();
+            for (size_t i = 0; i < max_segments; ++i)
+                _segments[i].store(nullptr, std::memory_order_relaxed);
+            _segments[0].store(new HandleGroup[1], std::memory_order_relaxed);
         }
         global_data_t(const global_data_t& source) = delete;
         global_data_t& operator=(const global_data_t& source) = delete;
@@ -86,6 +89,8 @@ public:
         {
             // _g_table_r == _g_table_w since unused
             delete _g_table_w.load();
+            for (size_t i = 0; i < max_segments; ++i)
+                delete[] _segments[i].load();
         }
     private:
         friend local_data_t;
@@ -94,40 +99,97 @@ public:
         // essential for good performance
         struct alignas(128) HandleFlags
         {
-            std::atomic_size_t in_use;
             std::atomic_size_t table_op;
             std::atomic_size_t migrating;
 
-            constexpr HandleFlags() : in_use(0), table_op(0), migrating(0) { }
+            constexpr HandleFlags() : table_op(0), migrating(0) { }
         };
 
+        // 64 handles share one summary word (bit i <=> flags[i] in use),
+        // waiting for handles only visits registered ones
+        struct HandleGroup
+        {
+            std::atomic<uint64_t> registered;
+            HandleFlags           flags[64];
+
+            HandleGroup() : registered(0) { }
+        };
+
+        // segment i holds 2^i groups, i.e., registered handles are never
+        // moved, and the registry grows without a fixed maximum
+        static constexpr size_t max_segments = 32;
 
-        // align to cache line
         std::atomic_size_t _currently_growing;
-        std::atomic_size_t _handle_id;
+        // groups that can contain registered handles
+        std::atomic_size_t _n_groups;
         HashPtr            _g_table_r;
         HashPtr            _g_table_w;
-        alignas(128) HandleFlags _handle_flags[max_sim_threads];
+        std::atomic<HandleGroup*> _segments[max_segments];
 
-        size_t registerHandle()
+        HandleGroup& group(size_t g)
         {
-            for (size_t i = 0; i < max_sim_threads; ++i)
+            size_t seg = 63 - __builtin_clzll(g+1);
+            return _segments[seg].load(std::memory_order_acquire)
+                                     [g + 1 - (size_t(1) << seg)];
+        }
+
+        HandleFlags& flags(size_t id) { return group(id >> 6).flags[id & 63]; }
+
+        size_t register_handle()
+        {
+            while (true)
             {
-                if (! _handle_flags[i].in_use.load())
+                size_t n = _n_groups.load(std::memory_order_acquire);
+                for (size_t g = 0; g < n; ++g)
                 {
-                    size_t  temp = 0;
-                    if (_handle_flags[i].in_use.compare_exchange_weak(temp, 1))
+                    auto& grp  = group(g);
+                    auto  mask = grp.registered.load(std::memory_order_relaxed);
+                    while (~mask)
                     {
-                        while ( (temp = _handle_id.load()) <= i)
-                        { _handle_id.compare_exchange_weak(temp, i+1); }
-                        return i;
+                        auto bit = __builtin_ctzll(~mask);
+                        if (grp.registered.compare_exchange_weak(mask,
+                                                     mask | (1ull << bit)))
+                            return (g << 6) + bit;
                     }
-                    else --i;
+                }
+
+                // all groups are full, the next one is added (its segment
+                // is allocated by the first thread to get here)
+                size_t seg = 63 - __builtin_clzll(n+1);
+                if (seg >= max_segments)
+                    throw std::length_error("Exceeded maximum number of simultaneously registered handles!");
+                if (! _segments[seg].load(std::memory_order_acquire))
+                {
+                    HandleGroup* temp = nullptr;
+                    auto nseg = new HandleGroup[size_t(1) << seg];
+                    if (! _segments[seg].compare_exchange_strong(temp, nseg))
+                        delete[] nseg;
+                }
+                _n_groups.compare_exchange_strong(n, n+1);
+            }
+        }
+
+        void deregister_handle(size_t id)
+        {
+            group(id >> 6).registered.fetch_and(~(1ull << (id & 63)),
+                                                std::memory_order_release);
+        }
+
+        // calls f for the flags of all registered handles
+        template <class F>
+        void for_each_handle(F f)
+        {
+            size_t n = _n_groups.load(std::memory_order_acquire);
+            for (size_t g = 0; g < n; ++g)
+            {
+                auto& grp  = group(g);
+                auto  mask = grp.registered.load(std::memory_order_acquire);
+                while (mask)
+                {
+                    f(grp.flags[__builtin_ctzll(mask)]);
+                    mask &= mask - 1;
                 }
             }
-            std::length_error("Exceeded predefined maximum of simultaneously registered threads (256)!");
-            // unreachable
-            return -1;
         }
 
     };
@@ -140,8 +202,8 @@ public:
 
         local_data_t(Parent& parent, WorkerStratL &wstrat)
             : _parent(parent), _global(parent._global_exclusion), _worker_strat(wstrat),
-              _id(_global.registerHandle()), _epoch(0),
-              _flags(_global._handle_flags[_id])
+              _id(_global.register_handle()), _epoch(0),
+              _flags(_global.flags(_id))
               //own_flag(_global.writing[_id<<4]), mig_flag(_global.writing[(_id<<4)+1])
         { }
         local_data_t(const local_data_t& source) = delete;
@@ -174,7 +236,7 @@ public:
 
             _flags.table_op.store(0);
             _flags.migrating.store(0);
-            _flags.in_use.store(0);
+            _global.deregister_handle(_id);
         }
 
         inline void init() { }
@@ -214,6 +276,10 @@ public:
             _flags.table_op.store(0, std::memory_order_release);
         }
 
+        // single key operations and size estimates use the current table
+        inline HashPtrRef get_table(const key_type&) { return get_table(); }
+        inline HashPtrRef peek_table()               { return get_table(); }
+
         void grow()
         {
             rls_table();
@@ -225,10 +291,9 @@ public:
 
             auto t_cur   = _global._g_table_r.load(std::memory_order_acquire);
             auto t_next  = new BaseTable_t(//t_cur->size << 1, t_cur->_version+1);
-                        BaseTable_t::resize(t_cur->_capacity,
-                            _parent._elements.load(std::memory_order_acquire),
-                            _parent._dummies.load(std::memory_order_acquire)),
+                        _parent.next_capacity(t_cur->_capacity),
                         t_cur->_version+1);
+            t_next->share_stats(*t_cur);
 
             wait_for_table_op();
 
@@ -332,21 +397,18 @@ public:
 
         inline void wait_for_table_op()
         {
-            auto end = _global._handle_id.load(std::memory_order_acquire);
-            for (size_t i = 0; i < end; ++i)
+            _global.for_each_handle([](typename global_data_t::HandleFlags& f)
             {
-                while (_global._handle_flags[i]
-                              .table_op.load(std::memory_order_acquire));
-            }
+                while (f.table_op.load(std::memory_order_acquire));
+            });
         }
 
         inline void wait_for_migration()
         {
-            auto end = _global._handle_id.load(std::memory_order_acquire);
-            for (size_t i = 0; i < end; ++i)
+            _global.for_each_handle([](typename global_data_t::HandleFlags& f)
             {
-                while (_global._handle_flags[i].migrating.load(std::memory_order_acquire));
-            }
+                while (f.migrating.load(std::memory_order_acquire));
+            });
         }
 
     };
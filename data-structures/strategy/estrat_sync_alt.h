@@ -32,6 +32,9 @@
  *     - init()
  *     - deinit()
  *     - get_table()   (gets current table and protects it from destruction)
+ *     - get_table(k)  (gets the table that holds the key k, usually the
+ *                     current table, see EStratIncremental)
+ *     - peek_table()  (like get_table(), but only used for size estimates)
  *     - rls_table()   (stops protecting the table)
  *     - grow()       (creates a new table and initiates a growing step)
  *     - help_grow()   (called when an operation is unsuccessful,
@@ -59,6 +62,7 @@ public:
 
     using BaseTable_t   = typename Parent::BaseTable_t;
     using HashPtrRef    = BaseTable_t*;
+    using key_type      = typename BaseTable_t::key_type;
 
     class local_data_t;
 
@@ -228,6 +232,10 @@ public:
             _flags.table_op.store(0); //, std::memory_order_release);
         }
 
+        // single key operations and size estimates use the current table
+        inline HashPtrRef get_table(const key_type&) { return get_table(); }
+        inline HashPtrRef peek_table()               { return get_table(); }
+
         void grow()
         {
             rls_table();
@@ -239,10 +247,9 @@ public:
 
             auto t_cur   = _global._g_table_r.load();//std::memory_order_acquire);
             auto t_next  = new BaseTable_t(//t_cur->size << 1, t_cur->_version+1);
-                        BaseTable_t::resize(t_cur->_capacity,
-                                           _parent._elements.load(),//std::memory_order_acquire),
-                                           _parent._dummies.load()),//std::memory_order_acquire)),
+                        _parent.next_capacity(t_cur->_capacity),
                         t_cur->_version+1);
+            t_next->share_stats(*t_cur);
 
             wait_for_table_op();
 
@@ -78,6 +78,9 @@ public:
         {
             global._grow_wait.wait_if(epoch);
             if (finished) break;
+            // woken without a new migration (e.g. by the deinit of another
+            // handle), migrate would end the user's wait too early
+            if (global._grow_wait.value() == int(epoch)) continue;
 
             auto next = estrat.migrate();
 
@@ -161,7 +164,8 @@ public:
             if (_global._grow_wait.inc_if(epoch))
                 _global._grow_wait.wake();
 
-            _global._user_wait.wait_if(epoch);
+            while (_global._user_wait.value() == int(epoch))
+                _global._user_wait.wait_if(epoch);
         }
     };
 
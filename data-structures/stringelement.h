@@ -0,0 +1,298 @@
+/*******************************************************************************
+ * data-structures/stringelement.h
+ *
+ * StringElements represent the cells of a table with variable length
+ * (string) keys. Each cell holds a 48 bit fingerprint of the key's hash and
+ * a pointer to a record that stores the key and its data. All changes of a
+ * cell are single word CAS operations on its pointer word (marking,
+ * deleting, inserting). Key comparisons only read the record, if the
+ * fingerprints match. Migrations move the 16 byte cell, the record is
+ * shared between the old and the new table.
+ *
+ * Part of Project growt - https://github.com/TooBiased/growt.git
+ *
+ * Copyright (C) 2015-2016 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <stdlib.h>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <string>
+#include <string_view>
+#include <functional>
+#include <utility>
+
+namespace growt {
+
+// key of StringElement tables, a view on the key string together with its
+// hash value, the hash is computed once per operation (when the key is
+// converted), stored elements restore it from their fingerprint
+// keys returned by iterators view the searched key or the stored record
+class StringKey
+{
+public:
+    StringKey() : _str(nullptr), _len(0), _hash(0) { }
+    StringKey(std::string_view s)
+        : _str(s.data()), _len(s.size()), _hash(hash_string(s)) { }
+    StringKey(const std::string& s) : StringKey(std::string_view(s)) { }
+    StringKey(const char* s)        : StringKey(std::string_view(s)) { }
+    StringKey(const char* s, size_t len, uint64_t hash)
+        : _str(s), _len(len), _hash(hash) { }
+
+    std::string_view view() const { return std::string_view(_str, _len); }
+    operator std::string_view() const { return view(); }
+    uint64_t hash() const { return _hash; }
+
+    bool operator==(const StringKey& r) const
+    { return _hash == r._hash && view() == r.view(); }
+    bool operator!=(const StringKey& r) const { return !operator==(r); }
+
+    // the lowest 16 bits are cleared, thus, the hash (and the home cell)
+    // can be restored from the 48 bit fingerprint of a stored element
+    static uint64_t hash_string(std::string_view s)
+    {
+        uint64_t h = std::hash<std::string_view>()(s);
+        h ^= h >> 33;  h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;  h *= 0xc4ceb9fe1a85ec53ull;
+        h ^= h >> 33;
+        return h & ~0xffffull;
+    }
+
+private:
+    const char* _str;
+    size_t      _len;
+    uint64_t    _hash;
+};
+
+// HashFct of StringElement tables (the hash is stored with the key)
+struct StringKeyHash
+{
+    static constexpr size_t significant_digits = 48;
+    uint64_t operator()(const StringKey& k) const { return k.hash(); }
+};
+
+// the key and data of one element, the data word is changed with atomics
+struct StringRecord
+{
+    uint64_t data;
+    uint64_t hash;
+    size_t   length;
+    char     key[1];
+
+    static StringRecord* create(const StringKey& k, uint64_t d)
+    {
+        auto s    = k.view();
+        auto temp = static_cast<StringRecord*>(
+            malloc(offsetof(StringRecord, key) + s.size() + 1));
+        if (! temp) throw std::bad_alloc();
+        temp->data   = d;
+        temp->hash   = k.hash();
+        temp->length = s.size();
+        memcpy(temp->key, s.data(), s.size());
+        temp->key[s.size()] = '\0';
+        return temp;
+    }
+    static void destroy(StringRecord* r) { free(r); }
+
+    bool compare(const StringKey& k) const
+    {
+        auto s = k.view();
+        return length == s.size() && memcmp(key, s.data(), length) == 0;
+    }
+};
+
+class StringElement
+{
+public:
+    using key_type    = StringKey;
+    using mapped_type = uint64_t;
+    using value_type  = std::pair<const key_type, mapped_type>;
+
+    StringElement() = default;
+    // elements constructed from a key are pending (they reference k, which
+    // has to outlive them), their record is only created when they are
+    // written into a cell (see cas), thus, failed insertions allocate nothing
+    // that is visible to other threads
+    StringElement(const key_type& k, const mapped_type& d)
+        : fingerprint(d),
+          pointer(reinterpret_cast<uint64_t>(&k) | PENDING_BIT) { }
+
+    static StringElement get_empty()
+    { return StringElement(0, 0, nullptr); }
+
+    static StringElement get_deleted()
+    { return StringElement(0, DELETED_BIT, nullptr); }
+
+    // updates change the (shared) record, a reused cell could be changed
+    // by a delayed update, therefore deleted cells are not reused
+    static constexpr bool reuse_deleted = false;
+
+    // records are freed with the last table, that owns them (see release)
+    static constexpr bool owns_memory   = true;
+    static constexpr bool markable      = true;
+
+    uint64_t fingerprint;    // hash >> 16, 0 until the inserter stored it
+    uint64_t pointer;        // StringRecord* | MARKED_BIT | DELETED_BIT
+
+    bool is_empty()   const { return (pointer & ~MARKED_BIT) == 0; }
+    bool is_deleted() const { return pointer & DELETED_BIT; }
+    bool is_marked()  const { return pointer & MARKED_BIT; }
+    bool compare_key(const key_type& k) const;
+    bool atomic_mark(StringElement& expected);
+    key_type    get_key()  const;
+    mapped_type get_data() const;
+    bool set_data(const mapped_type);
+
+    bool cas(      StringElement & expected,
+             const StringElement & desired);
+
+    bool atomic_delete(const StringElement & expected);
+
+    template<class F, class ...Types>
+    std::pair<mapped_type, bool> atomic_update(   StringElement & expected,
+                         F f, Types&& ... args);
+    template<class F, class ...Types>
+    std::pair<mapped_type, bool> non_atomic_update(F f, Types&& ... args);
+
+    // frees the record, unless the cell was migrated (marked and not
+    // deleted), then the record belongs to the next table
+    void release();
+
+    inline operator value_type() const
+    {  return std::make_pair(get_key(), get_data()); }
+
+private:
+    StringElement(uint64_t f, uint64_t p, std::nullptr_t)
+        : fingerprint(f), pointer(p) { }
+
+    StringRecord* record() const
+    { return reinterpret_cast<StringRecord*>(pointer & POINTER_MASK); }
+
+    static const uint64_t MARKED_BIT   = 1ull;
+    static const uint64_t DELETED_BIT  = 2ull;
+    static const uint64_t PENDING_BIT  = 4ull;
+    static const uint64_t POINTER_MASK = ~7ull;
+};
+
+
+
+
+inline bool StringElement::compare_key(const key_type & k) const
+{
+    if (is_empty() || is_deleted()) return false;
+    if (fingerprint && fingerprint != (k.hash() >> 16)) return false;
+    return record()->compare(k);
+}
+
+inline StringElement::key_type StringElement::get_key() const
+{
+    auto rec = record();
+    if (! rec) return key_type();
+    return key_type(rec->key, rec->length,
+                    fingerprint ? fingerprint << 16 : rec->hash);
+}
+
+inline StringElement::mapped_type StringElement::get_data() const
+{
+    auto rec = record();
+    return (rec) ? __atomic_load_n(&rec->data, __ATOMIC_ACQUIRE) : 0;
+}
+
+inline bool StringElement::set_data(const mapped_type d)
+{
+    StringElement temp = *this;
+    if (temp.is_marked() || temp.is_empty() || temp.is_deleted()) return false;
+    __atomic_store_n(&temp.record()->data, d, __ATOMIC_RELEASE);
+    return true;
+}
+
+// the fingerprint of a marked element is completed from its record, thus,
+// the migrated copy does not have to read the record again
+inline bool StringElement::atomic_mark(StringElement& expected)
+{
+    if (! __sync_bool_compare_and_swap(&pointer, expected.pointer,
+                                       expected.pointer | MARKED_BIT))
+        return false;
+    if (! expected.fingerprint && expected.record())
+        expected.fingerprint = expected.record()->hash >> 16;
+    return true;
+}
+
+inline bool StringElement::cas( StringElement & expected,
+                          const StringElement & desired)
+{
+    if (! (desired.pointer & PENDING_BIT))
+    {
+        if (! __sync_bool_compare_and_swap(&pointer, expected.pointer,
+                                           desired.pointer))
+            return false;
+        if (desired.fingerprint)
+            __atomic_store_n(&fingerprint, desired.fingerprint,
+                             __ATOMIC_RELAXED);
+        return true;
+    }
+
+    auto& k   = *reinterpret_cast<const key_type*>(desired.pointer
+                                                   & POINTER_MASK);
+    auto  rec = StringRecord::create(k, desired.fingerprint);
+    if (! __sync_bool_compare_and_swap(&pointer, expected.pointer,
+                                       reinterpret_cast<uint64_t>(rec)))
+    {
+        StringRecord::destroy(rec);
+        return false;
+    }
+    __atomic_store_n(&fingerprint, k.hash() >> 16, __ATOMIC_RELAXED);
+    return true;
+}
+
+// deleted cells keep their record, it is freed with the table
+inline bool StringElement::atomic_delete(const StringElement & expected)
+{
+    return __sync_bool_compare_and_swap(&pointer, expected.pointer,
+                                        expected.pointer | DELETED_BIT);
+}
+
+inline void StringElement::release()
+{
+    if ((pointer & (MARKED_BIT | DELETED_BIT)) == MARKED_BIT) return;
+    auto rec = record();
+    if (rec) StringRecord::destroy(rec);
+}
+
+
+
+
+// the record is shared by all copies of the element (in older tables),
+// therefore, updates succeed even if the cell was marked in the meantime
+template<class F, class ...Types>
+inline std::pair<typename StringElement::mapped_type, bool>
+StringElement::atomic_update(StringElement &exp,
+                             F f, Types&& ... args)
+{
+    auto rec  = exp.record();
+    auto curr = __atomic_load_n(&rec->data, __ATOMIC_ACQUIRE);
+    while (true)
+    {
+        auto temp = curr;
+        f(temp, args...);
+        if (__atomic_compare_exchange_n(&rec->data, &curr, temp, false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            return std::make_pair(temp, true);
+    }
+}
+
+template<class F, class ...Types>
+inline std::pair<typename StringElement::mapped_type, bool>
+StringElement::non_atomic_update(F f, Types&& ... args)
+{
+    return std::make_pair(f(record()->data, std::forward<Types>(args)...),
+                          true);
+}
+
+}
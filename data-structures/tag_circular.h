@@ -0,0 +1,835 @@
+/*******************************************************************************
+ * data-structures/tag_circular.h
+ *
+ * Variant of our non growing table, that keeps an additional control byte per
+ * cell (7 hash bits of the stored key, or empty/deleted). Probes scan whole
+ * groups of control bytes (see TagGroupKernel in probe_kernel.h) and only read
+ * cells whose tag matches. Unsuccessful finds end on the first empty tag
+ * without reading any cell.
+ *
+ * The cells remain the authority, tags are published after the cell was
+ * changed. An empty tag in front of a filled cell (not yet published) is
+ * published by every operation that encounters it (lock-free helping). Only
+ * finds trust empty tags, they are linearized before the publication.
+ *
+ * Part of Project growt - https://github.com/TooBiased/growt.git
+ *
+ * Copyright (C) 2015-2016 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <stdlib.h>
+#include <cstdint>
+#include <functional>
+#include <atomic>
+#include <stdexcept>
+#include <algorithm>
+#include <vector>
+
+#include "utils/default_hash.hpp"
+#include "data-structures/base_circular.h"
+#include "data-structures/probe_kernel.h"
+
+namespace growt {
+
+template<class E, class HashFct = utils_tm::hash_tm::default_hash,
+         class A = std::allocator<E>>
+class TagCircular : public BaseCircular<E, HashFct, A>
+{
+private:
+    using This_t          = TagCircular<E,HashFct,A>;
+    using Base_t          = BaseCircular<E,HashFct,A>;
+    using TagAllocator_t  = typename A::template rebind<uint8_t>::other;
+
+    template <class> friend class GrowTableHandle;
+
+public:
+    using value_intern       = E;
+
+    using key_type           = typename Base_t::key_type;
+    using mapped_type        = typename Base_t::mapped_type;
+    using iterator           = typename Base_t::iterator;
+    using const_iterator     = typename Base_t::const_iterator;
+    using size_type          = typename Base_t::size_type;
+    using mapped_reference   = typename Base_t::mapped_reference;
+    using insert_return_type = typename Base_t::insert_return_type;
+
+    using Handle             = This_t&;
+
+    using Base_t::_capacity;
+    using Base_t::end;
+    using Base_t::cend;
+
+    // cleared cells would need their tag to be cleared at the same time
+    static constexpr bool compactable = false;
+
+    // the tags would have to be written with the elements (see
+    // BaseCircular::build)
+    static constexpr bool bulk_build = false;
+
+    // migrations into smaller tables are not supported (see
+    // BaseCircular::unaligned_migration), therefore, the table is never
+    // shrunk
+    static constexpr bool unaligned_migration = false;
+
+    static size_type resize(size_type current, size_type inserted,
+                            size_type deleted,
+                            double grow_fill = Base_t::grow_fill_factor,
+                            double = 0.)
+    { return Base_t::resize(current, inserted, deleted, grow_fill); }
+
+protected:
+    using insert_return_intern = typename Base_t::insert_return_intern;
+
+    using Base_t::_t;
+    using Base_t::_bitmask;
+    using Base_t::_right_shift;
+    using Base_t::_hash;
+    using Base_t::make_iterator;
+    using Base_t::make_citerator;
+    using Base_t::make_insert_ret;
+    using Base_t::rejected;
+    using Base_t::batch_window;
+
+public:
+    TagCircular(size_type size_ = 1<<18);
+    TagCircular(size_type size_, size_type version_);
+
+    TagCircular(TagCircular&& rhs);
+    TagCircular& operator=(TagCircular&& rhs);
+
+    ~TagCircular();
+
+    Handle get_handle() { return *this; }
+
+    insert_return_type insert(const key_type& k, const mapped_type& d);
+    size_type          erase (const key_type& k);
+    iterator           find  (const key_type& k);
+    const_iterator     find  (const key_type& k) const;
+
+    // looks for n keys at once (tag groups of later keys are prefetched)
+    size_type          find_batch(const key_type* keys, size_type n,
+                                  mapped_type* out, bool* found) const;
+
+    insert_return_type insert_or_assign(const key_type& k, const mapped_type& d)
+    { return insert_or_update(k, d, example::Overwrite(), d); }
+
+    mapped_reference operator[](const key_type& k)
+    { return (*(insert(k, mapped_type()).first)).second; }
+
+    template <class F, class ... Types>
+    insert_return_type update
+    (const key_type& k, F f, Types&& ... args);
+
+    template <class F, class ... Types>
+    insert_return_type update_unsafe
+    (const key_type& k, F f, Types&& ... args);
+
+    template <class F, class ... Types>
+    insert_return_type insert_or_update
+    (const key_type& k, const mapped_type& d, F f, Types&& ... args);
+
+    template <class F, class ... Types>
+    insert_return_type insert_or_update_unsafe
+    (const key_type& k, const mapped_type& d, F f, Types&& ... args);
+
+    size_type          erase_if(const key_type& k, const mapped_type& d);
+
+    size_type          insert_batch(const key_type* keys,
+                                    const mapped_type* data, size_type n);
+    template <class F>
+    size_type          insert_or_update_batch(const key_type* keys,
+                                              const mapped_type* data,
+                                              size_type n, F f);
+
+    size_type migrate(This_t& target, size_type s, size_type e);
+
+protected:
+    TagAllocator_t _tag_allocator;
+    uint8_t*       _tags;
+
+    static constexpr uint8_t empty_tag   = 0;
+    static constexpr uint8_t deleted_tag = 1;
+    static uint8_t make_tag(size_type hash) { return 0x80 | (hash & 0x7f); }
+
+    insert_return_intern insert_intern(const key_type& k, const mapped_type& d);
+    ReturnCode           erase_intern (const key_type& k);
+    ReturnCode           erase_if_intern (const key_type& k, const mapped_type& d);
+
+    template <class F, class ... Types>
+    insert_return_intern update_intern
+    (const key_type& k, F f, Types&& ... args);
+
+    template <class F, class ... Types>
+    insert_return_intern update_unsafe_intern
+    (const key_type& k, F f, Types&& ... args);
+
+    template <class F, class ... Types>
+    insert_return_intern insert_or_update_intern
+    (const key_type& k, const mapped_type& d, F f, Types&& ... args);
+
+    template <class F, class ... Types>
+    insert_return_intern insert_or_update_unsafe_intern
+    (const key_type& k, const mapped_type& d, F f, Types&& ... args);
+
+    template <bool Update, class F>
+    void batch_intern(const key_type* keys, const mapped_type* data,
+                      const size_type* order, size_type n,
+                      ReturnCode* codes, F f);
+
+    template <bool Update, class F>
+    size_type batch(const key_type* keys, const mapped_type* data,
+                    size_type n, F f);
+
+    // returns the position of k (or of the first empty tag) in pos
+    bool find_intern(const key_type& k, size_type& pos) const;
+
+    void insert_unsafe(const value_intern& e);
+
+
+
+    // TAG HELPER FUNCTIONS ****************************************************
+
+    inline uint8_t load_tag(size_type pos) const
+    { return __atomic_load_n(&_tags[pos], __ATOMIC_ACQUIRE); }
+
+    inline void publish(size_type pos, uint8_t tag)
+    {
+        if (load_tag(pos) == empty_tag)
+            __atomic_store_n(&_tags[pos], tag, __ATOMIC_RELEASE);
+    }
+
+    // publishes the tag of a filled cell (helps concurrent insertions)
+    inline void publish(size_type pos, const value_intern& curr)
+    {
+        if (load_tag(pos) != empty_tag) return;
+        publish(pos, (curr.is_deleted()) ? deleted_tag
+                                         : make_tag(_hash(curr.get_key())));
+    }
+
+    // skips all cells whose tag is neither empty, nor tag (a whole group at
+    // a time), returns the (unmasked) position of the next interesting cell
+    inline size_type tag_probe(size_type i, uint8_t tag) const
+    {
+        constexpr size_type group_size = TagGroupKernel::group_size;
+        while (true)
+        {
+            size_type lane = i & (group_size-1);
+            uint64_t  mask = TagGroupKernel::match(
+                                 &_tags[(i & _bitmask) - lane], tag)
+                             & (~0ull << lane);
+            if (mask) return i - lane + __builtin_ctzll(mask);
+            i += group_size - lane;
+        }
+    }
+};
+
+
+
+
+
+
+
+
+
+// CONSTRUCTORS/ASSIGNMENTS ****************************************************
+
+template<class E, class HashFct, class A>
+TagCircular<E,HashFct,A>::TagCircular(size_type capacity_)
+    : Base_t(capacity_)
+{
+    _tags = _tag_allocator.allocate(_capacity);
+    if ( !_tags ) throw std::bad_alloc();
+
+    std::fill(_tags, _tags + _capacity, empty_tag);
+}
+
+/*should always be called with a capacity_=2^k  */
+template<class E, class HashFct, class A>
+TagCircular<E,HashFct,A>::TagCircular(size_type capacity_, size_type version_)
+    : Base_t(capacity_, version_)
+{
+    // tags are initialized during the migration (together with the cells)
+    _tags = _tag_allocator.allocate(_capacity);
+    if ( !_tags ) throw std::bad_alloc();
+}
+
+template<class E, class HashFct, class A>
+TagCircular<E,HashFct,A>::~TagCircular()
+{
+    if (_tags) _tag_allocator.deallocate(_tags, _capacity);
+}
+
+template<class E, class HashFct, class A>
+TagCircular<E,HashFct,A>::TagCircular(TagCircular&& rhs)
+    : Base_t(std::move(rhs)), _tags(nullptr)
+{
+    std::swap(_tags, rhs._tags);
+}
+
+template<class E, class HashFct, class A>
+TagCircular<E,HashFct,A>&
+TagCircular<E,HashFct,A>::operator=(TagCircular&& rhs)
+{
+    // the tag array has to be deallocated with the old capacity
+    if (_tags) _tag_allocator.deallocate(_tags, _capacity);
+    _tags = nullptr;
+    Base_t::operator=(std::move(rhs));
+    std::swap(_tags, rhs._tags);
+    return *this;
+}
+
+
+
+// MAIN HASH TABLE FUNCTIONALITY (INTERN) **************************************
+
+template<class E, class HashFct, class A>
+inline typename TagCircular<E,HashFct,A>::insert_return_intern
+TagCircular<E,HashFct,A>::insert_intern(const key_type& k, const mapped_type& d)
+{
+    if (rejected(k)) return make_insert_ret(end(), ReturnCode::ERROR);
+    size_type hash = _hash(k);
+    uint8_t   tag  = make_tag(hash);
+
+    for (size_type i = hash >> _right_shift; ; ++i)
+    {
+        i = tag_probe(i, tag);
+        size_type temp = i & _bitmask;
+        value_intern curr(_t[temp]);
+
+        if (curr.is_marked())
+            return make_insert_ret(end(), ReturnCode::UNSUCCESS_INVALID);
+        else if (curr.is_empty())
+        {
+            if ( _t[temp].cas(curr, value_intern(k,d)) )
+            {
+                publish(temp, tag);
+                return make_insert_ret(k,d, &_t[temp], ReturnCode::SUCCESS_IN);
+            }
+            //somebody changed the current element! recheck it
+            --i;
+            continue;
+        }
+
+        publish(temp, curr);
+        if (curr.compare_key(k))
+            return make_insert_ret(k, curr.get_data(), &_t[temp],
+                                   ReturnCode::UNSUCCESS_ALREADY_USED);
+    }
+    return make_insert_ret(end(), ReturnCode::UNSUCCESS_FULL);
+}
+
+template<class E, class HashFct, class A> template<class F, class ... Types>
+inline typename TagCircular<E,HashFct,A>::insert_return_intern
+TagCircular<E,HashFct,A>::update_intern(const key_type& k, F f, Types&& ... args)
+{
+    size_type hash = _hash(k);
+    uint8_t   tag  = make_tag(hash);
+
+    for (size_type i = hash >> _right_shift; ; ++i)
+    {
+        i = tag_probe(i, tag);
+        size_type temp = i & _bitmask;
+        value_intern curr(_t[temp]);
+
+        if (curr.is_marked())
+            return make_insert_ret(end(), ReturnCode::UNSUCCESS_INVALID);
+        else if (curr.is_empty())
+            return make_insert_ret(end(), ReturnCode::UNSUCCESS_NOT_FOUND);
+
+        publish(temp, curr);
+        if (curr.compare_key(k))
+        {
+            mapped_type data;
+            bool        succ;
+            std::tie(data, succ) = _t[temp].atomic_update(curr, f,
+                                                          std::forward<Types>(args)...);
+            if (succ)
+                return make_insert_ret(k,data, &_t[temp],
+                                       ReturnCode::SUCCESS_UP);
+            i--;
+        }
+    }
+    return make_insert_ret(end(), ReturnCode::UNSUCCESS_NOT_FOUND);
+}
+
+template<class E, class HashFct, class A> template<class F, class ... Types>
+inline typename TagCircular<E,HashFct,A>::insert_return_intern
+TagCircular<E,HashFct,A>::update_unsafe_intern(const key_type& k, F f, Types&& ... args)
+{
+    size_type hash = _hash(k);
+    uint8_t   tag  = make_tag(hash);
+
+    for (size_type i = hash >> _right_shift; ; ++i)
+    {
+        i = tag_probe(i, tag);
+        size_type temp = i & _bitmask;
+        value_intern curr(_t[temp]);
+
+        if (curr.is_marked())
+            return make_insert_ret(end(), ReturnCode::UNSUCCESS_INVALID);
+        else if (curr.is_empty())
+            return make_insert_ret(end(), ReturnCode::UNSUCCESS_NOT_FOUND);
+
+        publish(temp, curr);
+        if (curr.compare_key(k))
+        {
+            mapped_type data = _t[temp].non_atomic_update(f,
+                                   std::forward<Types>(args)...).first;
+            return make_insert_ret(k,data, &_t[temp], ReturnCode::SUCCESS_UP);
+        }
+    }
+    return make_insert_ret(end(), ReturnCode::UNSUCCESS_NOT_FOUND);
+}
+
+template<class E, class HashFct, class A> template<class F, class ... Types>
+inline typename TagCircular<E,HashFct,A>::insert_return_intern
+TagCircular<E,HashFct,A>::insert_or_update_intern(const key_type& k,
+                                                  const mapped_type& d,
+                                                  F f, Types&& ... args)
+{
+    if (rejected(k)) return make_insert_ret(end(), ReturnCode::ERROR);
+    size_type hash = _hash(k);
+    uint8_t   tag  = make_tag(hash);
+
+    for (size_type i = hash >> _right_shift; ; ++i)
+    {
+        i = tag_probe(i, tag);
+        size_type temp = i & _bitmask;
+        value_intern curr(_t[temp]);
+
+        if (curr.is_marked())
+            return make_insert_ret(end(), ReturnCode::UNSUCCESS_INVALID);
+        else if (curr.is_empty())
+        {
+            if ( _t[temp].cas(curr, value_intern(k,d)) )
+            {
+                publish(temp, tag);
+                return make_insert_ret(k,d, &_t[temp], ReturnCode::SUCCESS_IN);
+            }
+            //somebody changed the current element! recheck it
+            --i;
+            continue;
+        }
+
+        publish(temp, curr);
+        if (curr.compare_key(k))
+        {
+            mapped_type data;
+            bool        succ;
+            std::tie(data, succ) = _t[temp].atomic_update(curr, f,
+                                                          std::forward<Types>(args)...);
+            if (succ)
+                return make_insert_ret(k,data, &_t[temp],
+                                       ReturnCode::SUCCESS_UP);
+            i--;
+        }
+    }
+    return make_insert_ret(end(), ReturnCode::UNSUCCESS_FULL);
+}
+
+template<class E, class HashFct, class A> template<class F, class ... Types>
+inline typename TagCircular<E,HashFct,A>::insert_return_intern
+TagCircular<E,HashFct,A>::insert_or_update_unsafe_intern(const key_type& k,
+                                                         const mapped_type& d,
+                                                         F f, Types&& ... args)
+{
+    if (rejected(k)) return make_insert_ret(end(), ReturnCode::ERROR);
+    size_type hash = _hash(k);
+    uint8_t   tag  = make_tag(hash);
+
+    for (size_type i = hash >> _right_shift; ; ++i)
+    {
+        i = tag_probe(i, tag);
+        size_type temp = i & _bitmask;
+        value_intern curr(_t[temp]);
+
+        if (curr.is_marked())
+            return make_insert_ret(end(), ReturnCode::UNSUCCESS_INVALID);
+        else if (curr.is_empty())
+        {
+            if ( _t[temp].cas(curr, value_intern(k,d)) )
+            {
+                publish(temp, tag);
+                return make_insert_ret(k,d, &_t[temp], ReturnCode::SUCCESS_IN);
+            }
+            //somebody changed the current element! recheck it
+            --i;
+            continue;
+        }
+
+        publish(temp, curr);
+        if (curr.compare_key(k))
+        {
+            mapped_type data = _t[temp].non_atomic_update(f,
+                                   std::forward<Types>(args)...).first;
+            return make_insert_ret(k,data, &_t[temp], ReturnCode::SUCCESS_UP);
+        }
+    }
+    return make_insert_ret(end(), ReturnCode::UNSUCCESS_FULL);
+}
+
+template<class E, class HashFct, class A>
+inline ReturnCode TagCircular<E,HashFct,A>::erase_intern(const key_type& k)
+{
+    size_type hash = _hash(k);
+    uint8_t   tag  = make_tag(hash);
+
+    for (size_type i = hash >> _right_shift; ; ++i)
+    {
+        i = tag_probe(i, tag);
+        size_type temp = i & _bitmask;
+        value_intern curr(_t[temp]);
+
+        if (curr.is_marked())
+            return ReturnCode::UNSUCCESS_INVALID;
+        else if (curr.is_empty())
+            return ReturnCode::UNSUCCESS_NOT_FOUND;
+
+        publish(temp, curr);
+        if (curr.compare_key(k))
+        {
+            if (_t[temp].atomic_delete(curr))
+            {
+                __atomic_store_n(&_tags[temp], deleted_tag, __ATOMIC_RELEASE);
+                return ReturnCode::SUCCESS_DEL;
+            }
+            i--;
+        }
+    }
+    return ReturnCode::UNSUCCESS_NOT_FOUND;
+}
+
+template<class E, class HashFct, class A>
+inline ReturnCode TagCircular<E,HashFct,A>::erase_if_intern(const key_type& k,
+                                                            const mapped_type& d)
+{
+    size_type hash = _hash(k);
+    uint8_t   tag  = make_tag(hash);
+
+    for (size_type i = hash >> _right_shift; ; ++i)
+    {
+        i = tag_probe(i, tag);
+        size_type temp = i & _bitmask;
+        value_intern curr(_t[temp]);
+
+        if (curr.is_marked())
+            return ReturnCode::UNSUCCESS_INVALID;
+        else if (curr.is_empty())
+            return ReturnCode::UNSUCCESS_NOT_FOUND;
+
+        publish(temp, curr);
+        if (curr.compare_key(k))
+        {
+            if (curr.get_data() != d) return ReturnCode::UNSUCCESS_NOT_FOUND;
+
+            if (_t[temp].atomic_delete(curr))
+            {
+                __atomic_store_n(&_tags[temp], deleted_tag, __ATOMIC_RELEASE);
+                return ReturnCode::SUCCESS_DEL;
+            }
+            i--;
+        }
+    }
+    return ReturnCode::UNSUCCESS_NOT_FOUND;
+}
+
+template<class E, class HashFct, class A>
+inline bool TagCircular<E,HashFct,A>::find_intern(const key_type& k,
+                                                  size_type& pos) const
+{
+    size_type hash = _hash(k);
+    uint8_t   tag  = make_tag(hash);
+
+    for (size_type i = hash >> _right_shift; ; ++i)
+    {
+        i   = tag_probe(i, tag);
+        pos = i & _bitmask;
+        // an empty tag ends the probe, without looking at the cell
+        if (load_tag(pos) == empty_tag) return false;
+        if (_t[pos].compare_key(k))     return true;
+    }
+    return false;
+}
+
+
+
+// MAIN HASH TABLE FUNCTIONALITY (EXTERN) **************************************
+
+template<class E, class HashFct, class A>
+inline typename TagCircular<E,HashFct,A>::iterator
+TagCircular<E,HashFct,A>::find(const key_type& k)
+{
+    size_type pos;
+    if (! find_intern(k, pos)) return end();
+    value_intern curr(_t[pos]);
+    if (! curr.compare_key(k)) return end();
+    return make_iterator(k, curr.get_data(), &_t[pos]);
+}
+
+template<class E, class HashFct, class A>
+inline typename TagCircular<E,HashFct,A>::const_iterator
+TagCircular<E,HashFct,A>::find(const key_type& k) const
+{
+    size_type pos;
+    if (! find_intern(k, pos)) return cend();
+    value_intern curr(_t[pos]);
+    if (! curr.compare_key(k)) return cend();
+    return make_citerator(k, curr.get_data(), &_t[pos]);
+}
+
+template<class E, class HashFct, class A>
+inline typename TagCircular<E,HashFct,A>::size_type
+TagCircular<E,HashFct,A>::find_batch(const key_type* keys, size_type n,
+                                     mapped_type* out, bool* found) const
+{
+    // probes are short (mostly one tag group), therefore, it suffices to
+    // prefetch the tag group batch_window keys ahead
+    size_type n_found = 0;
+    for (size_type i = 0; i < n; ++i)
+    {
+        if (i + batch_window < n)
+            __builtin_prefetch(&_tags[this->h(keys[i+batch_window])]);
+
+        size_type pos;
+        found[i] = false;
+        if (find_intern(keys[i], pos))
+        {
+            value_intern curr(_t[pos]);
+            if (curr.compare_key(keys[i]))
+            {
+                out[i]   = curr.get_data();
+                found[i] = true;
+                ++n_found;
+            }
+        }
+    }
+    return n_found;
+}
+
+template<class E, class HashFct, class A> template<bool Update, class F>
+inline void
+TagCircular<E,HashFct,A>::batch_intern(const key_type* keys,
+                                       const mapped_type* data,
+                                       const size_type* order, size_type n,
+                                       ReturnCode* codes, F f)
+{
+    // same prefetching as in find_batch
+    for (size_type i = 0; i < n; ++i)
+    {
+        if (i + batch_window < n)
+            __builtin_prefetch(&_tags[this->h(keys[order[i+batch_window]])]);
+
+        const size_type j = order[i];
+        codes[i] = (Update)
+            ? insert_or_update_intern(keys[j], data[j], f, data[j]).second
+            : insert_intern(keys[j], data[j]).second;
+    }
+}
+
+template<class E, class HashFct, class A>
+inline typename TagCircular<E,HashFct,A>::insert_return_type
+TagCircular<E,HashFct,A>::insert(const key_type& k, const mapped_type& d)
+{
+    iterator   it = end();
+    ReturnCode c  = ReturnCode::ERROR;
+    std::tie(it,c) = insert_intern(k,d);
+    return std::make_pair(it, successful(c));
+}
+
+template<class E, class HashFct, class A>
+inline typename TagCircular<E,HashFct,A>::size_type
+TagCircular<E,HashFct,A>::erase(const key_type& k)
+{
+    ReturnCode c = erase_intern(k);
+    return (successful(c)) ? 1 : 0;
+}
+
+template<class E, class HashFct, class A>
+inline typename TagCircular<E,HashFct,A>::size_type
+TagCircular<E,HashFct,A>::erase_if(const key_type& k, const mapped_type& d)
+{
+    ReturnCode c = erase_if_intern(k,d);
+    return (successful(c)) ? 1 : 0;
+}
+
+template<class E, class HashFct, class A> template <class F, class ... Types>
+inline typename TagCircular<E,HashFct,A>::insert_return_type
+TagCircular<E,HashFct,A>::update(const key_type& k, F f, Types&& ... args)
+{
+    iterator   it = end();
+    ReturnCode c  = ReturnCode::ERROR;
+    std::tie(it,c) = update_intern(k,f, std::forward<Types>(args)...);
+    return std::make_pair(it, successful(c));
+}
+
+template<class E, class HashFct, class A> template <class F, class ... Types>
+inline typename TagCircular<E,HashFct,A>::insert_return_type
+TagCircular<E,HashFct,A>::update_unsafe(const key_type& k, F f, Types&& ... args)
+{
+    iterator   it = end();
+    ReturnCode c  = ReturnCode::ERROR;
+    std::tie(it,c) = update_unsafe_intern(k,f, std::forward<Types>(args)...);
+    return std::make_pair(it, successful(c));
+}
+
+template<class E, class HashFct, class A> template <class F, class ... Types>
+inline typename TagCircular<E,HashFct,A>::insert_return_type
+TagCircular<E,HashFct,A>::insert_or_update(const key_type& k,
+                                           const mapped_type& d,
+                                           F f, Types&& ... args)
+{
+    iterator   it = end();
+    ReturnCode c  = ReturnCode::ERROR;
+    std::tie(it,c) = insert_or_update_intern(k,d,f,
+                                             std::forward<Types>(args)...);
+    return std::make_pair(it, (c == ReturnCode::SUCCESS_IN));
+}
+
+template<class E, class HashFct, class A> template <class F, class ... Types>
+inline typename TagCircular<E,HashFct,A>::insert_return_type
+TagCircular<E,HashFct,A>::insert_or_update_unsafe(const key_type& k,
+                                                  const mapped_type& d,
+                                                  F f, Types&& ... args)
+{
+    iterator   it = end();
+    ReturnCode c  = ReturnCode::ERROR;
+    std::tie(it,c) = insert_or_update_unsafe_intern(k,d,f,
+                                                    std::forward<Types>(args)...);
+    return std::make_pair(it, (c == ReturnCode::SUCCESS_IN));
+}
+
+template<class E, class HashFct, class A>
+inline typename TagCircular<E,HashFct,A>::size_type
+TagCircular<E,HashFct,A>::insert_batch(const key_type* keys,
+                                       const mapped_type* data, size_type n)
+{
+    return batch<false>(keys, data, n, example::Overwrite());
+}
+
+template<class E, class HashFct, class A> template <class F>
+inline typename TagCircular<E,HashFct,A>::size_type
+TagCircular<E,HashFct,A>::insert_or_update_batch(const key_type* keys,
+                                                 const mapped_type* data,
+                                                 size_type n, F f)
+{
+    return batch<true>(keys, data, n, f);
+}
+
+template<class E, class HashFct, class A> template <bool Update, class F>
+inline typename TagCircular<E,HashFct,A>::size_type
+TagCircular<E,HashFct,A>::batch(const key_type* keys, const mapped_type* data,
+                                size_type n, F f)
+{
+    std::vector<size_type>  order(n);
+    std::vector<ReturnCode> codes(n);
+    this->batch_order(keys, n, order.data());
+    batch_intern<Update>(keys, data, order.data(), n, codes.data(), f);
+    return std::count(codes.begin(), codes.end(), ReturnCode::SUCCESS_IN);
+}
+
+
+
+
+
+// MIGRATION/GROWING STUFF *****************************************************
+// same as BaseCircular::migrate, but the target tags are initialized and
+// rebuilt together with the target cells
+
+template<class E, class HashFct, class A>
+inline typename TagCircular<E,HashFct,A>::size_type
+TagCircular<E,HashFct,A>::migrate(This_t& target, size_type s, size_type e)
+{
+    size_type n = 0;
+    auto i = s;
+    auto curr = value_intern::get_empty();
+
+    //HOW MUCH BIGGER IS THE TARGET TABLE
+    auto shift = 0u;
+    while (target._capacity > (_capacity << shift)) ++shift;
+
+
+    //FINDS THE FIRST EMPTY BUCKET (START OF IMPLICIT BLOCK)
+    while (i<e)
+    {
+        curr = _t[i];                    //no bitmask necessary (within one block)
+        if (curr.is_empty())
+        {
+            if (_t[i].atomic_mark(curr)) break;
+            else --i;
+        }
+        ++i;
+    }
+
+    std::fill(target._t+(i<<shift), target._t+(e<<shift), value_intern::get_empty());
+    std::fill(target._tags+(i<<shift), target._tags+(e<<shift), empty_tag);
+
+    //MIGRATE UNTIL THE END OF THE BLOCK
+    for (; i<e; ++i)
+    {
+        curr = _t[i];
+        if (! _t[i].atomic_mark(curr))
+        {
+            --i;
+            continue;
+        }
+        else if (! curr.is_empty())
+        {
+            if (!curr.is_deleted())
+            {
+                target.insert_unsafe(curr);
+                ++n;
+            }
+        }
+    }
+
+    auto b = true; // b indicates, if t[i-1] was non-empty
+
+    //CONTINUE UNTIL WE FIND AN EMPTY BUCKET
+    //THE TARGET POSITIONS WILL NOT BE INITIALIZED
+    for (; b; ++i)
+    {
+        auto pos  = i&_bitmask;
+        auto t_pos= pos<<shift;
+        for (size_type j = 0; j < 1ull<<shift; ++j)
+        {
+            target._t   [t_pos+j] = value_intern::get_empty();
+            target._tags[t_pos+j] = empty_tag;
+        }
+
+        curr = _t[pos];
+
+        if (! _t[pos].atomic_mark(curr)) --i;
+        if ( (b = ! curr.is_empty()) )
+        {
+            if (!curr.is_deleted()) { target.insert_unsafe(curr); n++; }
+        }
+    }
+
+    return n;
+}
+
+template<class E, class HashFct, class A>
+inline void TagCircular<E,HashFct,A>::insert_unsafe(const value_intern& e)
+{
+    const key_type k = e.get_key();
+    size_type hash = _hash(k);
+
+    for (size_type i = hash >> _right_shift; ; ++i)
+    {
+        size_type temp = i & _bitmask;
+        value_intern curr(_t[temp]);
+        if (curr.is_empty())
+        {
+            _t[temp]    = e;
+            _tags[temp] = make_tag(hash);
+            return;
+        }
+    }
+    throw std::bad_alloc();
+}
+
+}
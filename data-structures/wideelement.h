@@ -0,0 +1,210 @@
+/*******************************************************************************
+ * data-structures/wideelement.h
+ *
+ * WideElements represent the cells of a table with large values (up to one
+ * cache line) that are stored inline. Each cell has a version word, that
+ * works like a seqlock: writers lock the cell with a CAS (odd version),
+ * change key and value, and release it with the next even version. Copies
+ * of a cell (e.g. value_intern curr(_t[i])) are optimistic reads, that are
+ * repeated until no writer interfered. Therefore, the table sees consistent
+ * snapshots, and every CAS compares the version of its snapshot. Like in
+ * MarkableElement, copied cells are marked (highest bit of the version),
+ * marked cells cannot be locked anymore (used in uaGrow and paGrow).
+ *
+ * Part of Project growt - https://github.com/TooBiased/growt.git
+ *
+ * Copyright (C) 2015-2016 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+
+#include <stdlib.h>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#include <xmmintrin.h>
+
+namespace growt {
+
+template <class V>
+class WideElement
+{
+    static_assert(std::is_trivially_copyable<V>::value,
+                  "WideElement needs a trivially copyable value type!");
+    static_assert(sizeof(V) % 8 == 0 && sizeof(V) <= 64,
+                  "WideElement stores values of 8 to 64 bytes (multiples of 8)!");
+
+public:
+    using key_type    = uint64_t;
+    using mapped_type = V;
+    using value_type  = std::pair<const key_type, mapped_type>;
+
+    WideElement() = default;
+    WideElement(const key_type& k, const mapped_type& d)
+        : version(0), key(k), data(d) { }
+    WideElement(const value_type& p)
+        : version(0), key(p.first), data(p.second) { }
+    WideElement(const WideElement& e)             { snapshot(e); }
+    WideElement& operator=(const WideElement& e)  { snapshot(e); return *this; }
+
+    static WideElement get_empty()
+    { return WideElement( 0, mapped_type() ); }
+
+    static WideElement get_deleted()
+    { return WideElement( BITMASK, mapped_type() ); }
+
+    // updates lock the cell, but a delayed update could still change a
+    // reused cell (its version would be compared), thus, no reuse
+    static constexpr bool reuse_deleted = false;
+    static constexpr bool owns_memory   = false;
+    static constexpr bool markable      = true;
+
+    uint64_t    version;     // even: unlocked, odd: locked, MARKED_BIT
+    key_type    key;
+    mapped_type data;
+
+    bool is_empty()   const { return key == 0; }
+    bool is_deleted() const { return key == BITMASK; }
+    bool is_marked()  const { return version & MARKED_BIT; }
+    bool compare_key(const key_type & k) const { return key == k; }
+    bool atomic_mark(WideElement& expected);
+    key_type    get_key()  const { return (key != BITMASK) ? key : 0; }
+    mapped_type get_data() const { return data; }
+    bool set_data(const mapped_type& d);
+
+    bool cas(      WideElement & expected,
+             const WideElement & desired);
+
+    bool atomic_delete(const WideElement & expected);
+
+    template<class F, class ...Types>
+    std::pair<mapped_type, bool> atomic_update(   WideElement & expected,
+                         F f, Types&& ... args);
+    template<class F, class ...Types>
+    std::pair<mapped_type, bool> non_atomic_update(F f, Types&& ... args);
+
+    inline operator value_type() const
+    {  return std::make_pair(get_key(), get_data()); }
+
+private:
+    static const uint64_t BITMASK    = (1ull << 63) - 1;
+    static const uint64_t MARKED_BIT =  1ull << 63;
+    static constexpr size_t n_words  = sizeof(V) / 8;
+
+    uint64_t*       words()       { return reinterpret_cast<uint64_t*>(&data); }
+    const uint64_t* words() const { return reinterpret_cast<const uint64_t*>(&data); }
+
+    // optimistic read, repeated while e is locked or changed meanwhile
+    void snapshot(const WideElement& e);
+
+    // the cell is locked, if its version is still v (even and unmarked)
+    bool lock  (uint64_t v);
+    void write (const key_type& k, const mapped_type& d);
+    void unlock(uint64_t v) { __atomic_store_n(&version, v + 2, __ATOMIC_RELEASE); }
+};
+
+
+
+
+template <class V>
+inline void WideElement<V>::snapshot(const WideElement& e)
+{
+    while (true)
+    {
+        uint64_t v = __atomic_load_n(&e.version, __ATOMIC_ACQUIRE);
+        if (v & 1) { _mm_pause(); continue; }
+        key = __atomic_load_n(&e.key, __ATOMIC_RELAXED);
+        for (size_t i = 0; i < n_words; ++i)
+            words()[i] = __atomic_load_n(e.words() + i, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&e.version, __ATOMIC_RELAXED) == v)
+        {
+            version = v;
+            return;
+        }
+    }
+}
+
+template <class V>
+inline bool WideElement<V>::lock(uint64_t v)
+{
+    if (v & (MARKED_BIT | 1)) return false;
+    if (! __sync_bool_compare_and_swap(&version, v, v + 1)) return false;
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    return true;
+}
+
+template <class V>
+inline void WideElement<V>::write(const key_type& k, const mapped_type& d)
+{
+    auto src = reinterpret_cast<const uint64_t*>(&d);
+    __atomic_store_n(&key, k, __ATOMIC_RELAXED);
+    for (size_t i = 0; i < n_words; ++i)
+        __atomic_store_n(words() + i, src[i], __ATOMIC_RELAXED);
+}
+
+template <class V>
+inline bool WideElement<V>::set_data(const mapped_type& d)
+{
+    WideElement temp = *this;
+    if (! lock(temp.version)) return false;
+    write(temp.key, d);
+    unlock(temp.version);
+    return true;
+}
+
+template <class V>
+inline bool WideElement<V>::atomic_mark(WideElement& expected)
+{
+    if (expected.version & 1) return false;
+    return __sync_bool_compare_and_swap(&version, expected.version,
+                                        expected.version | MARKED_BIT);
+}
+
+template <class V>
+inline bool WideElement<V>::cas( WideElement & expected,
+                           const WideElement & desired)
+{
+    if (! lock(expected.version)) return false;
+    write(desired.key, desired.data);
+    unlock(expected.version);
+    return true;
+}
+
+template <class V>
+inline bool WideElement<V>::atomic_delete(const WideElement & expected)
+{
+    if (! lock(expected.version)) return false;
+    __atomic_store_n(&key, BITMASK, __ATOMIC_RELAXED);
+    unlock(expected.version);
+    return true;
+}
+
+
+
+
+template <class V> template<class F, class ...Types>
+inline std::pair<typename WideElement<V>::mapped_type, bool>
+WideElement<V>::atomic_update(WideElement &exp,
+                              F f, Types&& ... args)
+{
+    if (! lock(exp.version)) return std::make_pair(exp.data, false);
+    mapped_type temp = exp.data;
+    f(temp, std::forward<Types>(args)...);
+    write(exp.key, temp);
+    unlock(exp.version);
+    return std::make_pair(temp, true);
+}
+
+template <class V> template<class F, class ...Types>
+inline std::pair<typename WideElement<V>::mapped_type, bool>
+WideElement<V>::non_atomic_update(F f, Types&& ... args)
+{
+    f(data, std::forward<Types>(args)...);
+    return std::make_pair(data, true);
+}
+
+}
@@ -10,6 +10,7 @@ using murmur2_hash = utils_tm::hash_tm::murmur2_hash;
 //////////////////////////////////////////////////////////////
 // USING definitions.h (possibly slower compilation)
 #include "data-structures/definitions.h"
+#include "data-structures/parallel_scan.h"
 using Table_t = growt::uaGrow<murmur2_hash, growt::AlignedAllocator<> >;
 
 static std::atomic_size_t aggregator_static {0};
@@ -132,5 +133,14 @@ int main (int, char**)
     d3.join();
     std::cout << aggregator_dynamic.load() << std::endl;
 
+
+    // the same with the built-in scan (work stealing, safe during migrations)
+    std::cout << "parallel_reduce        - " << std::flush;
+    size_t sum = growt::parallel_reduce(
+        [&table]() { return table.get_handle(); }, size_t(0),
+        [](const size_t&, const size_t& data) { return data; },
+        [](size_t a, size_t b) { return a + b; }, 4);
+    std::cout << sum << std::endl;
+
     return 0;
 }
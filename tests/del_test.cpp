@@ -37,9 +37,23 @@
  * 2. Looking for n elements - using different keys (likely not finding any)
  * 3. Looking for the n inserted elements (hopefully finding all)
  *    (correctness test using the index)
+ * The number of migrations is printed for our growing tables (inserts
+ * reuse deleted cells, this reduces the number of cleanup migrations).
+ * With -compact, deleted cells are also removed in place (see
+ * GrowTable::set_compaction).
+ * With -shrink f, the table is shrunk once its fill rate drops below f (see
+ * GrowTable::set_shrink_fill), afterwards
+ * 4. Erasing all remaining elements, except every 16th key, and looking for
+ *    them (the remaining ones have to be found), the final capacity and
+ *    the number of migrations are printed (the capacity has to drop, if
+ *    the table is migrated)
  */
 
+#ifdef KEY_RANGE
+const static uint64_t range = KEY_RANGE;
+#else
 const static uint64_t range = (1ull << 62) -1;
+#endif
 namespace otm = utils_tm::out_tm;
 namespace ttm = utils_tm::thread_tm;
 
@@ -63,7 +77,7 @@ int generate_keys(size_t end)
             {
                 //generate sequential key distribution so that keys are
                 //guaranteed to be unique
-                keys[i] = i;
+                keys[i] = i+2;
             }
         });
 
@@ -90,6 +104,41 @@ int prefill(Hash& hash, size_t pre)
 
 
 
+// only our growing tables count their migrations
+template <class Hash>
+auto migration_count(Hash& hash, int) -> decltype(hash.migration_count())
+{ return hash.migration_count(); }
+
+template <class Hash>
+size_t migration_count(Hash&, long) { return 0; }
+
+// only our growing tables can remove deleted cells in place (-compact)
+template <class Hash>
+auto set_compaction(Hash& hash, bool enable, int)
+    -> decltype(hash.set_compaction(enable))
+{ hash.set_compaction(enable); }
+
+template <class Hash>
+void set_compaction(Hash&, bool, long) { }
+
+// only our growing tables can shrink (-shrink)
+template <class Hash>
+auto set_shrink_fill(Hash& hash, double fill, int)
+    -> decltype(hash.set_shrink_fill(fill))
+{ hash.set_shrink_fill(fill); }
+
+template <class Hash>
+void set_shrink_fill(Hash&, double, long) { }
+
+template <class Hash>
+auto capacity(Hash& hash, int) -> decltype(hash.capacity())
+{ return hash.capacity(); }
+
+template <class Hash>
+size_t capacity(Hash&, long) { return 0; }
+
+
+
 template <class Hash,  class ThreadType >
 int del_test_per_thread(ThreadType t, Hash& hash, size_t w_s, size_t total_size)
 {
@@ -134,6 +183,22 @@ int del_test_per_thread(ThreadType t, Hash& hash, size_t w_s, size_t total_size)
 }
 
 
+// all keys are erased, except every 16th one
+template <class Hash>
+int shrink_erase(Hash& hash, size_t end)
+{
+    auto erased = 0u;
+
+    ttm::execute_parallel(current_block, end,
+        [&hash, &erased](size_t i)
+        {
+            if (i & 15 && hash.erase(keys[i])) ++erased;
+        });
+
+    unsucc_deletes.fetch_add(erased, std::memory_order_relaxed);
+    return 0;
+}
+
 template <class Hash>
 int validate(Hash& hash, size_t end)
 {
@@ -159,7 +224,8 @@ int validate(Hash& hash, size_t end)
 template <class ThreadType>
 struct test_in_stages
 {
-    static int execute(ThreadType t, size_t n, size_t cap, size_t it, size_t ws)
+    static int execute(ThreadType t, size_t n, size_t cap, size_t it, size_t ws,
+                       bool compact, double shrink)
     {
         utils_tm::pin_to_core(t.id);
 
@@ -179,8 +245,15 @@ struct test_in_stages
         for (size_t i = 0; i < it; ++i)
         {
             // STAGE 0.01
-            t.synchronized([cap](bool m)
-                           { if (m) hash_table = HASHTYPE(cap); return 0; },
+            t.synchronized([cap, compact](bool m)
+                           {
+                               if (m)
+                               {
+                                   hash_table = HASHTYPE(cap);
+                                   set_compaction(hash_table, compact, 0);
+                               }
+                               return 0;
+                           },
                            ThreadType::is_main);
 
             t.out << otm::width(3) << i
@@ -224,7 +297,51 @@ struct test_in_stages
                 //TODO: look into adding back
                 //      << otm::width(7)  << unsucc_deletes.load()
                       << otm::width(7)  << succ_found.load()
-                      << otm::width(7)  << errors.load();
+                      << otm::width(7)  << errors.load()
+                      << otm::width(7)  << migration_count(hash, 0);
+            }
+
+            // STAGE3 Erasing most Elements (shrinking the table)
+            if (shrink > 0.)
+            {
+                size_t remain = succ_found.load();
+                t.synchronize();
+
+                if (ThreadType::is_main)
+                {
+                    set_shrink_fill(hash_table, shrink, 0);
+                    current_block.store(0);
+                    unsucc_deletes.store(0);
+                    succ_found.store(0);
+                }
+                size_t cap0  = capacity(hash, 0);
+                size_t migr0 = migration_count(hash, 0);
+
+                auto duration = t.synchronized(shrink_erase<Handle>,
+                                               hash, ws+n);
+
+                if (ThreadType::is_main) current_block.store(0);
+                t.synchronized(validate<Handle>, hash, ws+n);
+
+                // tables that cannot shrink (no unaligned migrations, e.g.
+                // robin hood tables) are not migrated
+                remain -= unsucc_deletes.load();
+                size_t cap1 = capacity(hash, 0);
+                bool   migr = migration_count(hash, 0) != migr0;
+                if (ThreadType::is_main
+                    && (succ_found.load() != remain
+                        || cap1 > cap0 || (migr && cap1 == cap0)))
+                {
+                    printf("erro shrink remain %lu found %lu cap %lu->%lu \n",
+                           remain, succ_found.load(), cap0, cap1);
+                    errors.fetch_add(1, std::memory_order_relaxed);
+                }
+
+                t.out << otm::width(10) << duration.second/1000000.
+                      << otm::width(7)  << remain
+                      << otm::width(9)  << cap1
+                      << otm::width(7)  << errors.load()
+                      << otm::width(7)  << migration_count(hash, 0);
             }
 
 
@@ -263,6 +380,8 @@ int main(int argn, char** argc)
     size_t ws  = c.int_arg("-ws", n/4);
     size_t cap = c.int_arg("-c" , ws);
     size_t it  = c.int_arg("-it", 5);
+    bool   cmp = c.bool_arg("-compact");
+    double shr = c.double_arg("-shrink", 0.);
     if (! c.report()) return 1;
 
     otm::out() << otm::width(3)  << "#i"
@@ -275,9 +394,16 @@ int main(int argn, char** argc)
                 //<< otm::width(7)  << "unsucc"
                << otm::width(7) << "remain"
                << otm::width(7)  << "errors"
-               << std::endl;
-
-    ttm::start_threads<test_in_stages>(p, n, cap, it, ws);
+               << otm::width(7)  << "migr";
+    if (shr > 0.)
+        otm::out() << otm::width(10) << "t_shrink"
+                   << otm::width(7)  << "remain"
+                   << otm::width(9)  << "cap"
+                   << otm::width(7)  << "errors"
+                   << otm::width(7)  << "migr";
+    otm::out() << std::endl;
+
+    ttm::start_threads<test_in_stages>(p, n, cap, it, ws, cmp, shr);
 
     return 0;
 }
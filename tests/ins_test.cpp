@@ -21,6 +21,8 @@
 
 #include <random>
 #include <iostream>
+#include <memory>
+#include <vector>
 
 using namespace std::chrono;
 
@@ -35,9 +37,25 @@ using namespace std::chrono;
  * 2. Looking for n elements - using different keys (likely not finding any)
  * 3. Looking for the n inserted elements (hopefully finding all)
  *    (correctness test using the index)
+ * With -batch b, steps 2 and 3 are repeated using batched lookups
+ * (find_batch with b keys per call) to compare them with the scalar loop.
+ * With -ibatch b, step 1 uses batched insertions (insert_batch with b keys
+ * per call).
+ * Tables that record probe statistics (e.g. UAGROW_PSTATS) print their
+ * probe distance histograms after each iteration.
+ * With -maxfill f and/or -growfill g, our growing tables are migrated at
+ * the fill rate f and grow, if more than g remains (see
+ * GrowTable::set_max_fill), the capacity and the number of migrations
+ * after step 1 are printed (the capacity has to hold all n elements at
+ * the fill rate f and only grows through migrations, use a small
+ * capacity -c to see migrations).
  */
 
+#ifdef KEY_RANGE
+const static uint64_t range = KEY_RANGE;
+#else
 const static uint64_t range = (1ull << 62) -1;
+#endif
 namespace otm = utils_tm::out_tm;
 namespace ttm = utils_tm::thread_tm;
 
@@ -48,6 +66,18 @@ alignas(64) static std::atomic_size_t errors;
 alignas(64) static HASHTYPE hash_table = HASHTYPE(0);
 int generate_random(size_t n)
 {
+#ifdef KEY_RANGE
+    // random keys from a small key range would repeat, instead, keys are
+    // spread by a multiplicative permutation of [2, range]
+    ttm::execute_blockwise_parallel(current_block, n,
+        [](size_t s, size_t e)
+        {
+            for (size_t i = s; i < e; i++)
+            {
+                keys[i] = 2 + (i * 2654435761ull) % (range - 1);
+            }
+        });
+#else
     std::uniform_int_distribution<uint64_t> dis(2,range);
 
     ttm::execute_blockwise_parallel(current_block, n,
@@ -60,6 +90,7 @@ int generate_random(size_t n)
                 keys[i] = dis(re);
             }
         });
+#endif
 
     return 0;
 }
@@ -93,6 +124,45 @@ int fill(Hash& hash, size_t end)
 }
 
 
+// batched insertions are only offered by our own tables,
+// all other tables fall back to a loop of scalar insertions
+template <class Hash>
+auto insert_batch_intern(Hash& hash, const uint64_t* k, const uint64_t* d,
+                         size_t n, int)
+    -> decltype(hash.insert_batch(k, d, n))
+{
+    return hash.insert_batch(k, d, n);
+}
+
+template <class Hash>
+size_t insert_batch_intern(Hash& hash, const uint64_t* k, const uint64_t* d,
+                           size_t n, long)
+{
+    size_t n_ins = 0;
+    for (size_t i = 0; i < n; ++i)
+        if (hash.insert(k[i], d[i]).second) ++n_ins;
+    return n_ins;
+}
+
+template <class Hash>
+int fill_batch(Hash& hash, size_t end, size_t batch)
+{
+    ttm::execute_blockwise_parallel(current_block, end,
+        [&hash, batch](size_t s, size_t e)
+        {
+            std::vector<uint64_t> data(batch);
+
+            for (size_t b = s; b < e; b += batch)
+            {
+                auto size = std::min(batch, e-b);
+                for (size_t i = 0; i < size; ++i) data[i] = b+i+2;
+                insert_batch_intern(hash, keys+b, data.data(), size, 0);
+            }
+        });
+
+    return 0;
+}
+
 template <class Hash>
 int find_unsucc(Hash& hash, size_t begin, size_t end)
 {
@@ -145,10 +215,103 @@ int find_succ(Hash& hash, size_t end)
     return 0;
 }
 
+// batched lookups are only offered by our own tables,
+// all other tables fall back to a loop of scalar finds
+template <class Hash>
+auto find_batch_intern(Hash& hash, const uint64_t* k, size_t n,
+                       uint64_t* out, bool* found, int)
+    -> decltype(hash.find_batch(k, n, out, found))
+{
+    return hash.find_batch(k, n, out, found);
+}
+
+template <class Hash>
+size_t find_batch_intern(Hash& hash, const uint64_t* k, size_t n,
+                         uint64_t*, bool* found, long)
+{
+    size_t n_found = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        found[i] = (hash.find(k[i]) != hash.end());
+        if (found[i]) ++n_found;
+    }
+    return n_found;
+}
+
+template <class Hash>
+int find_batch(Hash& hash, size_t end, size_t batch, bool succ)
+{
+    auto err = 0u;
+
+    ttm::execute_blockwise_parallel(current_block, end,
+        [&hash, &err, batch, succ](size_t s, size_t e)
+        {
+            std::vector<uint64_t> out(batch);
+            std::unique_ptr<bool[]> found(new bool[batch]);
+
+            for (size_t b = s; b < e; b += batch)
+            {
+                auto size = std::min(batch, e-b);
+                find_batch_intern(hash, keys+b, size,
+                                  out.data(), found.get(), 0);
+                for (size_t i = 0; i < size; ++i)
+                {
+                    if (found[i] != succ) ++err;
+                }
+            }
+        });
+
+    errors.fetch_add(err, std::memory_order_relaxed);
+    return 0;
+}
+
+// probe statistics are only offered by our own tables,
+// they are only printed if they were recorded (Stats = ProbeStats)
+template <class Hash>
+auto print_probe_stats(Hash& hash, int)
+    -> decltype(hash.probe_stats(), void())
+{
+    auto stats = hash.probe_stats();
+    if (stats.insert.count() + stats.hit.count() + stats.miss.count())
+        std::cout << stats;
+}
+
+template <class Hash>
+void print_probe_stats(Hash&, long) { }
+
+// only our growing tables count their migrations
+template <class Hash>
+auto migration_count(Hash& hash, int) -> decltype(hash.migration_count())
+{ return hash.migration_count(); }
+
+template <class Hash>
+size_t migration_count(Hash&, long) { return 0; }
+
+template <class Hash>
+auto capacity(Hash& hash, int) -> decltype(hash.capacity())
+{ return hash.capacity(); }
+
+template <class Hash>
+size_t capacity(Hash&, long) { return 0; }
+
+// only our growing tables can change their fill rates (0 keeps the default)
+template <class Hash>
+auto set_fill(Hash& hash, double max_fill, double grow_fill, int)
+    -> decltype(hash.set_max_fill(max_fill), hash.set_grow_fill(grow_fill))
+{
+    if (max_fill  > 0.) hash.set_max_fill (max_fill);
+    if (grow_fill > 0.) hash.set_grow_fill(grow_fill);
+}
+
+template <class Hash>
+void set_fill(Hash&, double, double, long) { }
+
 template <class ThreadType>
 struct test_in_stages
 {
-    static int execute(ThreadType t, size_t n, size_t cap, size_t it)
+    static int execute(ThreadType t, size_t n, size_t cap, size_t it,
+                       size_t batch, size_t ibatch,
+                       double max_fill, double grow_fill)
     {
         using Handle = typename HASHTYPE::Handle;
 
@@ -167,8 +330,15 @@ struct test_in_stages
 
         for (size_t i = 0; i < it; ++i)
         {
-           t.synchronized([cap](bool m)
-                           { if (m) hash_table = HASHTYPE(cap); return 0; },
+           t.synchronized([cap, max_fill, grow_fill](bool m)
+                           {
+                               if (m)
+                               {
+                                   hash_table = HASHTYPE(cap);
+                                   set_fill(hash_table, max_fill, grow_fill, 0);
+                               }
+                               return 0;
+                           },
                            ThreadType::is_main);
             // STAGE 0.1
 
@@ -194,10 +364,33 @@ struct test_in_stages
             // STAGE2 n Insertions
             {
                 if (ThreadType::is_main) current_block.store(0);
+                size_t cap0 = capacity(hash, 0);
 
-                auto duration = t.synchronized(fill<Handle>,hash, n);
+                auto duration = (ibatch)
+                    ? t.synchronized(fill_batch<Handle>, hash, n, ibatch)
+                    : t.synchronized(fill<Handle>,hash, n);
 
                 t.out << otm::width(10) << duration.second/1000000.;
+
+                if (max_fill > 0. || grow_fill > 0.)
+                {
+                    // handles count their insertions in batches of 64, the
+                    // table only grows through migrations (no deletions)
+                    size_t cap1  = capacity(hash, 0);
+                    size_t migr  = migration_count(hash, 0);
+                    double slack = 64.*t.p;
+                    if (ThreadType::is_main && cap1
+                        && ((max_fill > 0. && cap1*max_fill + slack < n)
+                            || cap1 < cap0 || (migr == 0 && cap1 != cap0)))
+                    {
+                        printf("erro fill cap %lu->%lu migr %lu \n",
+                               cap0, cap1, migr);
+                        errors.fetch_add(1, std::memory_order_relaxed);
+                    }
+
+                    t.out << otm::width(9) << cap1
+                          << otm::width(7) << migr;
+                }
             }
 
             // STAGE3 n Finds Unsuccessful
@@ -217,9 +410,31 @@ struct test_in_stages
                                                hash, n);
 
                 t.out << otm::width(10) << duration.second/1000000.;
-                t.out << otm::width(10) << errors.load();
             }
 
+            if (batch)
+            {
+                // STAGE5 n Batched Finds Unsuccessful
+                {
+                    if (ThreadType::is_main) current_block.store(n);
+
+                    auto duration = t.synchronized(find_batch<Handle>,
+                                                   hash, 2*n, batch, false);
+                    t.out << otm::width(10) << duration.second/1000000.;
+                }
+
+                // STAGE6 n Batched Finds Successful
+                {
+                    if (ThreadType::is_main) current_block.store(0);
+
+                    auto duration = t.synchronized(find_batch<Handle>,
+                                                   hash, n, batch, true);
+                    t.out << otm::width(10) << duration.second/1000000.;
+                }
+            }
+
+            t.out << otm::width(10) << errors.load();
+
 #ifdef MALLOC_COUNT
             t.out << otm::width(14) << malloc_count_current();
 #endif
@@ -227,6 +442,10 @@ struct test_in_stages
             t.out << std::endl;
             if (ThreadType::is_main) errors.store(0);
 
+            t.synchronized([](Handle& hash, bool m)
+                           { if (m) print_probe_stats(hash, 0); return 0; },
+                           hash, ThreadType::is_main);
+
             RobindHoodHandlerWrapper::freeIfRobinhoodWrapper(hash);
 
 
@@ -253,18 +472,29 @@ int main(int argn, char** argc)
     size_t p   = c.int_arg("-p" , 4);
     size_t cap = c.int_arg("-c" , n);
     size_t it  = c.int_arg("-it", 5);
+    size_t bat = c.int_arg("-batch", 0);
+    size_t ibat= c.int_arg("-ibatch", 0);
+    double mfil= c.double_arg("-maxfill", 0.);
+    double gfil= c.double_arg("-growfill", 0.);
     if (! c.report()) return 1;
 
     otm::out() << otm::width(3)  << "#i"
                << otm::width(3)  << "p"
                << otm::width(9)  << "n"
                << otm::width(9)  << "cap"
-               << otm::width(10) << "t_ins"
-               << otm::width(10) << "t_find_-"
-               << otm::width(10) << "t_find_+"
-               << otm::width(7)  << "errors"
+               << otm::width(10) << "t_ins";
+    if (mfil > 0. || gfil > 0.)
+        otm::out() << otm::width(9)  << "cap_ins"
+                   << otm::width(7)  << "migr";
+    otm::out() << otm::width(10) << "t_find_-"
+               << otm::width(10) << "t_find_+";
+    if (bat)
+        otm::out() << otm::width(10) << "t_bfind_-"
+                   << otm::width(10) << "t_bfind_+";
+    otm::out() << otm::width(7)  << "errors"
                << std::endl;
 
-    ttm::start_threads<test_in_stages>(p, n, cap, it);
+    ttm::start_threads<test_in_stages>(p, n, cap, it, bat, ibat,
+                                      mfil, gfil);
     return 0;
 }
@@ -0,0 +1,206 @@
+/*******************************************************************************
+ * tests/mig_test.cpp
+ *
+ * migration benchmark for more information see below
+ *
+ * Part of Project growt - https://github.com/TooBiased/growt.git
+ *
+ * Copyright (C) 2015-2016 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include "tests/selection.h"
+#include "data-structures/ancient_grow.h"
+
+#include "utils/default_hash.hpp"
+#include "utils/thread_coordination.hpp"
+#include "utils/pin_thread.hpp"
+#include "utils/command_line_parser.hpp"
+#include "utils/output.hpp"
+
+#include <random>
+#include <iostream>
+#include <memory>
+
+/*
+ * This Test measures one isolated migration (on a non-growing table).
+ * 0. Creating n random keys
+ * 1. Inserting n elements into a table with capacity cap
+ * 2. Migrating the table into a table of twice its capacity
+ *    (all p threads help, blocks are distributed by MigrationScheduler)
+ * 3. Counting the elements of the target (correctness test)
+ * With -bs b, tables use a fixed block size b instead of the adaptive one
+ * (-bs 4096 is the former global block size).
+ */
+
+const static uint64_t range = (1ull << 62) -1;
+namespace otm = utils_tm::out_tm;
+namespace ttm = utils_tm::thread_tm;
+
+alignas(64) static uint64_t* keys;
+alignas(64) static std::atomic_size_t current_block;
+alignas(64) static std::atomic_size_t errors;
+alignas(64) static std::atomic_size_t migrated;
+
+alignas(64) static std::unique_ptr<HASHTYPE> source;
+alignas(64) static std::unique_ptr<HASHTYPE> target;
+
+int generate_random(size_t n)
+{
+    std::uniform_int_distribution<uint64_t> dis(2,range);
+
+    ttm::execute_blockwise_parallel(current_block, n,
+        [&dis](size_t s, size_t e)
+        {
+            std::mt19937_64 re(s*10293903128401092ull);
+
+            for (size_t i = s; i < e; i++)
+            {
+                keys[i] = dis(re);
+            }
+        });
+
+    return 0;
+}
+
+int fill(size_t end)
+{
+    auto&& hash = source->get_handle();
+    ttm::execute_parallel(current_block, end,
+        [&hash](size_t i)
+        {
+            hash.insert(keys[i], i+2);
+        });
+    return 0;
+}
+
+int migrate()
+{
+    migrated.fetch_add(growt::blockwise_migrate(source.get(), target.get()),
+                       std::memory_order_relaxed);
+    return 0;
+}
+
+int count(size_t end)
+{
+    size_t n = 0;
+    for (auto it = target->begin(); it != target->end(); ++it) ++n;
+    if (n != end)
+    {
+        std::cout << "target has " << n << " elements (expected "
+                  << end << ")" << std::endl;
+        errors.fetch_add(1, std::memory_order_relaxed);
+    }
+    return 0;
+}
+
+template <class ThreadType>
+struct test_in_stages
+{
+    static int execute(ThreadType t, size_t n, size_t cap, size_t it,
+                       size_t bs)
+    {
+        utils_tm::pin_to_core(t.id);
+
+        if (ThreadType::is_main)
+        {
+            keys = new uint64_t[n];
+            growt::MigrationScheduler::fixed_block_size().store(bs);
+        }
+
+        // STAGE0 Create Random Keys
+        {
+            if (ThreadType::is_main) current_block.store (0);
+            t.synchronized(generate_random, n);
+        }
+
+        for (size_t i = 0; i < it; ++i)
+        {
+            t.synchronized([cap](bool m)
+                           {
+                               if (m)
+                               {
+                                   source.reset(new HASHTYPE(cap));
+                                   target.reset(new HASHTYPE(
+                                       source->_capacity << 1, 1));
+                               }
+                               return 0;
+                           },
+                           ThreadType::is_main);
+
+            auto& params = source->_migration.parameters();
+            t.out << otm::width(3) << i
+                  << otm::width(3) << t.p
+                  << otm::width(9) << n
+                  << otm::width(9) << source->_capacity
+                  << otm::width(7) << params.block_size
+                  << otm::width(7) << params.n_ranges;
+
+            // STAGE1 n Insertions
+            {
+                if (ThreadType::is_main) current_block.store(0);
+                t.synchronized(fill, n);
+            }
+
+            // STAGE2 Migration
+            {
+                auto duration = t.synchronized(migrate);
+                t.out << otm::width(10) << duration.second/1000000.;
+            }
+
+            // STAGE3 Validation
+            {
+                t.synchronized([n](bool m) { if (m) count(n); return 0; },
+                               ThreadType::is_main);
+            }
+
+            t.out << otm::width(9)  << migrated.load()
+                  << otm::width(7)  << errors.load();
+            t.out << std::endl;
+            if (ThreadType::is_main)
+            {
+                errors.store(0);
+                migrated.store(0);
+            }
+            t.synchronize();
+        }
+
+        if (ThreadType::is_main)
+        {
+            source.reset();
+            target.reset();
+            delete[] keys;
+        }
+
+        return 0;
+    }
+};
+
+
+
+int main(int argn, char** argc)
+{
+    utils_tm::command_line_parser c{argn, argc};
+    size_t n   = c.int_arg("-n" , 10000000);
+    size_t p   = c.int_arg("-p" , 4);
+    size_t cap = c.int_arg("-c" , 2*n);
+    size_t it  = c.int_arg("-it", 5);
+    size_t bs  = c.int_arg("-bs", 0);
+    if (! c.report()) return 1;
+
+    otm::out() << otm::width(3)  << "#i"
+               << otm::width(3)  << "p"
+               << otm::width(9)  << "n"
+               << otm::width(9)  << "cap"
+               << otm::width(7)  << "block"
+               << otm::width(7)  << "ranges"
+               << otm::width(10) << "t_mig"
+               << otm::width(9)  << "migr"
+               << otm::width(7)  << "errors"
+               << std::endl;
+
+    ttm::start_threads<test_in_stages>(p, n, cap, it, bs);
+
+    return 0;
+}
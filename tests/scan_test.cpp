@@ -0,0 +1,389 @@
+/*******************************************************************************
+ * tests/scan_test.cpp
+ *
+ * correctness test for reserve, build, and (parallel and resumable) scans,
+ * for more information see below
+ *
+ * Part of Project growt - https://github.com/TooBiased/growt.git
+ *
+ * Copyright (C) 2015-2016 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include "tests/selection.h"
+#include "data-structures/parallel_scan.h"
+
+#include "utils/default_hash.hpp"
+#include "utils/thread_coordination.hpp"
+#include "utils/pin_thread.hpp"
+#include "utils/command_line_parser.hpp"
+#include "utils/output.hpp"
+
+#include <iostream>
+
+/*
+ * This Test checks operations of growing tables, that work on many elements.
+ * 0. Creating 3n distinct keys
+ * 1. Reserving the capacity for n elements (at most one migration)
+ * 2. Inserting n elements (key, index), no further migration is expected,
+ *    and looking for them
+ * 3. Building a second table from the n elements (build reserves the
+ *    capacity, i.e., at most one migration), and looking for them
+ * 4. Visiting the elements of the first table with parallel_for_each and
+ *    parallel_reduce (p threads each), while the other threads insert n
+ *    further elements (migrating the table), each of the first n elements
+ *    has to be visited exactly once (needs p > 1 for concurrent migrations)
+ * 5. Scanning the second table with scan(cursor, n/8, f), after each step
+ *    n/8 further elements are inserted (growing the table), each of the
+ *    first n elements has to be visited at least once (the table grows,
+ *    unless its capacity suffices for 2n elements, e.g. for small n)
+ */
+
+const static uint64_t range = (1ull << 62) -1;
+namespace otm = utils_tm::out_tm;
+namespace ttm = utils_tm::thread_tm;
+
+alignas(64) static uint64_t* keys;
+alignas(64) static std::pair<uint64_t, uint64_t>* elements;
+alignas(64) static std::atomic_size_t* visits;
+alignas(64) static std::atomic_size_t current_block;
+alignas(64) static std::atomic_size_t scan_cursor;
+alignas(64) static std::atomic_size_t errors;
+
+alignas(64) static HASHTYPE hash_table  = HASHTYPE(0);
+alignas(64) static HASHTYPE build_table = HASHTYPE(0);
+
+// the multiplication with an odd constant is a bijection modulo 2^62,
+// thus, keys are distinct (and no sentinel)
+int generate_distinct(size_t n)
+{
+    ttm::execute_blockwise_parallel(current_block, 3*n,
+        [n](size_t s, size_t e)
+        {
+            for (size_t i = s; i < e; i++)
+            {
+                keys[i] = ((i+1) * 0x9e3779b97f4a7c15ull) & range;
+                if (i < n) elements[i] = std::make_pair(keys[i], i+2);
+            }
+        });
+
+    return 0;
+}
+
+// the elements in [current_block, end) are inserted
+template <class Hash>
+int fill(Hash& hash, size_t end)
+{
+    auto err = 0u;
+
+    ttm::execute_blockwise_parallel(current_block, end,
+        [&hash, &err](size_t s, size_t e)
+        {
+            for (size_t i = s; i < e; i++)
+            {
+                if (! hash.insert(keys[i], i+2).second) ++err;
+            }
+        });
+
+    errors.fetch_add(err, std::memory_order_relaxed);
+    return 0;
+}
+
+template <class Hash>
+int find(Hash& hash, size_t end)
+{
+    auto err = 0u;
+
+    ttm::execute_blockwise_parallel(current_block, end,
+        [&hash, &err](size_t s, size_t e)
+        {
+            for (size_t i = s; i < e; i++)
+            {
+                auto data = hash.find(keys[i]);
+                if (data == hash.end() || (*data).second != i+2)
+                {
+                    printf("erro find sucess \n");
+                    ++err;
+                }
+            }
+        });
+
+    errors.fetch_add(err, std::memory_order_relaxed);
+    return 0;
+}
+
+// the main thread visits the table (parallel_for_each, then
+// parallel_reduce with p threads each), the other threads insert the
+// elements in [n, 2n) meanwhile, only the first n elements (data in
+// [2, n+2)) are counted
+template <class Hash>
+int scan_concurrently(Hash& hash, size_t n, size_t p, bool m)
+{
+    if (! m) return fill(hash, 2*n);
+
+    auto handles = []() { return hash_table.get_handle(); };
+    for (size_t i = 0; i < n; ++i) visits[i].store(0);
+    growt::parallel_for_each(handles,
+                             [n](const uint64_t&, const uint64_t& d)
+                             { if (d-2 < n) visits[d-2].fetch_add(1); },
+                             p);
+
+    auto sum = growt::parallel_reduce(handles, size_t(0),
+                   [n](const uint64_t&, const uint64_t& d) -> size_t
+                   { return (d-2 < n) ? d : 0; },
+                   [](size_t a, size_t b) { return a + b; },
+                   p);
+
+    auto err = 0u;
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (visits[i].load() != 1)
+        {
+            printf("erro for_each visits %lu \n", visits[i].load());
+            ++err;
+        }
+    }
+    // the sum of i+2 over all i < n
+    if (sum != n*(n-1)/2 + 2*n)
+    {
+        printf("erro reduce sum (off by %ld) \n",
+               long(sum - (n*(n-1)/2 + 2*n)));
+        ++err;
+    }
+    errors.fetch_add(err, std::memory_order_relaxed);
+    return 0;
+}
+
+// the main thread continues the scan at scan_cursor (visiting at least max
+// elements), only the first n elements are counted
+template <class Hash>
+int scan_step(Hash& hash, size_t n, size_t max, bool m)
+{
+    if (! m) return 0;
+
+    scan_cursor.store(hash.scan(scan_cursor.load(), max,
+                                [n](const uint64_t&, const uint64_t& d)
+                                { if (d-2 < n) visits[d-2].fetch_add(1); }));
+    return 0;
+}
+
+// errors if one of the first n elements was not visited (checked by the
+// main thread)
+int check_scanned(size_t n, bool m)
+{
+    if (! m) return 0;
+
+    auto err = 0u;
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (! visits[i].load())
+        {
+            printf("erro scan missed \n");
+            ++err;
+        }
+    }
+    errors.fetch_add(err, std::memory_order_relaxed);
+    return 0;
+}
+
+// errors if the table did not migrate the expected number of times since
+// migr (checked by the main thread)
+template <class Hash>
+int check_migrations(Hash& hash, size_t migr, size_t expected, bool m)
+{
+    if (m && hash.migration_count() - migr != expected)
+    {
+        printf("erro migrations %lu (expected %lu) \n",
+               hash.migration_count() - migr, expected);
+        errors.fetch_add(1, std::memory_order_relaxed);
+    }
+    return 0;
+}
+
+template <class ThreadType>
+struct test_in_stages
+{
+    static int execute(ThreadType t, size_t n, size_t cap, size_t it)
+    {
+        using Handle = typename HASHTYPE::Handle;
+
+        utils_tm::pin_to_core(t.id);
+
+        if (ThreadType::is_main)
+        {
+            keys     = new uint64_t[3*n];
+            elements = new std::pair<uint64_t, uint64_t>[n];
+            visits   = new std::atomic_size_t[n];
+        }
+
+        // STAGE0 Create Distinct Keys
+        {
+            if (ThreadType::is_main) current_block.store (0);
+            t.synchronized(generate_distinct, n);
+        }
+
+        for (size_t i = 0; i < it; ++i)
+        {
+            t.synchronized([cap](bool m)
+                           {
+                               if (m)
+                               {
+                                   hash_table  = HASHTYPE(cap);
+                                   build_table = HASHTYPE(cap);
+                               }
+                               return 0;
+                           },
+                           ThreadType::is_main);
+
+            t.out << otm::width(3) << i
+                  << otm::width(3) << t.p
+                  << otm::width(9) << n
+                  << otm::width(9) << cap;
+
+            t.synchronize();
+
+            Handle hash = hash_table.get_handle();
+            size_t migr = hash.migration_count();
+            size_t c0   = hash.capacity();
+
+            t.synchronize();
+            // STAGE1 Reserve n
+            {
+                auto duration = t.synchronized([n](Handle& hash, bool m)
+                                               { if (m) hash.reserve(n);
+                                                 return 0; },
+                                               hash, ThreadType::is_main);
+                t.out << otm::width(10) << duration.second/1000000.;
+                t.synchronized(check_migrations<Handle>, hash, migr,
+                               size_t(hash.capacity() != c0),
+                               ThreadType::is_main);
+                migr = hash.migration_count();
+            }
+
+            // STAGE2 n Insertions (and Finds)
+            {
+                if (ThreadType::is_main) current_block.store(0);
+
+                auto duration = t.synchronized(fill<Handle>, hash, n);
+                t.out << otm::width(10) << duration.second/1000000.;
+
+                if (ThreadType::is_main) current_block.store(0);
+                t.synchronized(find<Handle>, hash, n);
+                t.synchronized(check_migrations<Handle>, hash, migr, 0,
+                               ThreadType::is_main);
+            }
+
+            // STAGE3 Build from n Elements (and n Finds)
+            {
+                Handle bhash = build_table.get_handle();
+                size_t bmigr = bhash.migration_count();
+                size_t bc0   = bhash.capacity();
+
+                auto duration = t.synchronized(
+                    [n, p = t.p](Handle& bhash, bool m)
+                    {
+                        if (m && bhash.build(elements, n, p) != n)
+                        {
+                            printf("erro build count \n");
+                            errors.fetch_add(1, std::memory_order_relaxed);
+                        }
+                        return 0;
+                    }, bhash, ThreadType::is_main);
+                t.out << otm::width(10) << duration.second/1000000.;
+
+                if (ThreadType::is_main) current_block.store(0);
+                t.synchronized(find<Handle>, bhash, n);
+                t.synchronized(check_migrations<Handle>, bhash, bmigr,
+                               size_t(bhash.capacity() != bc0),
+                               ThreadType::is_main);
+            }
+
+            // STAGE4 Parallel Scans (while n Insertions migrate the table)
+            {
+                size_t smigr = hash.migration_count();
+                if (ThreadType::is_main) current_block.store(n);
+
+                auto duration = t.synchronized(scan_concurrently<Handle>,
+                                               hash, n, t.p,
+                                               ThreadType::is_main);
+                t.out << otm::width(10) << duration.second/1000000.;
+                t.out << otm::width(6)  << hash.migration_count() - smigr;
+            }
+
+            // STAGE5 Resumable Scan (n Insertions grow the table between
+            //                        its steps)
+            {
+                Handle bhash = build_table.get_handle();
+                size_t rmigr = bhash.migration_count();
+                size_t step  = std::max<size_t>(n/8, 1);
+                size_t ins   = 2*n;
+                double time  = 0.;
+
+                if (ThreadType::is_main)
+                {
+                    scan_cursor.store(0);
+                    for (size_t j = 0; j < n; ++j) visits[j].store(0);
+                }
+
+                do
+                {
+                    auto duration = t.synchronized(scan_step<Handle>, bhash,
+                                                   n, step,
+                                                   ThreadType::is_main);
+                    time += duration.second/1000000.;
+
+                    if (ThreadType::is_main) current_block.store(ins);
+                    ins = std::min(ins + step, 3*n);
+                    t.synchronized(fill<Handle>, bhash, ins);
+                } while (scan_cursor.load());
+
+                t.out << otm::width(10) << time;
+                t.out << otm::width(6)  << bhash.migration_count() - rmigr;
+                t.synchronized(check_scanned, n, ThreadType::is_main);
+            }
+
+            t.out << otm::width(10) << errors.load();
+            t.out << std::endl;
+            if (ThreadType::is_main) errors.store(0);
+        }
+
+        if (ThreadType::is_main)
+        {
+            delete[] keys;
+            delete[] elements;
+            delete[] visits;
+        }
+
+        return 0;
+    }
+};
+
+
+
+int main(int argn, char** argc)
+{
+    utils_tm::command_line_parser c{argn, argc};
+    size_t n   = c.int_arg("-n" , 10000000);
+    size_t p   = c.int_arg("-p" , 4);
+    size_t cap = c.int_arg("-c" , 1000);
+    size_t it  = c.int_arg("-it", 5);
+    if (! c.report()) return 1;
+
+    otm::out() << otm::width(3)  << "#i"
+               << otm::width(3)  << "p"
+               << otm::width(9)  << "n"
+               << otm::width(9)  << "cap"
+               << otm::width(10) << "t_reserve"
+               << otm::width(10) << "t_ins"
+               << otm::width(10) << "t_build"
+               << otm::width(10) << "t_scan"
+               << otm::width(6)  << "migr"
+               << otm::width(10) << "t_rscan"
+               << otm::width(6)  << "rmigr"
+               << otm::width(10) << "errors"
+               << std::endl;
+
+    ttm::start_threads<test_in_stages>(p, n, cap, it);
+    return 0;
+}
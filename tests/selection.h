@@ -66,6 +66,25 @@
                                     ALLOCATOR<> >
 #endif // XFOLKLORE
 
+#ifdef FOLKLORE_SOA
+#include "data-structures/base_soa.h"
+#define HASHTYPE growt::BaseSoA<HASHFCT, ALLOCATOR<> >
+#endif // FOLKLORE_SOA
+
+#ifdef FOLKLORE_TAG
+#include "data-structures/simpleelement.h"
+#include "data-structures/tag_circular.h"
+#define HASHTYPE growt::TagCircular<growt::SimpleElement, HASHFCT, \
+                                    ALLOCATOR<> >
+#endif // FOLKLORE_TAG
+
+#ifdef FOLKLORE_RH
+#include "data-structures/simpleelement.h"
+#include "data-structures/robin_circular.h"
+#define HASHTYPE growt::RobinCircular<growt::SimpleElement, HASHFCT, \
+                                      ALLOCATOR<> >
+#endif // FOLKLORE_RH
+
 
 
 
@@ -83,6 +102,18 @@
 
 #endif // UAGROW
 
+#ifdef UIGROW
+#include "data-structures/markableelement.h"
+#include "data-structures/base_circular.h"
+#include "data-structures/strategy/wstrat_user.h"
+#include "data-structures/strategy/estrat_incremental.h"
+#include "data-structures/ancient_grow.h"
+#define HASHTYPE growt::GrowTable<growt::BaseCircular<growt::MarkableElement, \
+                                                  HASHFCT, \
+                                                  ALLOCATOR<> >, \
+                                  growt::WStratUser, growt::EStratIncremental>
+#endif // UIGROW
+
 #ifdef PAGROW
 #include "data-structures/markableelement.h"
 #include "data-structures/base_circular.h"
@@ -143,6 +174,276 @@
                                   growt::WStratPool, growt::EStratSyncNUMA>
 #endif // PSNGROW
 
+#ifdef USGROW_SOA
+#include "data-structures/base_soa.h"
+#include "data-structures/strategy/wstrat_user.h"
+#include "data-structures/strategy/estrat_sync.h"
+#include "data-structures/ancient_grow.h"
+#define HASHTYPE growt::GrowTable<growt::BaseSoA<HASHFCT, ALLOCATOR<> >, \
+                                  growt::WStratUser, growt::EStratSync>
+#endif // USGROW_SOA
+
+#ifdef PSGROW_SOA
+#include "data-structures/base_soa.h"
+#include "data-structures/strategy/wstrat_pool.h"
+#include "data-structures/strategy/estrat_sync.h"
+#include "data-structures/ancient_grow.h"
+#define HASHTYPE growt::GrowTable<growt::BaseSoA<HASHFCT, ALLOCATOR<> >, \
+                                  growt::WStratPool, growt::EStratSync>
+#endif // PSGROW_SOA
+
+#ifdef UAGROW_TAG
+#include "data-structures/markableelement.h"
+#include "data-structures/tag_circular.h"
+#include "data-structures/strategy/wstrat_user.h"
+#include "data-structures/strategy/estrat_async.h"
+#include "data-structures/ancient_grow.h"
+#define HASHTYPE growt::GrowTable<growt::TagCircular<growt::MarkableElement, \
+                                                 HASHFCT, \
+                                                 ALLOCATOR<> >, \
+                                  growt::WStratUser, growt::EStratAsync>
+#endif // UAGROW_TAG
+
+#ifdef USGROW_TAG
+#include "data-structures/markableelement.h"
+#include "data-structures/tag_circular.h"
+#include "data-structures/strategy/wstrat_user.h"
+#include "data-structures/strategy/estrat_sync.h"
+#include "data-structures/ancient_grow.h"
+#define HASHTYPE growt::GrowTable<growt::TagCircular<growt::MarkableElement, \
+                                                 HASHFCT, \
+                                                 ALLOCATOR<> >, \
+                                  growt::WStratUser, growt::EStratSync>
+#endif // USGROW_TAG
+
+#ifdef USGROW_RH
+#include "data-structures/markableelement.h"
+#include "data-structures/robin_circular.h"
+#include "data-structures/strategy/wstrat_user.h"
+#include "data-structures/strategy/estrat_sync.h"
+#include "data-structures/ancient_grow.h"
+#define HASHTYPE growt::GrowTable<growt::RobinCircular<growt::MarkableElement, \
+                                                   HASHFCT, \
+                                                   ALLOCATOR<> >, \
+                                  growt::WStratUser, growt::EStratSync>
+#endif // USGROW_RH
+
+#ifdef PSGROW_RH
+#include "data-structures/markableelement.h"
+#include "data-structures/robin_circular.h"
+#include "data-structures/strategy/wstrat_pool.h"
+#include "data-structures/strategy/estrat_sync.h"
+#include "data-structures/ancient_grow.h"
+#define HASHTYPE growt::GrowTable<growt::RobinCircular<growt::MarkableElement, \
+                                                   HASHFCT, \
+                                                   ALLOCATOR<> >, \
+                                  growt::WStratPool, growt::EStratSync>
+#endif // PSGROW_RH
+
+#ifdef UAGROW_15
+#include "data-structures/markableelement.h"
+#include "data-structures/base_circular.h"
+#include "data-structures/strategy/wstrat_user.h"
+#include "data-structures/strategy/estrat_async.h"
+#include "data-structures/ancient_grow.h"
+#define HASHTYPE growt::GrowTable<growt::BaseCircular<growt::MarkableElement, \
+                                                  HASHFCT, \
+                                                  ALLOCATOR<>, \
+                                                  growt::NoProbeStats, \
+                                                  growt::GrowFactor<3,2> >, \
+                                  growt::WStratUser, growt::EStratAsync>
+#endif // UAGROW_15
+
+#ifdef USGROW_15
+#include "data-structures/markableelement.h"
+#include "data-structures/base_circular.h"
+#include "data-structures/strategy/wstrat_user.h"
+#include "data-structures/strategy/estrat_sync.h"
+#include "data-structures/ancient_grow.h"
+#define HASHTYPE growt::GrowTable<growt::BaseCircular<growt::MarkableElement, \
+                                                  HASHFCT, \
+                                                  ALLOCATOR<>, \
+                                                  growt::NoProbeStats, \
+                                                  growt::GrowFactor<3,2> >, \
+                                  growt::WStratUser, growt::EStratSync>
+#endif // USGROW_15
+
+#ifdef UAGROW_PSTATS
+#include "data-structures/markableelement.h"
+#include "data-structures/base_circular.h"
+#include "data-structures/strategy/wstrat_user.h"
+#include "data-structures/strategy/estrat_async.h"
+#include "data-structures/ancient_grow.h"
+#define HASHTYPE growt::GrowTable<growt::BaseCircular<growt::MarkableElement, \
+                                                  HASHFCT, \
+                                                  ALLOCATOR<>, \
+                                                  growt::ProbeStats>, \
+                                  growt::WStratUser, growt::EStratAsync>
+#endif // UAGROW_PSTATS
+
+#ifdef USGROW_PSTATS
+#include "data-structures/markableelement.h"
+#include "data-structures/base_circular.h"
+#include "data-structures/strategy/wstrat_user.h"
+#include "data-structures/strategy/estrat_sync.h"
+#include "data-structures/ancient_grow.h"
+#define HASHTYPE growt::GrowTable<growt::BaseCircular<growt::MarkableElement, \
+                                                  HASHFCT, \
+                                                  ALLOCATOR<>, \
+                                                  growt::ProbeStats>, \
+                                  growt::WStratUser, growt::EStratSync>
+#endif // USGROW_PSTATS
+
+// packed elements only hold 31 bit keys, tests draw their keys from
+// [2, KEY_RANGE] (see PackedElement::valid_key)
+#ifdef FOLKLORE_PACKED
+#include "data-structures/packedelement.h"
+#include "data-structures/base_circular.h"
+#define HASHTYPE growt::BaseCircular<growt::PackedElement<32,32>, HASHFCT, \
+                                 ALLOCATOR<> >
+#define KEY_RANGE ((1ull << 31) - 2)
+#endif // FOLKLORE_PACKED
+
+#ifdef UAGROW_PACKED
+#include "data-structures/packedelement.h"
+#include "data-structures/base_circular.h"
+#include "data-structures/strategy/wstrat_user.h"
+#include "data-structures/strategy/estrat_async.h"
+#include "data-structures/ancient_grow.h"
+#define HASHTYPE growt::GrowTable<growt::BaseCircular<growt::PackedElement<32,32>, \
+                                                  HASHFCT, ALLOCATOR<> >, \
+                                  growt::WStratUser, growt::EStratAsync>
+#define KEY_RANGE ((1ull << 31) - 2)
+#endif // UAGROW_PACKED
+
+#ifdef USGROW_PACKED
+#include "data-structures/packedelement.h"
+#include "data-structures/base_circular.h"
+#include "data-structures/strategy/wstrat_user.h"
+#include "data-structures/strategy/estrat_sync.h"
+#include "data-structures/ancient_grow.h"
+#define HASHTYPE growt::GrowTable<growt::BaseCircular<growt::PackedElement<32,32>, \
+                                                  HASHFCT, ALLOCATOR<> >, \
+                                  growt::WStratUser, growt::EStratSync>
+#define KEY_RANGE ((1ull << 31) - 2)
+#endif // USGROW_PACKED
+
+// sets (only for set_test, see GrowSetHandle), built on grow_table.h
+// (instead of ancient_grow.h) like the sets in definitions.h
+#ifdef UAGROW_SET
+#include "data-structures/packedelement.h"
+#include "data-structures/base_circular.h"
+#include "data-structures/strategy/wstrat_user.h"
+#include "data-structures/strategy/estrat_async.h"
+#include "data-structures/grow_set.h"
+#define HASHTYPE growt::GrowSet<growt::BaseCircular<growt::PackedElement<64,0>, \
+                                                HASHFCT, ALLOCATOR<> >, \
+                                growt::WStratUser, growt::EStratAsync>
+#endif // UAGROW_SET
+
+#ifdef USGROW_SET
+#include "data-structures/packedelement.h"
+#include "data-structures/base_circular.h"
+#include "data-structures/strategy/wstrat_user.h"
+#include "data-structures/strategy/estrat_sync.h"
+#include "data-structures/grow_set.h"
+#define HASHTYPE growt::GrowSet<growt::BaseCircular<growt::PackedElement<64,0>, \
+                                                HASHFCT, ALLOCATOR<> >, \
+                                growt::WStratUser, growt::EStratSync>
+#endif // USGROW_SET
+
+// string keys (only for str_test, HASHFCT is replaced by StringKeyHash)
+#ifdef UAGROW_STRING
+#include "data-structures/stringelement.h"
+#include "data-structures/base_circular.h"
+#include "data-structures/strategy/wstrat_user.h"
+#include "data-structures/strategy/estrat_async.h"
+#include "data-structures/grow_table.h"
+#define HASHTYPE growt::GrowTable<growt::BaseCircular<growt::StringElement, \
+                                                  growt::StringKeyHash, \
+                                                  ALLOCATOR<> >, \
+                                  growt::WStratUser, growt::EStratAsync>
+#endif // UAGROW_STRING
+
+#ifdef USGROW_STRING
+#include "data-structures/stringelement.h"
+#include "data-structures/base_circular.h"
+#include "data-structures/strategy/wstrat_user.h"
+#include "data-structures/strategy/estrat_sync.h"
+#include "data-structures/grow_table.h"
+#define HASHTYPE growt::GrowTable<growt::BaseCircular<growt::StringElement, \
+                                                  growt::StringKeyHash, \
+                                                  ALLOCATOR<> >, \
+                                  growt::WStratUser, growt::EStratSync>
+#endif // USGROW_STRING
+
+// inline values of six words, i.e., 64 byte cells (only for wide_test)
+#ifdef UAGROW_WIDE
+#include <array>
+#include "data-structures/wideelement.h"
+#include "data-structures/base_circular.h"
+#include "data-structures/strategy/wstrat_user.h"
+#include "data-structures/strategy/estrat_async.h"
+#include "data-structures/grow_table.h"
+#define HASHTYPE growt::GrowTable<growt::BaseCircular< \
+                                      growt::WideElement<std::array<uint64_t,6> >, \
+                                      HASHFCT, ALLOCATOR<> >, \
+                                  growt::WStratUser, growt::EStratAsync>
+#endif // UAGROW_WIDE
+
+#ifdef USGROW_WIDE
+#include <array>
+#include "data-structures/wideelement.h"
+#include "data-structures/base_circular.h"
+#include "data-structures/strategy/wstrat_user.h"
+#include "data-structures/strategy/estrat_sync.h"
+#include "data-structures/grow_table.h"
+#define HASHTYPE growt::GrowTable<growt::BaseCircular< \
+                                      growt::WideElement<std::array<uint64_t,6> >, \
+                                      HASHFCT, ALLOCATOR<> >, \
+                                  growt::WStratUser, growt::EStratSync>
+#endif // USGROW_WIDE
+
+#ifdef FOLKLORE_OCC
+#include "data-structures/simpleelement.h"
+#include "data-structures/base_circular.h"
+#define HASHTYPE growt::BaseCircular<growt::SimpleElement, HASHFCT, \
+                                 ALLOCATOR<>, \
+                                 growt::NoProbeStats, \
+                                 growt::GrowDouble, \
+                                 growt::OccupancySummary >
+#endif // FOLKLORE_OCC
+
+#ifdef UAGROW_OCC
+#include "data-structures/markableelement.h"
+#include "data-structures/base_circular.h"
+#include "data-structures/strategy/wstrat_user.h"
+#include "data-structures/strategy/estrat_async.h"
+#include "data-structures/ancient_grow.h"
+#define HASHTYPE growt::GrowTable<growt::BaseCircular<growt::MarkableElement, \
+                                                  HASHFCT, \
+                                                  ALLOCATOR<>, \
+                                                  growt::NoProbeStats, \
+                                                  growt::GrowDouble, \
+                                                  growt::OccupancySummary >, \
+                                  growt::WStratUser, growt::EStratAsync>
+#endif // UAGROW_OCC
+
+#ifdef USGROW_OCC
+#include "data-structures/simpleelement.h"
+#include "data-structures/base_circular.h"
+#include "data-structures/strategy/wstrat_user.h"
+#include "data-structures/strategy/estrat_sync.h"
+#include "data-structures/ancient_grow.h"
+#define HASHTYPE growt::GrowTable<growt::BaseCircular<growt::SimpleElement, \
+                                                  HASHFCT, \
+                                                  ALLOCATOR<>, \
+                                                  growt::NoProbeStats, \
+                                                  growt::GrowDouble, \
+                                                  growt::OccupancySummary >, \
+                                  growt::WStratUser, growt::EStratSync>
+#endif // USGROW_OCC
+
 
 
 
@@ -0,0 +1,273 @@
+/*******************************************************************************
+ * tests/set_test.cpp
+ *
+ * basic insert, contains, and erase test for sets, for more information
+ * see below
+ *
+ * Part of Project growt - https://github.com/TooBiased/growt.git
+ *
+ * Copyright (C) 2015-2016 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include "tests/selection.h"
+
+#include "utils/default_hash.hpp"
+#include "utils/thread_coordination.hpp"
+#include "utils/pin_thread.hpp"
+#include "utils/command_line_parser.hpp"
+#include "utils/output.hpp"
+
+#include <random>
+#include <iostream>
+#include <vector>
+
+/*
+ * This Test is meant to test sets (e.g. GrowSet) on uniform random inputs.
+ * 0. Creating 2n random keys
+ * 1. Inserting n keys
+ * 2. Inserting the same n keys again (none of them is new)
+ * 3. Looking for n keys - using different keys (likely not finding any)
+ * 4. Looking for the n inserted keys (hopefully finding all)
+ * 5. Erasing every second inserted key, and looking for all inserted keys
+ *    (finding exactly the remaining ones)
+ * With -ibatch b, step 1 uses batched insertions (insert_batch with b keys
+ * per call).
+ */
+
+const static uint64_t range = (1ull << 62) -1;
+namespace otm = utils_tm::out_tm;
+namespace ttm = utils_tm::thread_tm;
+
+alignas(64) static uint64_t* keys;
+alignas(64) static std::atomic_size_t current_block;
+alignas(64) static std::atomic_size_t errors;
+
+alignas(64) static HASHTYPE hash_table = HASHTYPE(0);
+int generate_random(size_t n)
+{
+    std::uniform_int_distribution<uint64_t> dis(2,range);
+
+    ttm::execute_blockwise_parallel(current_block, n,
+        [&dis](size_t s, size_t e)
+        {
+            std::mt19937_64 re(s*10293903128401092ull);
+
+            for (size_t i = s; i < e; i++)
+            {
+                keys[i] = dis(re);
+            }
+        });
+
+    return 0;
+}
+
+// new keys are only expected in the first round
+template <class Hash>
+int fill(Hash& hash, size_t end, bool first)
+{
+    auto err = 0u;
+
+    ttm::execute_blockwise_parallel(current_block, end,
+        [&hash, &err, first](size_t s, size_t e)
+        {
+            for (size_t i = s; i < e; i++)
+            {
+                if (hash.insert(keys[i]) != first) ++err;
+            }
+        });
+
+    errors.fetch_add(err, std::memory_order_relaxed);
+    return 0;
+}
+
+template <class Hash>
+int fill_batch(Hash& hash, size_t end, size_t batch)
+{
+    auto err = 0u;
+
+    ttm::execute_blockwise_parallel(current_block, end,
+        [&hash, &err, batch](size_t s, size_t e)
+        {
+            for (size_t b = s; b < e; b += batch)
+            {
+                auto size = std::min(batch, e-b);
+                if (hash.insert_batch(keys+b, size) != size) ++err;
+            }
+        });
+
+    errors.fetch_add(err, std::memory_order_relaxed);
+    return 0;
+}
+
+// inserted keys with an odd index below erased are expected to be erased
+template <class Hash>
+int find(Hash& hash, size_t end, size_t erased, bool succ)
+{
+    auto err = 0u;
+
+    ttm::execute_blockwise_parallel(current_block, end,
+        [&hash, &err, erased, succ](size_t s, size_t e)
+        {
+            for (size_t i = s; i < e; i++)
+            {
+                bool expected = succ && (i >= erased || !(i & 1));
+                if (hash.contains(keys[i]) != expected)
+                {
+                    printf("erro contains %s \n", expected ? "sucess"
+                                                           : "unsucess");
+                    ++err;
+                }
+            }
+        });
+
+    errors.fetch_add(err, std::memory_order_relaxed);
+    return 0;
+}
+
+template <class Hash>
+int erase(Hash& hash, size_t end)
+{
+    auto err = 0u;
+
+    ttm::execute_blockwise_parallel(current_block, end,
+        [&hash, &err](size_t s, size_t e)
+        {
+            for (size_t i = s | 1; i < e; i += 2)
+            {
+                if (hash.erase(keys[i]) != 1) ++err;
+            }
+        });
+
+    errors.fetch_add(err, std::memory_order_relaxed);
+    return 0;
+}
+
+template <class ThreadType>
+struct test_in_stages
+{
+    static int execute(ThreadType t, size_t n, size_t cap, size_t it,
+                       size_t ibatch)
+    {
+        using Handle = typename HASHTYPE::Handle;
+
+        utils_tm::pin_to_core(t.id);
+
+        if (ThreadType::is_main)
+        {
+            keys = new uint64_t[2*n];
+        }
+
+        // STAGE0 Create Random Keys
+        {
+            if (ThreadType::is_main) current_block.store (0);
+            t.synchronized(generate_random, 2*n);
+        }
+
+        for (size_t i = 0; i < it; ++i)
+        {
+            t.synchronized([cap](bool m)
+                           { if (m) hash_table = HASHTYPE(cap); return 0; },
+                           ThreadType::is_main);
+
+            t.out << otm::width(3) << i
+                  << otm::width(3) << t.p
+                  << otm::width(9) << n
+                  << otm::width(9) << cap;
+
+            t.synchronize();
+
+            Handle hash = hash_table.get_handle();
+
+            t.synchronize();
+            // STAGE1 n Insertions
+            {
+                if (ThreadType::is_main) current_block.store(0);
+
+                auto duration = (ibatch)
+                    ? t.synchronized(fill_batch<Handle>, hash, n, ibatch)
+                    : t.synchronized(fill<Handle>, hash, n, true);
+
+                t.out << otm::width(10) << duration.second/1000000.;
+            }
+
+            // STAGE2 n Repeated Insertions
+            {
+                if (ThreadType::is_main) current_block.store(0);
+
+                auto duration = t.synchronized(fill<Handle>, hash, n, false);
+
+                t.out << otm::width(10) << duration.second/1000000.;
+            }
+
+            // STAGE3 n Contains Unsuccessful
+            {
+                if (ThreadType::is_main) current_block.store(n);
+
+                auto duration = t.synchronized(find<Handle>,
+                                               hash, 2*n, 0, false);
+                t.out << otm::width(10) << duration.second/1000000.;
+            }
+
+            // STAGE4 n Contains Successful
+            {
+                if (ThreadType::is_main) current_block.store(0);
+
+                auto duration = t.synchronized(find<Handle>,
+                                               hash, n, 0, true);
+                t.out << otm::width(10) << duration.second/1000000.;
+            }
+
+            // STAGE5 n/2 Erasures
+            {
+                if (ThreadType::is_main) current_block.store(0);
+
+                auto duration = t.synchronized(erase<Handle>, hash, n);
+                t.out << otm::width(10) << duration.second/1000000.;
+
+                if (ThreadType::is_main) current_block.store(0);
+                t.synchronized(find<Handle>, hash, n, n, true);
+            }
+
+            t.out << otm::width(10) << errors.load();
+            t.out << std::endl;
+            if (ThreadType::is_main) errors.store(0);
+        }
+
+        if (ThreadType::is_main)
+        {
+            delete[] keys;
+        }
+
+        return 0;
+    }
+};
+
+
+
+int main(int argn, char** argc)
+{
+    utils_tm::command_line_parser c{argn, argc};
+    size_t n   = c.int_arg("-n" , 10000000);
+    size_t p   = c.int_arg("-p" , 4);
+    size_t cap = c.int_arg("-c" , n);
+    size_t it  = c.int_arg("-it", 5);
+    size_t ibat= c.int_arg("-ibatch", 0);
+    if (! c.report()) return 1;
+
+    otm::out() << otm::width(3)  << "#i"
+               << otm::width(3)  << "p"
+               << otm::width(9)  << "n"
+               << otm::width(9)  << "cap"
+               << otm::width(10) << "t_ins"
+               << otm::width(10) << "t_ins_re"
+               << otm::width(10) << "t_cont_-"
+               << otm::width(10) << "t_cont_+"
+               << otm::width(10) << "t_erase"
+               << otm::width(7)  << "errors"
+               << std::endl;
+
+    ttm::start_threads<test_in_stages>(p, n, cap, it, ibat);
+    return 0;
+}
@@ -0,0 +1,276 @@
+/*******************************************************************************
+ * tests/wide_test.cpp
+ *
+ * insert, find, and update test for tables with wide (inline) values, for
+ * more information see below
+ *
+ * Part of Project growt - https://github.com/TooBiased/growt.git
+ *
+ * Copyright (C) 2015-2016 Tobias Maier <t.maier@kit.edu>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include "tests/selection.h"
+
+#include "utils/default_hash.hpp"
+#include "utils/thread_coordination.hpp"
+#include "utils/pin_thread.hpp"
+#include "utils/command_line_parser.hpp"
+#include "utils/output.hpp"
+
+#include <random>
+#include <iostream>
+
+/*
+ * This Test is meant to test tables with values of several words (e.g.
+ * uaGrowWide), all words of a value are equal, thus, torn reads would be
+ * detected.
+ * 0. Creating 2n random keys
+ * 1. Inserting n elements (key, index in every word)
+ * 2. Looking for n elements - using different keys (likely not finding any)
+ * 3. Looking for the n inserted elements (hopefully finding all)
+ *    (correctness test using the index)
+ * 4. Incrementing all words of every second element (insert_or_update),
+ *    each update is followed by a lookup of another element (its words
+ *    have to be equal, even if it is updated concurrently)
+ * 5. Looking for the n inserted elements (checking the updates)
+ */
+
+using wide_value = typename HASHTYPE::Handle::mapped_type;
+
+const static uint64_t range = (1ull << 62) -1;
+namespace otm = utils_tm::out_tm;
+namespace ttm = utils_tm::thread_tm;
+
+alignas(64) static uint64_t* keys;
+alignas(64) static std::atomic_size_t current_block;
+alignas(64) static std::atomic_size_t errors;
+
+alignas(64) static HASHTYPE hash_table = HASHTYPE(0);
+
+wide_value make_value(uint64_t d)
+{
+    wide_value v;
+    for (auto& w : v) w = d;
+    return v;
+}
+
+// returns 0 if the words of v differ
+uint64_t value_of(const wide_value& v)
+{
+    for (auto& w : v) if (w != v[0]) return 0;
+    return v[0];
+}
+
+struct IncrementAll
+{
+    void operator()(wide_value& lhs, uint64_t rhs) const
+    { for (auto& w : lhs) w += rhs; }
+};
+
+int generate_random(size_t n)
+{
+    std::uniform_int_distribution<uint64_t> dis(2,range);
+
+    ttm::execute_blockwise_parallel(current_block, n,
+        [&dis](size_t s, size_t e)
+        {
+            std::mt19937_64 re(s*10293903128401092ull);
+
+            for (size_t i = s; i < e; i++)
+            {
+                keys[i] = dis(re);
+            }
+        });
+
+    return 0;
+}
+
+template <class Hash>
+int fill(Hash& hash, size_t end)
+{
+    auto err = 0u;
+
+    ttm::execute_blockwise_parallel(current_block, end,
+        [&hash, &err](size_t s, size_t e)
+        {
+            for (size_t i = s; i < e; i++)
+            {
+                if (! hash.insert(keys[i], make_value(i+2)).second) ++err;
+            }
+        });
+
+    errors.fetch_add(err, std::memory_order_relaxed);
+    return 0;
+}
+
+template <class Hash>
+int update(Hash& hash, size_t end)
+{
+    auto err = 0u;
+
+    ttm::execute_blockwise_parallel(current_block, end,
+        [&hash, &err, end](size_t s, size_t e)
+        {
+            for (size_t i = s & ~1ull; i < e; i += 2)
+            {
+                if (hash.insert_or_update(keys[i], make_value(0),
+                                          IncrementAll(), 1).second) ++err;
+
+                auto data = hash.find(keys[(i*7919+1) % end]);
+                if (data == hash.end() || ! value_of((*data).second))
+                {
+                    printf("erro find torn \n");
+                    ++err;
+                }
+            }
+        });
+
+    errors.fetch_add(err, std::memory_order_relaxed);
+    return 0;
+}
+
+// inserted elements with an even index below updated are incremented
+template <class Hash>
+int find(Hash& hash, size_t end, size_t updated, bool succ)
+{
+    auto err = 0u;
+
+    ttm::execute_blockwise_parallel(current_block, end,
+        [&hash, &err, updated, succ](size_t s, size_t e)
+        {
+            for (size_t i = s; i < e; i++)
+            {
+                auto data = hash.find(keys[i]);
+                if ((data != hash.end()) != succ)
+                {
+                    printf("erro find %s \n", succ ? "sucess" : "unsucess");
+                    ++err;
+                }
+                else if (succ && value_of((*data).second)
+                                 != i+2 + (i < updated && !(i & 1)))
+                {
+                    printf("erro find data \n");
+                    ++err;
+                }
+            }
+        });
+
+    errors.fetch_add(err, std::memory_order_relaxed);
+    return 0;
+}
+
+template <class ThreadType>
+struct test_in_stages
+{
+    static int execute(ThreadType t, size_t n, size_t cap, size_t it)
+    {
+        using Handle = typename HASHTYPE::Handle;
+
+        utils_tm::pin_to_core(t.id);
+
+        if (ThreadType::is_main)
+        {
+            keys = new uint64_t[2*n];
+        }
+
+        // STAGE0 Create Random Keys
+        {
+            if (ThreadType::is_main) current_block.store (0);
+            t.synchronized(generate_random, 2*n);
+        }
+
+        for (size_t i = 0; i < it; ++i)
+        {
+            t.synchronized([cap](bool m)
+                           { if (m) hash_table = HASHTYPE(cap); return 0; },
+                           ThreadType::is_main);
+
+            t.out << otm::width(3) << i
+                  << otm::width(3) << t.p
+                  << otm::width(9) << n
+                  << otm::width(9) << cap;
+
+            t.synchronize();
+
+            Handle hash = hash_table.get_handle();
+
+            t.synchronize();
+            // STAGE1 n Insertions
+            {
+                if (ThreadType::is_main) current_block.store(0);
+
+                auto duration = t.synchronized(fill<Handle>, hash, n);
+
+                t.out << otm::width(10) << duration.second/1000000.;
+            }
+
+            // STAGE2 n Finds Unsuccessful
+            {
+                if (ThreadType::is_main) current_block.store(n);
+
+                auto duration = t.synchronized(find<Handle>,
+                                               hash, 2*n, 0, false);
+                t.out << otm::width(10) << duration.second/1000000.;
+            }
+
+            // STAGE3 n Finds Successful
+            {
+                if (ThreadType::is_main) current_block.store(0);
+
+                auto duration = t.synchronized(find<Handle>,
+                                               hash, n, 0, true);
+                t.out << otm::width(10) << duration.second/1000000.;
+            }
+
+            // STAGE4 n/2 Updates (and n/2 Finds)
+            {
+                if (ThreadType::is_main) current_block.store(0);
+
+                auto duration = t.synchronized(update<Handle>, hash, n);
+                t.out << otm::width(10) << duration.second/1000000.;
+
+                if (ThreadType::is_main) current_block.store(0);
+                t.synchronized(find<Handle>, hash, n, n, true);
+            }
+
+            t.out << otm::width(10) << errors.load();
+            t.out << std::endl;
+            if (ThreadType::is_main) errors.store(0);
+        }
+
+        if (ThreadType::is_main)
+        {
+            delete[] keys;
+        }
+
+        return 0;
+    }
+};
+
+
+
+int main(int argn, char** argc)
+{
+    utils_tm::command_line_parser c{argn, argc};
+    size_t n   = c.int_arg("-n" , 10000000);
+    size_t p   = c.int_arg("-p" , 4);
+    size_t cap = c.int_arg("-c" , n);
+    size_t it  = c.int_arg("-it", 5);
+    if (! c.report()) return 1;
+
+    otm::out() << otm::width(3)  << "#i"
+               << otm::width(3)  << "p"
+               << otm::width(9)  << "n"
+               << otm::width(9)  << "cap"
+               << otm::width(10) << "t_ins"
+               << otm::width(10) << "t_find_-"
+               << otm::width(10) << "t_find_+"
+               << otm::width(10) << "t_update"
+               << otm::width(7)  << "errors"
+               << std::endl;
+
+    ttm::start_threads<test_in_stages>(p, n, cap, it);
+    return 0;
+}